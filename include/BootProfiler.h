@@ -0,0 +1,43 @@
+#ifndef BOOT_PROFILER_H
+#define BOOT_PROFILER_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+struct BootStage
+{
+    const char *name;    // Static string
+    uint32_t startUs;    // Since reset (micros())
+    uint32_t durationUs; // 0 for milestones
+    bool ok;
+};
+
+// Records how long each boot stage took. Stages are sequential: begin()
+// closes the one still open. Milestones mark a point in time (e.g. outputs
+// restored) without a duration. Local stages run from setup(), network
+// stages from loop(), so the profile is complete once finish() is called.
+class BootProfiler
+{
+public:
+    BootProfiler();
+
+    void begin(const char *name);
+    void end(bool ok = true);
+    void mark(const char *name);
+    void finish();
+
+    bool isComplete() const { return completeUs != 0; }
+    uint32_t getTotalMs() const { return completeUs / 1000; }
+    uint32_t msSinceBoot(const char *name) const; // Milestone or stage end, 0 if not reached
+
+    String getJson();
+    void print();
+
+private:
+    BootStage stages[BOOT_PROFILER_MAX_STAGES];
+    uint8_t count;
+    int8_t openStage; // -1 = none
+    uint32_t completeUs;
+};
+
+#endif // BOOT_PROFILER_H
@@ -0,0 +1,127 @@
+#ifndef BUTTON_ID_H
+#define BUTTON_ID_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// =========================================================================
+// BUTTON TEXT <-> ButtonId
+// =========================================================================
+// Dashboard/WebSocket/HTTP messages name buttons by text. They are turned
+// into a ButtonId once, at the edge, with a perfect hash: FNV-1a (seeded),
+// top 5 bits select one of 32 slots, one strcmp confirms the match. The
+// slot layout below is checked at compile time, so adding a name that
+// collides fails the build instead of silently shadowing another button.
+
+#define BUTTON_TEXT_HASH_SEED 360u
+#define BUTTON_TEXT_SLOTS 32
+
+struct ButtonTextEntry
+{
+    const char *text;
+    ButtonId id;
+};
+
+constexpr uint32_t buttonTextHash(const char *s, uint32_t h = BUTTON_TEXT_HASH_SEED)
+{
+    return *s ? buttonTextHash(s + 1, (h ^ (uint8_t)*s) * 16777619u) : h;
+}
+
+constexpr uint8_t buttonTextSlot(const char *s)
+{
+    return buttonTextHash(s) >> 27;
+}
+
+// Indexed by slot; aliases are the legacy dashboard ids
+constexpr ButtonTextEntry BUTTON_TEXT_TABLE[BUTTON_TEXT_SLOTS] = {
+    {nullptr, BTN_NONE},        // 0
+    {nullptr, BTN_NONE},        // 1
+    {nullptr, BTN_NONE},        // 2
+    {"button-cup1", BTN_CUP},   // 3
+    {"button-cup2", BTN_CDN},   // 4
+    {nullptr, BTN_NONE},        // 5
+    {nullptr, BTN_NONE},        // 6
+    {nullptr, BTN_NONE},        // 7
+    {nullptr, BTN_NONE},        // 8
+    {"button-ant", BTN_ANT},    // 9
+    {nullptr, BTN_NONE},        // 10
+    {"button-cdn", BTN_CDN},    // 11
+    {nullptr, BTN_NONE},        // 12
+    {nullptr, BTN_NONE},        // 13
+    {"button-tune", BTN_TUNE},  // 14
+    {"button-cup", BTN_CUP},    // 15
+    {nullptr, BTN_NONE},        // 16
+    {nullptr, BTN_NONE},        // 17
+    {"button-auto", BTN_AUTO},  // 18
+    {"button-lup1", BTN_LUP},   // 19
+    {"button-lup2", BTN_LDN},   // 20
+    {nullptr, BTN_NONE},        // 21
+    {nullptr, BTN_NONE},        // 22
+    {nullptr, BTN_NONE},        // 23
+    {nullptr, BTN_NONE},        // 24
+    {"button-lup", BTN_LUP},    // 25
+    {nullptr, BTN_NONE},        // 26
+    {"button-ldn", BTN_LDN},    // 27
+    {nullptr, BTN_NONE},        // 28
+    {nullptr, BTN_NONE},        // 29
+    {nullptr, BTN_NONE},        // 30
+    {nullptr, BTN_NONE}};       // 31
+
+constexpr bool buttonTextTableValid(uint8_t slot = 0)
+{
+    return slot >= BUTTON_TEXT_SLOTS ||
+           ((BUTTON_TEXT_TABLE[slot].text == nullptr || buttonTextSlot(BUTTON_TEXT_TABLE[slot].text) == slot) &&
+            buttonTextTableValid(slot + 1));
+}
+
+static_assert(buttonTextTableValid(), "BUTTON_TEXT_TABLE entry is not in its hash slot - re-pick BUTTON_TEXT_HASH_SEED");
+
+// Text -> id, BTN_NONE if unknown. No allocation.
+inline ButtonId buttonIdFromText(const char *text)
+{
+    if (!text)
+    {
+        return BTN_NONE;
+    }
+    const ButtonTextEntry &entry = BUTTON_TEXT_TABLE[buttonTextSlot(text)];
+    return (entry.text && strcmp(entry.text, text) == 0) ? entry.id : BTN_NONE;
+}
+
+inline ButtonId buttonIdFromText(const String &text)
+{
+    return buttonIdFromText(text.c_str());
+}
+
+// CI-V 34 button code -> id for the pulse buttons (02 TUNE .. 06 L-DN).
+// ANT (00/01) is model dependent and handled by the caller.
+inline ButtonId buttonIdFromCivCode(uint8_t code)
+{
+    static const ButtonId CIV_CODES[] = {BTN_NONE, BTN_NONE, BTN_TUNE, BTN_CUP, BTN_CDN, BTN_LUP, BTN_LDN};
+    return code < sizeof(CIV_CODES) ? CIV_CODES[code] : BTN_NONE;
+}
+
+// Canonical text name for an id (never an alias)
+inline const char *buttonIdToText(ButtonId id)
+{
+    switch (id)
+    {
+    case BTN_CUP:
+        return "button-cup";
+    case BTN_CDN:
+        return "button-cdn";
+    case BTN_LUP:
+        return "button-lup";
+    case BTN_LDN:
+        return "button-ldn";
+    case BTN_TUNE:
+        return "button-tune";
+    case BTN_ANT:
+        return "button-ant";
+    case BTN_AUTO:
+        return "button-auto";
+    default:
+        return "unknown";
+    }
+}
+
+#endif // BUTTON_ID_H
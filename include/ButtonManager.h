@@ -2,8 +2,19 @@
 #define BUTTON_MANAGER_H
 
 #include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
 #include "../lib/MCP23017/MCP23017.h"
+#include "ButtonId.h"
+#include "ButtonRepeater.h"
+#include "ButtonSequencer.h"
 #include "Config.h"
+#include "DeadlineScheduler.h"
+#include "EventLog.h"
+#include "LatencyHistogram.h"
 
 // Forward declarations
 class ConfigManager;
@@ -11,38 +22,140 @@ class ConfigManager;
 struct ButtonMapping
 {
     uint8_t mcpPin;
-    const char *id;
+    ButtonId id; // Also the momentary action slot
     const char *name;
-    uint8_t momentaryIndex;
 };
 
 struct MomentaryAction
 {
     uint8_t mcpPin;
-    unsigned long expireMillis;
     bool inProgress;
 
-    MomentaryAction() : mcpPin(255), expireMillis(0), inProgress(false) {}
-    MomentaryAction(uint8_t pin) : mcpPin(pin), expireMillis(0), inProgress(false) {}
+    // Hardware-timed pulse state
+    esp_timer_handle_t timer;
+    uint16_t generation; // Bumped on every press so stale releases are ignored
+    int64_t pressedAtUs;
+    uint32_t requestedUs;
+    EventSource source; // Release events are attributed to whoever pressed
+
+    MomentaryAction() : mcpPin(255), inProgress(false),
+                        timer(nullptr), generation(0), pressedAtUs(0), requestedUs(0) {}
+    MomentaryAction(uint8_t pin) : mcpPin(pin), inProgress(false),
+                                   timer(nullptr), generation(0), pressedAtUs(0), requestedUs(0) {}
+};
+
+// Interlock table entry: outputs that must not be active together with
+// `button`, and whether a running step train (sequence, hold-to-repeat)
+// reserves it
+struct InterlockRule
+{
+    ButtonId button;
+    uint8_t conflicts; // Bit n = ButtonId n
+    bool trainExclusive;
+};
+
+enum InterlockResult : uint8_t
+{
+    INTERLOCK_OK = 0,
+    INTERLOCK_CONFLICT,    // A conflicting output is held by an equal/higher priority source
+    INTERLOCK_TRAIN_BUSY   // A sequence or repeat train owns the C/L/TUNE outputs
+};
+
+// Timer callback -> release task message. A release carries the generation
+// its timer was armed for; a press is a step-train pulse handed off by the
+// sequencer/repeater timers, which must not block on the bus themselves.
+struct PulseRelease
+{
+    uint8_t index;
+    uint16_t generation;
+    uint16_t pressWidthMs; // 0 = release, otherwise start a pulse this long
+    EventSource source;    // Press only
+};
+
+// Actual vs requested pulse width
+struct PulseJitterStats
+{
+    LatencyHistogram lateness; // actual - requested, in us (early pulses count as 0)
+    int32_t minErrorUs;
+    int32_t maxErrorUs;
+
+    PulseJitterStats() : minErrorUs(0), maxErrorUs(0) {}
 };
 
 class ButtonManager
 {
+public:
+    // Notified of every press (pulse or momentary start), with the output lock
+    // held. durationMs is the pulse width, 0 for a hold of unknown length.
+    typedef void (*PressCallback)(ButtonId buttonId, uint32_t durationMs);
+
 private:
     MCP23017 *mcp;
     ConfigManager *config;
 
-    // Button state tracking
+    // Output levels from the last verified readback
     int lastButtonStates[BUTTON_COUNT];
     MomentaryAction momentaryActions[MOMENTARY_ACTION_COUNT];
 
-    // Button mapping table
+    // Button mapping and interlock tables
     static const ButtonMapping buttonMappings[BUTTON_COUNT];
+    static const InterlockRule interlockTable[BUTTON_COUNT];
+
+    // Hardware-timed pulses
+    SemaphoreHandle_t outputMutex; // Serializes expander writes between loop and release task
+    QueueHandle_t releaseQueue;
+    PulseJitterStats pulseJitter;
+    DeadlineScheduler<MOMENTARY_ACTION_COUNT> loopReleases; // Pulses without a timer, released by processMomentaryActions()
+
+    // Output latch shadow: changes are staged here and written as one
+    // writeAllPins() burst, either right away (writePin) or once per loop
+    // tick (stagePin + flushOutputs)
+    uint16_t outputShadow;
+    uint16_t outputMask; // Pins owned by ButtonManager
+    bool outputsDirty;
+    bool outputsOnline; // Primary expander attached; while not, changes stay staged
+    bool outputsConfigured; // Latch written and pins made outputs (deferred while offline)
+    uint32_t outputFlushes;
+    uint32_t outputsCoalesced; // Staged changes that rode along with another write
+
+    // Write-verify: each flush is read back once instead of polling the pins
+    uint32_t outputVerifyFailures; // Latch (OLAT) differed from the shadow - expander reset, resynced
+    uint32_t outputPinFaults;      // Latch right but a driven pin didn't follow - stuck/shorted line
+    uint32_t outputResyncs;        // Expander configuration pushed again after a mismatch
+    uint32_t outputReadbackErrors; // Readback transaction failed
+
+    uint32_t interlockRejects;
+    uint32_t interlockPreempts;
+
+    ButtonSequencer sequencer;
+    ButtonRepeater repeater;
+    PressCallback pressCallback;
+    EventLog *eventLog;
+    struct PulseTimerContext
+    {
+        ButtonManager *owner;
+        uint8_t index;
+        uint16_t generation; // Generation the timer was armed for
+    } timerContexts[MOMENTARY_ACTION_COUNT];
 
     // Helper methods
-    int findButtonIndex(const String &buttonId);
-    bool isValidButton(const String &buttonId);
+    static bool isMappedButton(ButtonId buttonId); // CUP..ANT, not AUTO
     void updateButtonState(uint8_t pin, bool state);
+    void stagePin(uint8_t pin, uint8_t level);
+    void writePin(uint8_t pin, uint8_t level); // Stage and flush now (latency-critical edges)
+    void configureOutputs();                   // Latch first, then one IODIR write; deferred while offline
+    bool startPulseTimers();
+    void cancelPulseTimer(uint8_t momentaryIdx);
+    void completePulse(const PulseRelease &release);
+    void recordPulseWidth(uint32_t requestedUs, int64_t actualUs);
+    void logEvent(EventKind kind, ButtonId buttonId, const EventSource &source, uint32_t value = 0);
+    void logRelease(uint8_t momentaryIdx);
+    bool verifyOutputs(uint16_t expected, uint16_t &latchMismatch, uint16_t &pinMismatch); // False if the readback failed; call with the output lock held
+    InterlockResult arbitrate(ButtonId buttonId, const EventSource &source); // Call with the output lock held
+    static uint8_t sourcePriority(uint8_t sourceType);
+
+    static void onPulseTimer(void *arg);
+    static void releaseTask(void *arg);
 
 public:
     ButtonManager(MCP23017 *mcpInstance, ConfigManager *configManager);
@@ -52,30 +165,57 @@ public:
     bool setMCP(MCP23017 *mcpInstance);
     void setupOutputs();
 
-    // Button control
-    bool setButtonOutput(const String &buttonId, bool state);
-    bool setButtonOutput(const String &buttonId); // Uses saved state
-    bool pressButton(const String &buttonId);
-    bool releaseButton(const String &buttonId);
-    bool pulseButton(const String &buttonId, unsigned long durationMs = 200); // NEW: Timed pulse
+    // Button control (text ids are resolved at the caller's edge, see ButtonId.h).
+    // source only attributes the action in the event log.
+    bool setButtonOutput(ButtonId buttonId, bool state, const EventSource &source = EventSource());
+    bool setButtonOutput(ButtonId buttonId, const EventSource &source = EventSource()); // Uses saved state; logged unless internal
+    bool pressButton(ButtonId buttonId, const EventSource &source = EventSource());
+    bool releaseButton(ButtonId buttonId, const EventSource &source = EventSource());
+    bool pulseButton(ButtonId buttonId, unsigned long durationMs = 200, const EventSource &source = EventSource()); // NEW: Timed pulse
+    bool queuePulse(ButtonId buttonId, uint16_t durationMs, const EventSource &source); // Non-blocking, for timer callbacks; pulsed by the release task
 
     // Momentary button handling
-    bool startMomentaryAction(const String &buttonId);
-    bool stopMomentaryAction(const String &buttonId);
+    bool startMomentaryAction(ButtonId buttonId, const EventSource &source = EventSource());
+    bool stopMomentaryAction(ButtonId buttonId, const EventSource &source = EventSource());
     void processMomentaryActions(); // Call in main loop
+    void flushOutputs();            // Writes staged output changes, call once per loop tick
+    void setOutputsOnline(bool online); // Primary expander attached/detached; staged changes go out on re-attach
+    uint32_t msUntilNextRelease();   // DEADLINE_NONE if nothing is waiting on the loop
 
-    // State management
-    void scanButtonStates(); // Call in main loop
-    bool getButtonState(const String &buttonId);
+    // State management (from the latch shadow / last verified readback, no bus access)
+    bool getButtonState(ButtonId buttonId);
     int getLastButtonState(uint8_t index);
 
     // Special button handling
     bool isAntButtonMomentary();
+    bool hasAutoLatch(); // Models without it keep the AUTO line inactive
     void handleModelSwitch();
 
+    // Interlocks (a press refused by the interlock returns false)
+    String getInterlockJson();
+
+    // Macro sequences
+    ButtonSequencer &getSequencer() { return sequencer; }
+
+    // Hold-to-repeat
+    ButtonRepeater &getRepeater() { return repeater; }
+
+    // Shared with whoever else re-initializes the expander (see OutputLock)
+    SemaphoreHandle_t getOutputMutex() const { return outputMutex; }
+
+    // Press observer (tune memory position tracking)
+    void setPressCallback(PressCallback callback) { pressCallback = callback; }
+
+    // Action history
+    void setEventLog(EventLog *log) { eventLog = log; }
+
+    // Pulse timing and output writes
+    String getPulseJitterJson();
+    void resetPulseJitter();
+
     // Debug
     void printButtonStates();
-    String getButtonInfo(const String &buttonId);
+    String getButtonInfo(ButtonId buttonId);
 };
 
 #endif // BUTTON_MANAGER_H
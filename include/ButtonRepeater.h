@@ -0,0 +1,63 @@
+#ifndef BUTTON_REPEATER_H
+#define BUTTON_REPEATER_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "ButtonId.h"
+#include "Config.h"
+
+// Forward declarations
+class ButtonManager;
+class ConfigManager;
+
+// Generates a C/L pulse train while a dashboard button is held. Intervals
+// follow the configured RepeatCurve (slow first steps, then faster). The
+// client sends a keepalive while holding; if it goes quiet for
+// REPEAT_KEEPALIVE_TIMEOUT_MS (dropped connection, backgrounded tab) the
+// train stops by itself. One train runs at a time.
+class ButtonRepeater
+{
+public:
+    ButtonRepeater(ButtonManager *buttonManager, ConfigManager *configManager);
+
+    bool begin();
+
+    // owner identifies the client so a disconnect only stops its own train
+    bool start(ButtonId buttonId, uint32_t owner);
+    void keepalive(ButtonId buttonId, uint32_t owner);
+    void stop(ButtonId buttonId, uint32_t owner);
+    void stopOwner(uint32_t owner);
+    void stopAll();
+
+    bool isRunning() const { return button != BTN_NONE; }
+    static bool isRepeatable(ButtonId buttonId); // C/L up/down only
+
+    String getStatusJson();
+
+private:
+    ButtonManager *buttons;
+    ConfigManager *config;
+    esp_timer_handle_t timer;
+    SemaphoreHandle_t mutex; // Guards the train against the esp_timer task
+
+    volatile ButtonId button; // BTN_NONE when idle
+    uint32_t ownerId;
+    RepeatCurve curve;        // Snapshot taken at start
+    uint32_t pulseCount;
+    uint32_t intervalMs;      // Interval after the most recent pulse
+    int64_t nextPulseUs;
+    int64_t lastKeepaliveUs;
+
+    // Totals
+    uint32_t trainsStarted;
+    uint32_t keepaliveTimeouts;
+
+    static void onTimer(void *arg);
+    void advance();
+    uint32_t stopLocked(); // Returns the train's pulse count; no printing under the mutex
+    void stopMatching(ButtonId buttonId, uint32_t owner, bool anyButton, bool anyOwner, const char *reason);
+};
+
+#endif // BUTTON_REPEATER_H
@@ -0,0 +1,94 @@
+#ifndef BUTTON_SEQUENCER_H
+#define BUTTON_SEQUENCER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "ButtonId.h"
+#include "Config.h"
+#include "EventLog.h"
+
+// Forward declarations
+class ButtonManager;
+
+// One press in a macro: pulse `button` for widthMs, then wait gapMs
+struct SequenceStep
+{
+    ButtonId button;
+    uint16_t widthMs;
+    uint16_t gapMs;
+};
+
+enum SequencerState : uint8_t
+{
+    SEQ_IDLE = 0,
+    SEQ_RUNNING,
+    SEQ_DONE,
+    SEQ_STOPPED
+};
+
+// Plays (button, width, gap) step lists locally so one CI-V or dashboard
+// command replaces a train of round trips. Step starts are timed by an
+// esp_timer against absolute deadlines, so per-step latency doesn't drift.
+// Named sequences live on LittleFS under SEQUENCE_DIR.
+class ButtonSequencer
+{
+public:
+    // Receives sequence_progress JSON; called from the main loop
+    typedef void (*ProgressCallback)(const String &json);
+
+    ButtonSequencer(ButtonManager *buttonManager);
+
+    bool begin();
+
+    // Playback
+    // source attributes the presses (and sets their interlock priority)
+    bool run(const SequenceStep *steps, uint8_t count, const char *name = "", const EventSource &source = EventSource(SRC_SEQUENCE));
+    bool runNamed(const char *name);
+    void stop();
+    bool isRunning() const { return state == SEQ_RUNNING; }
+    uint8_t getSourceType() const { return source.type; } // Of the current/last run
+    void update(); // Call in main loop - emits progress events
+
+    // Named sequences on LittleFS
+    bool save(const char *name, const SequenceStep *steps, uint8_t count);
+    bool loadNamed(const char *name, SequenceStep *steps, uint8_t &count);
+    bool remove(const char *name);
+    String listJson();
+
+    // Wire formats. Both return the number of steps, 0 if invalid.
+    static uint8_t parseCivSteps(const uint8_t *data, size_t len, SequenceStep *steps);
+    static uint8_t parseJsonSteps(JsonArrayConst array, SequenceStep *steps);
+
+    static bool isValidName(const char *name);
+    static bool isValidStep(const SequenceStep &step);
+
+    void setProgressCallback(ProgressCallback callback) { progressCallback = callback; }
+    String getStatusJson();
+
+private:
+    ButtonManager *buttons;
+    esp_timer_handle_t timer;
+    SemaphoreHandle_t mutex; // Guards playback state against the esp_timer task
+
+    SequenceStep steps[SEQUENCE_MAX_STEPS];
+    uint8_t stepCount;
+    uint8_t nextStep;
+    volatile SequencerState state;
+    int64_t nextStartUs;
+    char name[SEQUENCE_NAME_MAX + 1];
+    EventSource source;
+
+    // Last state pushed to the progress callback
+    SequencerState reportedState;
+    uint8_t reportedStep;
+    ProgressCallback progressCallback;
+
+    static void onTimer(void *arg);
+    void advance();
+    static String pathFor(const char *name);
+};
+
+#endif // BUTTON_SEQUENCER_H
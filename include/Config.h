@@ -15,7 +15,10 @@
 #define I2C_CLOCK_SPEED 100000
 
 // MCP23017 Configuration
-#define MCP23017_ADDRESS 0x27
+#define MCP23017_ADDRESS 0x27 // Primary expander (tuner 1)
+#define EXPANDER_SCAN_FIRST 0x20
+#define EXPANDER_SCAN_LAST 0x27
+#define MAX_LOGICAL_PINS 64 // Logical pin space across all expanders
 
 // =========================================================================
 // MCP23017 GPIO PIN MAPPINGS
@@ -25,6 +28,19 @@
 #define MCP_TUNING_PIN 0 // PA0 (9PIN #1) - Tuning indicator
 #define MCP_SWR_PIN 5    // PA5 (9PIN #6) - SWR indicator
 
+// Indicator debounce: level must hold this long before it is reported
+#define INDICATOR_SETTLE_DEFAULT_MS 30
+#define INDICATOR_SETTLE_MAX_MS 1000
+
+// Indicator trace: fixed-rate TUNING/SWR sampling into a run-length ring
+#define INDICATOR_SAMPLER_DEFAULT_HZ 1000
+#define INDICATOR_SAMPLER_MAX_HZ 1000
+#define INDICATOR_TRACE_RUNS 2048          // 16-bit run words (4 KB)
+#define INDICATOR_TRACE_EXPORT_MAX 512     // Runs per /indicator-trace reply
+#define INDICATOR_TRACE_WINDOW_DEFAULT_MS 10000
+#define INDICATOR_SAMPLER_TASK_PRIORITY 2  // Just above loopTask
+#define INDICATOR_SAMPLER_TASK_STACK 2560
+
 // Output pins (button controls)
 #define BUTTON_CDN_PIN 1  // PA1 (9PIN #2) - Capacitor Down
 #define BUTTON_LDN_PIN 3  // PA3 (9PIN #4) - Inductor Down
@@ -53,6 +69,11 @@
 #define HTTP_PORT 80
 #define AP_NAME "shackmate-tuner"
 
+// Dashboard page, gzipped at build time (scripts/gzip_dashboard.py)
+#define DASHBOARD_PATH "/index.html"           // Served from DASHBOARD_PATH ".gz" when present
+#define DASHBOARD_ETAG_PATH "/index.html.etag" // Content hash of the .gz
+#define DASHBOARD_ETAG_MAX 40
+
 // =========================================================================
 // CI-V CONFIGURATION
 // =========================================================================
@@ -61,6 +82,29 @@
 #define CIV_BASE_ADDRESS 0xB7
 #define MIN_DEVICE_NUMBER 1
 #define MAX_DEVICE_NUMBER 4
+#define DEFAULT_RADIO_ADDRESS 0x94 // Transceiver whose frequency reports feed the tune memory (IC-7300)
+
+// =========================================================================
+// TUNE MEMORY
+// =========================================================================
+
+#define TUNE_MEMORY_FILE "/tune/memory.bin"
+#define TUNE_MEMORY_MAX_ENTRIES 256
+#define TUNE_MEMORY_SEGMENT_HZ 25000UL     // One memory per 25 kHz segment
+#define TUNE_MEMORY_MAX_DISTANCE 4         // Segments - nearest memory used when the exact one is missing
+#define TUNE_MEMORY_SETTLE_MS 2000         // SWR must read good this long before a memory is recorded
+#define TUNE_MEMORY_REPLAY_DELAY_MS 500    // Frequency must hold this long before replaying (VFO spins)
+#define TUNE_MEMORY_SAVE_INTERVAL 10000    // ms - coalesced LittleFS writes
+#define TUNE_MEMORY_STEP_WIDTH_MS 80       // Replay pulse width (one step, below the tuner's repeat)
+#define TUNE_MEMORY_TUNER_REPEAT_MS 100    // Tuner keeps stepping this often while C/L is held
+#define TUNE_MEMORY_STEP_GAP_MS 50         // Replay gap between pulses
+
+// Tune-cycle analytics (TUNE pulse -> TUNING rise/fall -> SWR)
+#define TUNE_CYCLE_START_TIMEOUT_MS 3000   // TUNING must rise this soon after the pulse
+#define TUNE_CYCLE_MAX_MS 60000            // Longest cycle before it counts as a timeout
+#define TUNE_CYCLE_SWR_SETTLE_MS 300       // SWR is read this long after TUNING falls
+#define TUNE_CYCLE_HISTORY 32              // Match times kept per antenna/band for percentiles
+#define TUNE_CYCLE_BAND_COUNT 13           // 11 HF/6 m bands + other + unknown
 
 // =========================================================================
 // TIMING CONFIGURATION
@@ -71,8 +115,29 @@
 #define DISCOVERY_INTERVAL 30000       // ms
 #define LED_BLINK_FAST 100             // ms
 #define LED_BLINK_SLOW 500             // ms
+#define LED_RENDER_INTERVAL_MS 20      // ms - pattern frame rate cap (solid colors render immediately)
 #define WATCHDOG_TIMEOUT 30            // seconds
 #define WIFI_CONNECT_TIMEOUT 30        // seconds
+#define EXPANDER_POLL_INTERVAL 10      // ms - batched input snapshot of all expanders (indicator debounce sample rate)
+#define EXPANDER_SCAN_INTERVAL 5000    // ms - hot-plug rescan of 0x20-0x27
+#define EXPANDER_FAIL_THRESHOLD 3      // Consecutive failed polls before an expander counts as gone
+#define LOOP_IDLE_SLEEP_MAX 2          // ms - loop() sleeps up to this long when no release is due sooner
+#define BOOT_PROFILER_MAX_STAGES 16    // Boot stages + milestones recorded
+
+// On-demand diagnostics benchmarks (GET /diagnostics?bench=i2c)
+#define DIAG_BENCH_DEFAULT_ITERATIONS 200
+#define DIAG_BENCH_MAX_ITERATIONS 2000
+#define DIAG_BENCH_BATCH 16            // Reads between yields (power of two)
+#define DIAG_BENCH_TASK_PRIORITY 1
+#define DIAG_BENCH_TASK_STACK 2560
+
+// Hardware health supervisor (bus/expander checks and recovery)
+#define HEALTH_CHECK_INTERVAL_MS 1000  // Probe + IODIR check of the primary expander
+#define HEALTH_BACKOFF_BASE_MS 500     // First retry after a failed recovery, doubling...
+#define HEALTH_BACKOFF_MAX_MS 30000    // ...up to this
+#define HEALTH_ERROR_THRESHOLD 5       // Bus errors per check interval that count as degraded
+#define HEALTH_TASK_PRIORITY 1
+#define HEALTH_TASK_STACK 3072
 
 // =========================================================================
 // BUTTON CONFIGURATION
@@ -81,16 +146,62 @@
 #define BUTTON_COUNT 6
 #define MOMENTARY_ACTION_COUNT 8
 
-// Button indices for arrays
-enum ButtonIndex
+// Hardware-timed pulses: esp_timer one-shots hand the release to this task
+#define PULSE_TASK_PRIORITY 20 // Above loopTask/AsyncTCP, below the esp_timer task
+#define PULSE_TASK_STACK 4096 // Also runs sequence/repeat presses (press callback, logging)
+#define PULSE_QUEUE_LENGTH 16
+
+// Button macro sequencer
+#define SEQUENCE_MAX_STEPS 64
+#define SEQUENCE_NAME_MAX 24       // Characters, [A-Za-z0-9_-]
+#define SEQUENCE_MIN_WIDTH_MS 10
+#define SEQUENCE_MAX_WIDTH_MS 5000
+#define SEQUENCE_MIN_GAP_MS 20     // Tuner must see the release before the next press
+#define SEQUENCE_MAX_GAP_MS 10000
+#define SEQUENCE_CIV_UNIT_MS 10    // CI-V 35 width/gap bytes are in 10 ms units
+#define SEQUENCE_CIV_MAX_BYTE 0xFC // FD (end of frame) and FE (preamble) can't appear in CI-V data
+#define SEQUENCE_DIR "/seq"
+
+// Hold-to-repeat (C/L up/down held in the dashboard)
+#define REPEAT_KEEPALIVE_TIMEOUT_MS 750 // Train stops if the client goes quiet this long
+#define REPEAT_DEFAULT_WIDTH_MS 80
+#define REPEAT_DEFAULT_DELAY_MS 400     // First pulse to second pulse
+#define REPEAT_DEFAULT_START_MS 250     // Interval once repeating starts
+#define REPEAT_DEFAULT_MIN_MS 100       // Fastest interval
+#define REPEAT_DEFAULT_ACCEL_PCT 15     // Interval shrinks by this much per pulse
+#define REPEAT_MAX_ACCEL_PCT 50
+
+// Repeat train timing; interval n+1 = max(minMs, interval n * (100 - accelPercent) / 100)
+struct RepeatCurve
+{
+    uint16_t widthMs;
+    uint16_t delayMs;
+    uint16_t startMs;
+    uint16_t minMs;
+    uint8_t accelPercent;
+};
+
+// Button/indicator event log
+#define EVENT_LOG_CAPACITY 512      // Entries (16 bytes each), power of two
+#define EVENT_STREAM_INTERVAL 200   // ms - push new events to subscribed dashboard clients
+#define EVENT_STREAM_BATCH 32       // Events per pushed message
+#define EVENT_MAX_SUBSCRIBERS 4
+#define EVENT_EXPORT_MAX 128        // Events per GET /events page
+
+// Button identifiers - ButtonManager's internal API and array index.
+// Text names ("button-cup", ...) are only resolved at the protocol edge,
+// see ButtonId.h.
+enum ButtonId : uint8_t
 {
-    BTN_IDX_CUP = 0,
-    BTN_IDX_CDN = 1,
-    BTN_IDX_LUP = 2,
-    BTN_IDX_LDN = 3,
-    BTN_IDX_TUNE = 4,
-    BTN_IDX_ANT = 5,
-    BTN_IDX_AUTO = 6
+    BTN_CUP = 0,
+    BTN_CDN = 1,
+    BTN_LUP = 2,
+    BTN_LDN = 3,
+    BTN_TUNE = 4,
+    BTN_ANT = 5,
+    BTN_AUTO = 6, // Latch only, not in the pulse/momentary mapping table
+    BTN_ID_COUNT = 7,
+    BTN_NONE = 0xFF
 };
 
 // =========================================================================
@@ -117,14 +228,44 @@ namespace Colors
     const RGBColor YELLOW(255, 255, 0);
 }
 
+// Status LED driver (WS2812 on an RMT TX channel)
+#define LED_RMT_CHANNEL RMT_CHANNEL_0
+#define LED_RMT_CLK_DIV 2          // 80 MHz / 2 = 25 ns ticks
+#define LED_BRIGHTNESS 50          // 0-255, applied to every pattern color
+#define LED_PATTERN_MAX_COLORS 3   // Colors per LED_SEQUENCE pattern
+#define LED_BREATHE_STEP 8         // Breathe brightness quantum (fewer frames)
+
+// Flash persistence (write coalescing and wear accounting)
+#define PERSIST_MAX_KEYS 8
+#define PERSIST_CONFIG_MIN_INTERVAL_MS 5000   // Config blob: at most one write per 5 s
+#define PERSIST_WEAR_MIN_INTERVAL_MS 3600000  // Lifetime write counters: hourly, and at restart
+
+// JSON output (preallocated once, shared by the loop and AsyncTCP tasks)
+#define JSON_DASHBOARD_BUFFER_SIZE 1536 // dashboard_update message
+#define JSON_HTTP_BUFFER_SIZE 1536      // /config and other serializer-backed responses
+
+// JSON input: fixed bound for one dashboard WebSocket message. The largest
+// is a SEQUENCE_MAX_STEPS-step upload (64 x 3-element arrays, ~4.3 KB of
+// slots plus the button names); anything bigger fails to parse.
+#define JSON_DASHBOARD_REQUEST_SIZE 6144
+
 // =========================================================================
 // PREFERENCES NAMESPACES
 // =========================================================================
 
+#define PREFS_STORE_NAMESPACE "store" // Versioned config blob, slots A/B
+#define PREFS_WEAR_NAMESPACE "wear"   // Lifetime write counters per persistence key
+
+// Pre-blob layout, read once by the migration when no valid slot exists
 #define PREFS_WIFI_NAMESPACE "wifi"
 #define PREFS_CONFIG_NAMESPACE "config"
 #define PREFS_DEVICE_NAMESPACE "device"
 #define PREFS_CIV_MODEL_NAMESPACE "civmodel"
+#define PREFS_SWITCH_NAMESPACE "switch"
+
+#define CONFIG_BLOB_MAGIC 0x47464353 // "SCFG" little-endian
+#define CONFIG_BLOB_VERSION 1        // Bump when fields change meaning; append-only changes keep it
+#define CONFIG_CIV_MODEL_MAX 24      // Including the terminator
 
 // =========================================================================
 // DEBUG CONFIGURATION - ENABLED FOR DEBUGGING
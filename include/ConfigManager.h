@@ -3,60 +3,130 @@
 
 #include <Arduino.h>
 #include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include "Config.h"
+#include "TunerModel.h"
+#include "JsonWriter.h"
+#include "PersistenceService.h"
 
-class ConfigManager
+// Everything the device persists, as one blob. Written whole to the older
+// of two slots (A/B), so a reset mid-write leaves the other slot intact;
+// the slot with the higher sequence and a good CRC wins at boot.
+// New fields go at the end (before crc): a shorter blob from older firmware
+// loads as a prefix, the rest keeps its defaults.
+struct StoredConfig
 {
-private:
-    // Preferences instances
-    Preferences wifiPrefs;
-    Preferences configPrefs;
-    Preferences devicePrefs;
-    Preferences civModelPrefs;
+    uint32_t magic;
+    uint16_t version;
+    uint16_t length;   // sizeof(StoredConfig) of the writer
+    uint32_t sequence; // Bumped per save
 
-    // Cached values
+    uint8_t deviceNumber;
+    uint8_t radioAddress;
+    uint8_t antennaPort; // SMCIV switch port, zero-based
+    uint8_t rcsType;     // 0 = RCS-8, 1 = RCS-10
     bool antState;
     bool autoState;
-    String currentCivModel;
-    uint8_t deviceNumber;
+    bool tuneMemoryAuto;
+    bool demoMode;
+    uint16_t indicatorSettleMs;
+    uint16_t indicatorSampleHz;
+    RepeatCurve repeatCurve;
+    char civModel[CONFIG_CIV_MODEL_MAX];
+
+    uint32_t crc; // CRC-32 of everything above; always last
+};
+
+class ConfigManager
+{
+private:
+    PersistenceService *persistence; // nullptr = setters write through
+    uint8_t persistKey;
+    Preferences store; // Opened once in begin(), stays open
+    bool storeOpen;
+
+    StoredConfig cfg; // RAM copy, the source of truth
+    const TunerModel *tunerModel; // Resolved from cfg.civModel
     uint8_t civAddress;
+    int8_t activeSlot; // Slot cfg was last read from / written to, -1 = none
+    uint32_t saveCount;
+    uint32_t saveFailures;
+    bool migrated;
+    SemaphoreHandle_t saveMutex; // save() from the loop vs. HTTP handlers
 
     // Helper methods
     void updateCivAddress();
+    void setDefaults(StoredConfig &config);
+    void sanitize(StoredConfig &config);
+    bool readSlot(uint8_t slot, StoredConfig &out);
+    void migrateLegacy();
+    void resolveTunerModel();
+    bool save();        // Writes the blob now
+    void requestSave(); // Setters: marks the config dirty for the persistence service
+    static bool flushStore(void *context);
 
 public:
-    ConfigManager();
+    explicit ConfigManager(PersistenceService *persistenceService = nullptr);
     ~ConfigManager();
 
     // Initialization
     bool begin();
-    void loadAllSettings();
+    void loadAllSettings(); // Re-reads the slots
 
     // Device configuration
     void setDeviceNumber(uint8_t number);
-    uint8_t getDeviceNumber() const { return deviceNumber; }
+    uint8_t getDeviceNumber() const { return cfg.deviceNumber; }
     uint8_t getCivAddress() const { return civAddress; }
 
-    // CI-V Model configuration
-    bool setCivModel(const String &model);
-    String getCurrentCivModel() const { return currentCivModel; }
-    bool isModelMomentary() const { return currentCivModel.indexOf("998") >= 0; }
+    // Tuner model (see TunerModel.h)
+    bool setCivModel(const String &model); // By registry name
+    bool setTunerModel(TunerModelId id);
+    const char *getCurrentCivModel() const { return tunerModel->name; }
+    const TunerModel &getTunerModel() const { return *tunerModel; }
+    bool tunerHas(uint16_t capability) const { return tunerModel->has(capability); }
+    bool isModelMomentary() const { return tunerModel->has(TUNER_CAP_ANT_MOMENTARY); }
+
+    // Radio (frequency source for the tune memory)
+    void setRadioAddress(uint8_t address);
+    uint8_t getRadioAddress() const { return cfg.radioAddress; }
+    void setTuneMemoryAuto(bool enabled);
+    bool getTuneMemoryAuto() const { return cfg.tuneMemoryAuto; }
+
+    // Indicator input debounce
+    void setIndicatorSettleMs(uint32_t settleMs); // Clamped to INDICATOR_SETTLE_MAX_MS
+    uint16_t getIndicatorSettleMs() const { return cfg.indicatorSettleMs; }
+    void setIndicatorSampleHz(uint32_t rateHz); // 0 = trace off, clamped to INDICATOR_SAMPLER_MAX_HZ
+    uint16_t getIndicatorSampleHz() const { return cfg.indicatorSampleHz; }
+
+    // Demo mode: virtual tuner instead of the I2C hardware (read once at boot)
+    void setDemoMode(bool enabled);
+    bool isDemoMode() const { return cfg.demoMode; }
+
+    // Hold-to-repeat timing
+    bool setRepeatCurve(const RepeatCurve &curve);
+    const RepeatCurve &getRepeatCurve() const { return cfg.repeatCurve; }
+    static bool isValidRepeatCurve(const RepeatCurve &curve);
 
     // Button states
     void setAntState(bool state);
     void setAutoState(bool state);
-    bool getAntState() const { return antState; }
-    bool getAutoState() const { return autoState; }
-    void loadLatchedStates();
-    void saveLatchedStates();
+    bool getAntState() const { return cfg.antState; }
+    bool getAutoState() const { return cfg.autoState; }
+
+    // SMCIV antenna switch (port and RCS type, saved together)
+    void setSwitchSettings(uint8_t antennaPort, uint8_t rcsType);
+    uint8_t getAntennaPort() const { return cfg.antennaPort; }
+    uint8_t getRcsType() const { return cfg.rcsType; }
 
-    // WiFi configuration (placeholder for future expansion)
+    // WiFi configuration (placeholder for future expansion; WiFiManager keeps
+    // the credentials in the WiFi driver's own NVS, not in the config blob)
     bool hasWifiCredentials();
     void clearWifiCredentials();
 
     // Debug and status
     void printConfiguration();
-    String getConfigurationJson();
+    void writeJson(JsonWriter &json) const;
 
     // Reset functions
     void resetToDefaults();
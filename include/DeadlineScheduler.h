@@ -0,0 +1,169 @@
+#ifndef DEADLINE_SCHEDULER_H
+#define DEADLINE_SCHEDULER_H
+
+#include <Arduino.h>
+
+#define DEADLINE_NONE UINT32_MAX
+
+// Wrap-safe millis() comparison: true if a is at or after b. Valid as long
+// as the two times are less than ~24.8 days apart, which every deadline we
+// schedule is (millis() itself wraps after ~49.7 days).
+inline bool timeReached(uint32_t now, uint32_t deadline)
+{
+    return (int32_t)(now - deadline) >= 0;
+}
+
+inline bool timeBefore(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
+// Binary min-heap of per-slot deadlines. Each slot (e.g. a momentary action
+// index) has at most one pending deadline; scheduling it again moves it.
+// Fixed size, no allocation, O(log n) schedule/cancel/pop, O(1) peek.
+template <uint8_t Slots>
+class DeadlineScheduler
+{
+private:
+    struct Entry
+    {
+        uint32_t deadline;
+        uint8_t slot;
+    };
+
+    Entry heap[Slots];
+    uint8_t position[Slots]; // slot -> heap index, NOT_QUEUED if idle
+    uint8_t count;
+
+    static const uint8_t NOT_QUEUED = 0xFF;
+
+    void place(uint8_t index, const Entry &entry)
+    {
+        heap[index] = entry;
+        position[entry.slot] = index;
+    }
+
+    void siftUp(uint8_t index)
+    {
+        Entry entry = heap[index];
+        while (index > 0)
+        {
+            uint8_t parent = (index - 1) / 2;
+            if (!timeBefore(entry.deadline, heap[parent].deadline))
+            {
+                break;
+            }
+            place(index, heap[parent]);
+            index = parent;
+        }
+        place(index, entry);
+    }
+
+    void siftDown(uint8_t index)
+    {
+        Entry entry = heap[index];
+        for (;;)
+        {
+            uint8_t child = index * 2 + 1;
+            if (child >= count)
+            {
+                break;
+            }
+            if (child + 1 < count && timeBefore(heap[child + 1].deadline, heap[child].deadline))
+            {
+                child++;
+            }
+            if (!timeBefore(heap[child].deadline, entry.deadline))
+            {
+                break;
+            }
+            place(index, heap[child]);
+            index = child;
+        }
+        place(index, entry);
+    }
+
+    void removeAt(uint8_t index)
+    {
+        position[heap[index].slot] = NOT_QUEUED;
+        count--;
+        if (index == count)
+        {
+            return;
+        }
+        // Fill the hole with the last entry; it may need to move either way
+        uint8_t moved = heap[count].slot;
+        place(index, heap[count]);
+        siftDown(index);
+        if (position[moved] == index)
+        {
+            siftUp(index);
+        }
+    }
+
+public:
+    DeadlineScheduler() : count(0)
+    {
+        memset(position, NOT_QUEUED, sizeof(position));
+    }
+
+    void schedule(uint8_t slot, uint32_t deadline)
+    {
+        if (slot >= Slots)
+        {
+            return;
+        }
+
+        if (position[slot] != NOT_QUEUED)
+        {
+            removeAt(position[slot]);
+        }
+
+        Entry entry;
+        entry.deadline = deadline;
+        entry.slot = slot;
+        place(count, entry);
+        count++;
+        siftUp(count - 1);
+    }
+
+    void cancel(uint8_t slot)
+    {
+        if (slot < Slots && position[slot] != NOT_QUEUED)
+        {
+            removeAt(position[slot]);
+        }
+    }
+
+    bool isScheduled(uint8_t slot) const
+    {
+        return slot < Slots && position[slot] != NOT_QUEUED;
+    }
+
+    // Removes and returns the earliest slot if its deadline has passed
+    bool popExpired(uint32_t now, uint8_t &slot)
+    {
+        if (count == 0 || !timeReached(now, heap[0].deadline))
+        {
+            return false;
+        }
+        slot = heap[0].slot;
+        removeAt(0);
+        return true;
+    }
+
+    // Milliseconds until the earliest deadline (0 if overdue), DEADLINE_NONE if idle
+    uint32_t msUntilNext(uint32_t now) const
+    {
+        if (count == 0)
+        {
+            return DEADLINE_NONE;
+        }
+        return timeReached(now, heap[0].deadline) ? 0 : heap[0].deadline - now;
+    }
+
+    uint8_t size() const { return count; }
+    bool empty() const { return count == 0; }
+};
+
+#endif // DEADLINE_SCHEDULER_H
@@ -0,0 +1,116 @@
+#ifndef DEBOUNCE_FILTER_H
+#define DEBOUNCE_FILTER_H
+
+#include <Arduino.h>
+
+// Time-integrating debounce for one digital input. Each sample moves an
+// integrator towards its level by the time since the previous sample; the
+// output only changes once the integrator has travelled the full settle
+// time. An excursion that returns before that is counted as a glitch.
+// Works at any (even irregular) sample rate; settle 0 passes raw through.
+class DebounceFilter
+{
+private:
+    uint32_t integratorMs; // 0 = settled low, settleMs = settled high
+    uint32_t lastSampleMs;
+    bool stable;
+    bool raw;
+    bool primed;
+
+    uint32_t edges;    // Debounced transitions
+    uint32_t rawEdges; // Transitions seen in the samples
+    uint32_t glitches; // Raw excursions rejected by the filter
+
+public:
+    DebounceFilter() { reset(); }
+
+    void reset()
+    {
+        integratorMs = 0;
+        lastSampleMs = 0;
+        stable = false;
+        raw = false;
+        primed = false;
+        edges = 0;
+        rawEdges = 0;
+        glitches = 0;
+    }
+
+    // Returns true if the debounced state changed
+    bool sample(bool level, uint32_t nowMs, uint32_t settleMs)
+    {
+        if (!primed)
+        {
+            primed = true;
+            stable = raw = level;
+            integratorMs = level ? settleMs : 0;
+            lastSampleMs = nowMs;
+            return false;
+        }
+
+        uint32_t dt = nowMs - lastSampleMs;
+        lastSampleMs = nowMs;
+
+        if (level != raw)
+        {
+            raw = level;
+            rawEdges++;
+            if (level == stable && integratorMs != (stable ? settleMs : 0))
+            {
+                glitches++; // Came back before settling
+            }
+        }
+
+        if (integratorMs > settleMs)
+        {
+            integratorMs = settleMs; // Settle time was shortened
+        }
+
+        if (level)
+        {
+            integratorMs = (settleMs - integratorMs > dt) ? integratorMs + dt : settleMs;
+        }
+        else
+        {
+            integratorMs = integratorMs > dt ? integratorMs - dt : 0;
+        }
+
+        bool next = stable;
+        if (integratorMs == settleMs && level)
+        {
+            next = true;
+        }
+        else if (integratorMs == 0 && !level)
+        {
+            next = false;
+        }
+
+        if (next != stable)
+        {
+            stable = next;
+            edges++;
+            return true;
+        }
+        return false;
+    }
+
+    bool state() const { return stable; }
+    bool rawState() const { return raw; }
+    uint32_t edgeCount() const { return edges; }
+    uint32_t rawEdgeCount() const { return rawEdges; }
+    uint32_t glitchCount() const { return glitches; }
+
+    String toJson() const
+    {
+        String json = "{";
+        json += "\"state\":" + String(stable ? "true" : "false") + ",";
+        json += "\"raw\":" + String(raw ? "true" : "false") + ",";
+        json += "\"edges\":" + String(edges) + ",";
+        json += "\"raw_edges\":" + String(rawEdges) + ",";
+        json += "\"glitches\":" + String(glitches);
+        json += "}";
+        return json;
+    }
+};
+
+#endif // DEBOUNCE_FILTER_H
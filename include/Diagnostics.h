@@ -0,0 +1,51 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "Config.h"
+#include "HardwareManager.h"
+#include "LatencyHistogram.h"
+
+// Performance numbers for comparing units in the field: loop iteration
+// time and CI-V dispatch cost are recorded continuously, I2C round-trip
+// latency is measured on demand by a micro-benchmark in its own low
+// priority task (one bus transaction at a time, so outputs and polling
+// interleave and the HTTP task only starts it). Histograms are log2
+// buckets (see LatencyHistogram); lost increments under contention are
+// acceptable, as for the bus counters.
+class Diagnostics
+{
+public:
+    explicit Diagnostics(HardwareManager &hardware);
+
+    // Continuous
+    void recordLoop(uint32_t us) { loopTime.record(us); }
+    void recordCivDispatch(uint32_t us) { civDispatch.record(us); }
+    void reset(); // Loop and CI-V histograms
+
+    // On demand
+    bool startI2CBenchmark(uint32_t iterations); // Clamped to 1..DIAG_BENCH_MAX_ITERATIONS; false if running or no expander
+    bool isBenchmarkRunning() const { return benchRunning; }
+
+    // extraFields: more "key":value pairs from the caller (e.g. web socket queues)
+    String getJson(const String &extraFields = String());
+
+private:
+    HardwareManager &hardware;
+    LatencyHistogram loopTime;
+    LatencyHistogram civDispatch;
+
+    LatencyHistogram i2cRoundTrip;
+    volatile bool benchRunning; // Set before the task starts, cleared by it when done
+    uint16_t benchIterations;
+    uint32_t benchErrors;
+    uint32_t benchStartedMs;
+    uint32_t benchDurationMs;
+
+    static void benchTaskEntry(void *arg);
+    void runI2CBenchmark();
+};
+
+#endif // DIAGNOSTICS_H
@@ -0,0 +1,101 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "Config.h"
+
+enum EventKind : uint8_t
+{
+    EVT_PULSE = 1,    // Timed press started, value = requested width (ms)
+    EVT_PRESS,        // Held press started (momentary)
+    EVT_RELEASE,      // Press ended, value = actual width (ms)
+    EVT_LATCH,        // Latched output set, value = state
+    EVT_INDICATOR,    // Debounced indicator edge, value = level
+    EVT_REJECT,       // Action refused by the interlock, value = InterlockResult
+    EVT_OUTPUT_FAULT  // Output readback mismatch, value = mismatching pin mask
+};
+
+enum EventSourceType : uint8_t
+{
+    SRC_INTERNAL = 0,
+    SRC_CIV,         // id = sender's CI-V address
+    SRC_DASHBOARD,   // id = WebSocket client id
+    SRC_HTTP,
+    SRC_SEQUENCE,
+    SRC_REPEAT,      // id = WebSocket client id
+    SRC_TUNE_MEMORY,
+    SRC_HARDWARE
+};
+
+// Indicator subjects (EVT_INDICATOR uses these instead of a ButtonId)
+#define EVENT_SUBJECT_TUNING 0
+#define EVENT_SUBJECT_SWR 1
+
+// Who asked for an action
+struct EventSource
+{
+    uint8_t type;
+    uint16_t id;
+
+    EventSource() : type(SRC_INTERNAL), id(0) {}
+    EventSource(EventSourceType sourceType, uint32_t sourceId = 0) : type(sourceType), id((uint16_t)sourceId) {}
+};
+
+// Decoded copy of one log entry
+struct EventRecord
+{
+    uint32_t seq;
+    uint32_t timeMs;
+    uint8_t kind;
+    uint8_t subject; // ButtonId, or EVENT_SUBJECT_* for indicators
+    uint8_t source;
+    uint16_t sourceId;
+    uint16_t value;
+};
+
+// Fixed-size binary ring of button and indicator events. record() is
+// lock-free and wait-free for any number of writers (loop, esp_timer,
+// async_tcp): a writer claims a sequence number with one atomic add and
+// publishes the slot by stamping it last. Readers copy a slot and accept it
+// only if the stamp is unchanged afterwards, so an overwrite in progress is
+// detected instead of read torn. Readers walk the log with a cursor (the
+// next sequence number they want).
+class EventLog
+{
+private:
+    struct Slot
+    {
+        std::atomic<uint32_t> stamp; // seq + 1 once published, 0 while being written
+        uint32_t timeMs;
+        uint8_t kind;
+        uint8_t subject;
+        uint8_t source;
+        uint8_t reserved;
+        uint16_t sourceId;
+        uint16_t value;
+    };
+
+    Slot slots[EVENT_LOG_CAPACITY];
+    std::atomic<uint32_t> nextSeq;
+
+public:
+    EventLog();
+
+    void record(EventKind kind, uint8_t subject, const EventSource &source, uint32_t value = 0);
+
+    // Cursor API
+    uint32_t head() const { return nextSeq.load(std::memory_order_acquire); } // Next seq to be written
+    uint32_t oldest() const;                                                  // Oldest seq still in the ring
+    bool read(uint32_t seq, EventRecord &out) const;
+
+    // {"cursor":next,"head":..,"dropped":n,"events":[...]} starting at cursor;
+    // cursor is advanced past what was returned
+    String exportJson(uint32_t &cursor, uint16_t limit);
+
+    static String toJson(const EventRecord &event);
+    static const char *kindName(uint8_t kind);
+    static const char *sourceName(uint8_t source);
+};
+
+#endif // EVENT_LOG_H
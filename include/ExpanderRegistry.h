@@ -0,0 +1,89 @@
+#ifndef EXPANDER_REGISTRY_H
+#define EXPANDER_REGISTRY_H
+
+#include <Arduino.h>
+#include "../lib/MCP23017/MCP23017.h"
+#include "Config.h"
+#include "OutputLock.h"
+
+#define LOGICAL_PIN_UNMAPPED 0xFF
+
+// Logical pin -> (expander, pin) mapping entry
+struct LogicalPin
+{
+    uint8_t address; // I2C address of the expander, LOGICAL_PIN_UNMAPPED if unused
+    uint8_t pin;     // 0-15 (PA0-PA7, PB0-PB7)
+
+    LogicalPin() : address(LOGICAL_PIN_UNMAPPED), pin(0) {}
+    LogicalPin(uint8_t addr, uint8_t p) : address(addr), pin(p) {}
+};
+
+struct ExpanderSlot
+{
+    MCP23017 *driver;      // Created on first detection (primary: up front), kept while unplugged
+    bool present;          // Currently answering on the bus
+    uint16_t snapshot;     // GPIOB:GPIOA from the last batched poll
+    uint16_t attachCount;  // Times the device has (re)appeared
+    uint8_t failedPolls;   // Consecutive poll reads that got no answer
+    unsigned long lastSeen;
+
+    ExpanderSlot() : driver(nullptr), present(false), snapshot(0), attachCount(0), failedPolls(0), lastSeen(0) {}
+};
+
+class ExpanderRegistry
+{
+private:
+    MCP23017Bus &bus;
+    SemaphoreHandle_t outputMutex; // Held while begin() rewrites a device's outputs
+    ExpanderSlot slots[MCP23017_MAX_DEVICES];
+    LogicalPin logicalPins[MAX_LOGICAL_PINS];
+
+    unsigned long lastScan;
+    volatile bool scanRequested;
+    unsigned long lastPoll;
+    uint32_t pollCount;
+
+    // Helper methods
+    ExpanderSlot *slotFor(uint8_t address);
+    const ExpanderSlot *slotFor(uint8_t address) const;
+    void attach(uint8_t address, ExpanderSlot &slot);
+    void detach(uint8_t address, ExpanderSlot &slot);
+
+public:
+    ExpanderRegistry(MCP23017Bus &i2cBus);
+    ~ExpanderRegistry();
+
+    // Bus discovery (0x20-0x27)
+    uint8_t scan(); // Returns number of expanders present
+    void poll();    // One GPIO read per present expander
+    void update();  // Call in main loop - periodic poll and hot-plug rescan
+    void requestScan() { scanRequested = true; } // Any task - rescan on the next update()
+
+    // Output mutex of the ButtonManager driving these expanders; (re)attaching
+    // a device pushes its output latch, so it must not interleave with a flush
+    void setOutputMutex(SemaphoreHandle_t mutex) { outputMutex = mutex; }
+    SemaphoreHandle_t getOutputMutex() const { return outputMutex; }
+
+    // Device access
+    MCP23017 *getDevice(uint8_t address);
+    bool isPresent(uint8_t address) const;
+    uint8_t getPresentMask() const; // Bit n = expander at 0x20 + n
+    uint8_t getPresentCount() const;
+    uint16_t getSnapshot(uint8_t address) const;
+    bool readPinsUntraced(uint8_t address, uint16_t &pins); // Fresh GPIOB:GPIOA for own-task readers, not in the bus stats
+    uint32_t getPollCount() const { return pollCount; } // Changes whenever snapshots are refreshed
+
+    // Logical pin mapping
+    bool mapPin(uint8_t logicalPin, uint8_t address, uint8_t pin);
+    bool mapDevice(uint8_t firstLogicalPin, uint8_t address); // Maps all 16 pins
+    void unmapPin(uint8_t logicalPin);
+    const LogicalPin *resolve(uint8_t logicalPin) const;
+    bool readLogical(uint8_t logicalPin) const; // From the last snapshot
+    // No writeLogical(): outputs go through ButtonManager (OLAT shadow, output mutex, interlock)
+
+    // Debug
+    void printDevices();
+    String getDevicesJson();
+};
+
+#endif // EXPANDER_REGISTRY_H
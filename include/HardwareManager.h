@@ -4,35 +4,76 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include "../lib/MCP23017/MCP23017.h"
-#include <Adafruit_NeoPixel.h>
+#include "../lib/VirtualTuner/VirtualTuner.h"
 #include "Config.h"
+#include "DebounceFilter.h"
+#include "EventLog.h"
+#include "ExpanderRegistry.h"
+#include "IndicatorSampler.h"
+#include "StatusLed.h"
 
 // Forward declarations
 class ConfigManager;
 
+enum HardwareHealth : uint8_t
+{
+    HEALTH_OK = 0,
+    HEALTH_DEGRADED,       // Answering, but bus errors are piling up
+    HEALTH_RECOVERING,
+    HEALTH_BUS_STUCK,      // SDA/SCL held low, bus clear didn't help
+    HEALTH_DEVICE_MISSING  // Bus fine, primary expander not answering
+};
+
 class HardwareManager
 {
+public:
+    typedef void (*HealthCallback)(const String &json); // Health state transitions
+
 private:
-    MCP23017 *mcp;
-    Adafruit_NeoPixel *atomLed;
+    MCP23017Bus i2cBus;
+    ExpanderRegistry expanders;
+    MCP23017 *mcp; // Primary expander (owned by the registry)
+    StatusLed statusLed;
     ConfigManager *config;
 
-    // LED state
-    RGBColor currentColor;
-    bool blinkState;
-    unsigned long lastBlinkTime;
-    uint16_t blinkInterval;
+    // Debounced indicator inputs, fed from the expander snapshot
+    DebounceFilter tuningFilter;
+    DebounceFilter swrFilter;
+    uint32_t lastIndicatorPoll;
+    EventLog *eventLog;
+    IndicatorSampler sampler; // High-rate trace for plotting tune cycles
+    VirtualTuner *virtualTuner; // Demo mode only, on the simulated expander
 
     // Hardware status
-    bool mcpInitialized;
+    volatile bool mcpInitialized;
     bool ledInitialized;
-    bool i2cInitialized;
+    volatile bool i2cInitialized;
+
+    // Health supervisor (own task; the bus lock keeps it apart from other I2C users)
+    TaskHandle_t healthTask;
+    volatile HardwareHealth health;
+    const char *healthReason;
+    uint32_t healthSinceMs;
+    uint32_t backoffMs;
+    uint32_t nextRecoveryMs;
+    uint32_t lastBusErrors;
+    uint32_t recoveryAttempts;
+    uint32_t recoveries;
+    uint32_t busClears;
+    uint32_t expanderReinits;
+    HealthCallback healthCallback;
 
     // Helper methods
     bool initializeI2C();
     bool initializeMCP23017();
     bool initializeLED();
     void setupIndicatorPins();
+    void startSimulation();
+    void sampleIndicators();
+    static void healthTaskEntry(void *arg);
+    void checkHealth();
+    bool recordHealth(HardwareHealth state, const char *reason); // Safe under the bus lock; true if it changed
+    void publishHealth(HardwareHealth previous);                 // Log and push to the dashboard; no locks held
 
 public:
     HardwareManager(ConfigManager *configManager);
@@ -41,22 +82,37 @@ public:
     // Initialization
     bool begin();
     void reset();
+    void update(); // Call in main loop - expander polling & hot-plug
 
     // MCP23017 access
     MCP23017 *getMCP() { return mcp; }
+    MCP23017Bus &getBus() { return i2cBus; }
+    ExpanderRegistry &getExpanders() { return expanders; }
+    const I2CBusStats &getI2CStats() const { return i2cBus.stats(); }
 
-    // LED control
+    // LED control (only actual color changes reach the pixel)
+    void setLEDState(LedState state); // Pattern from the state table
     void setLED(const RGBColor &color);
     void setLED(uint8_t r, uint8_t g, uint8_t b);
     void setBlinkLED(const RGBColor &color, uint16_t intervalMs);
-    void stopBlink();
-    void updateLED(); // Call in main loop
+    void updateLED(); // Call in main loop - renders the current pattern
+    uint32_t getLEDPushCount() const { return statusLed.getPushCount(); }
 
-    // Status indicators (read from MCP23017)
+    // Status indicators (debounced; Raw = last undebounced sample)
     bool getTuningStatus();
     bool getSWRStatus();
     int getTuningStatusRaw();
     int getSWRStatusRaw();
+    String getIndicatorJson(); // Debounce state and glitch counters
+    uint32_t getIndicatorGlitches() const { return tuningFilter.glitchCount() + swrFilter.glitchCount(); }
+    void setEventLog(EventLog *log) { eventLog = log; } // Debounced indicator edges are logged here
+    IndicatorSampler &getSampler() { return sampler; }
+
+    // Demo mode (virtual tuner behind a simulated expander)
+    bool isDemoMode() const { return virtualTuner != nullptr; }
+    void setSimFrequency(uint32_t freqHz);
+    bool injectFault(const String &name, uint32_t value); // Fault name, "drop" (ms) or "reset"
+    String getSimulationJson();
 
     // Hardware status
     bool isMCPReady() const { return mcpInitialized; }
@@ -71,10 +127,17 @@ public:
     void runDiagnostics();
     String getHardwareStatus();
 
-    // Error recovery
+    // Error recovery (driven by the health supervisor)
     bool recoverI2C();
     bool recoverMCP23017();
     void attemptRecovery();
+
+    // Health supervisor
+    bool startSupervisor();
+    HardwareHealth getHealth() const { return health; }
+    String getHealthJson();
+    static const char *healthName(uint8_t state);
+    void setHealthCallback(HealthCallback callback) { healthCallback = callback; }
 };
 
 #endif // HARDWARE_MANAGER_H
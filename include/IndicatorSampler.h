@@ -0,0 +1,58 @@
+#ifndef INDICATOR_SAMPLER_H
+#define INDICATOR_SAMPLER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "Config.h"
+#include "ExpanderRegistry.h"
+
+// Run word layout: [15] SWR, [14] TUNING, [13] no data, [12:0] run length
+#define TRACE_SWR_BIT 0x8000
+#define TRACE_TUNING_BIT 0x4000
+#define TRACE_GAP_BIT 0x2000
+#define TRACE_CODE_MASK 0xE000
+#define TRACE_RUN_MAX 0x1FFF
+
+// Records TUNING and SWR at a fixed rate (up to 1 kHz) from its own task,
+// independent of loop() timing. Samples are stored as 16-bit run-length
+// words (two level bits, a gap bit for failed reads, 13 bits of count), so
+// a quiet tuner costs one word per ~8 s at 1 kHz and several minutes of a
+// busy one still fit the INDICATOR_TRACE_RUNS ring. The rate is constant
+// for everything in the ring: changing it starts a fresh trace.
+class IndicatorSampler
+{
+public:
+    explicit IndicatorSampler(ExpanderRegistry &registry);
+
+    bool begin(uint16_t rateHz);
+    void setRate(uint16_t rateHz); // 0 = off
+    bool isAvailable() const { return mutex != nullptr; }
+    uint16_t getRate() const { return periodMs ? 1000 / periodMs : 0; }
+
+    // Runs covering the last windowMs (at most INDICATOR_TRACE_EXPORT_MAX), oldest first:
+    // {"rate_hz":..,"end_ms":..,"runs":[[start_ms,duration_ms,state],...]}
+    // state bit 0 = TUNING, bit 1 = SWR, -1 = no data. {"error":..} if unavailable.
+    String getWindowJson(uint32_t windowMs);
+
+private:
+    ExpanderRegistry &expanders;
+    SemaphoreHandle_t mutex; // Sampler task vs. HTTP readers
+    TaskHandle_t task;
+    volatile uint16_t periodMs;
+
+    uint16_t runs[INDICATOR_TRACE_RUNS];
+    uint16_t head;  // Next word to start
+    uint16_t count; // Words in use
+    uint32_t totalSamples;
+    uint32_t lastSampleMs;
+    uint32_t readErrors;
+
+    static void samplerTask(void *arg);
+    void sample();
+    void append(uint16_t code);
+    void clear();
+};
+
+#endif // INDICATOR_SAMPLER_H
@@ -0,0 +1,95 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#define JSON_WRITER_MAX_DEPTH 16
+
+// Streaming JSON serializer into a caller-owned buffer: no document, no
+// heap, a few bytes of state. Commas, quoting and escaping are handled
+// here; the caller just nests begin/end calls and adds fields (key is
+// nullptr inside arrays). Once something doesn't fit the writer stops and
+// ok() turns false; the text is then incomplete and must not be sent.
+class JsonWriter
+{
+public:
+    JsonWriter(char *buffer, size_t capacity);
+
+    void reset();
+
+    void beginObject(const char *key = nullptr);
+    void endObject();
+    void beginArray(const char *key = nullptr);
+    void endArray();
+
+    void add(const char *key, const char *value); // Escaped string
+    void add(const char *key, const String &value) { add(key, value.c_str()); }
+    void add(const char *key, bool value);
+    void add(const char *key, int value) { addSigned(key, value); }
+    void add(const char *key, long value) { addSigned(key, value); }
+    void add(const char *key, long long value) { addSigned(key, value); }
+    void add(const char *key, unsigned value) { addUnsigned(key, value); }
+    void add(const char *key, unsigned long value) { addUnsigned(key, value); }
+    void add(const char *key, unsigned long long value) { addUnsigned(key, value); }
+    void addHex(const char *key, uint32_t value, bool prefix = true); // "0xb8" / "b8"
+    void addRaw(const char *key, const char *json);                   // Pre-built JSON value
+
+    bool ok() const { return !overflow; }
+    size_t length() const { return used; }
+    const char *c_str() const { return buffer; }
+
+private:
+    char *buffer;
+    size_t capacity;
+    size_t used;
+    bool overflow;
+    uint8_t depth;
+    uint32_t hasItems; // Bit per depth: a comma goes before the next item
+
+    void addSigned(const char *key, long long value);
+    void addUnsigned(const char *key, unsigned long long value);
+    void beginValue(const char *key);
+    void open(const char *key, char bracket);
+    void close(char bracket);
+    void write(const char *text, size_t length);
+    void write(const char *text) { write(text, strlen(text)); }
+    void writeString(const char *text);
+};
+
+// Preallocated output buffer shared by several tasks (loop, AsyncTCP).
+// Hold a Guard while serializing and until the text has been handed off
+// (copied into a WebSocket message buffer or an HTTP response).
+class JsonOutputBuffer
+{
+public:
+    explicit JsonOutputBuffer(size_t capacity);
+
+    bool begin(); // Allocates once; call from setup()
+    size_t getCapacity() const { return capacity; }
+    size_t getHighWater() const { return highWater; }
+    uint32_t getOverflows() const { return overflows; }
+
+    class Guard
+    {
+    public:
+        explicit Guard(JsonOutputBuffer &output);
+        ~Guard();
+
+        JsonWriter &writer() { return json; }
+
+    private:
+        JsonOutputBuffer &output;
+        JsonWriter json;
+    };
+
+private:
+    size_t capacity;
+    char *data;
+    SemaphoreHandle_t mutex;
+    size_t highWater;
+    uint32_t overflows;
+};
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,118 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <Arduino.h>
+
+#define LATENCY_HISTOGRAM_BUCKETS 24
+
+// Log2-bucketed histogram of microsecond values. Bucket 0 holds 0 us,
+// bucket n holds [2^(n-1), 2^n) us, the last bucket everything above.
+// Fixed size, no allocation; percentiles are bucket upper bounds.
+class LatencyHistogram
+{
+private:
+    uint32_t buckets[LATENCY_HISTOGRAM_BUCKETS];
+    uint32_t samples;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint64_t totalUs;
+
+    static uint8_t bucketFor(uint32_t us)
+    {
+        uint8_t bucket = 0;
+        while (us && bucket < LATENCY_HISTOGRAM_BUCKETS - 1)
+        {
+            us >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+public:
+    LatencyHistogram() { reset(); }
+
+    void reset()
+    {
+        memset(buckets, 0, sizeof(buckets));
+        samples = 0;
+        minUs = UINT32_MAX;
+        maxUs = 0;
+        totalUs = 0;
+    }
+
+    void record(uint32_t us)
+    {
+        buckets[bucketFor(us)]++;
+        samples++;
+        totalUs += us;
+        if (us < minUs)
+            minUs = us;
+        if (us > maxUs)
+            maxUs = us;
+    }
+
+    uint32_t count() const { return samples; }
+    uint32_t min() const { return samples ? minUs : 0; }
+    uint32_t max() const { return maxUs; }
+    uint32_t mean() const { return samples ? (uint32_t)(totalUs / samples) : 0; }
+
+    static uint32_t bucketUpperBound(uint8_t bucket)
+    {
+        return bucket == 0 ? 0 : (1UL << bucket) - 1;
+    }
+
+    // Upper bound of the bucket containing the given percentile (0-100)
+    uint32_t percentile(uint8_t pct) const
+    {
+        if (samples == 0)
+        {
+            return 0;
+        }
+
+        uint32_t target = ((uint64_t)samples * pct + 99) / 100;
+        uint32_t seen = 0;
+        for (uint8_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++)
+        {
+            seen += buckets[i];
+            if (seen >= target)
+            {
+                uint32_t bound = bucketUpperBound(i);
+                return bound < maxUs ? bound : maxUs;
+            }
+        }
+        return maxUs;
+    }
+
+    String toJson() const
+    {
+        String json = "{";
+        json += "\"count\":" + String(samples) + ",";
+        json += "\"min_us\":" + String(min()) + ",";
+        json += "\"mean_us\":" + String(mean()) + ",";
+        json += "\"p50_us\":" + String(percentile(50)) + ",";
+        json += "\"p90_us\":" + String(percentile(90)) + ",";
+        json += "\"p99_us\":" + String(percentile(99)) + ",";
+        json += "\"max_us\":" + String(maxUs) + ",";
+
+        // Only non-empty buckets: [upper bound in us, count]
+        json += "\"buckets\":[";
+        bool first = true;
+        for (uint8_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++)
+        {
+            if (buckets[i] == 0)
+            {
+                continue;
+            }
+            if (!first)
+            {
+                json += ",";
+            }
+            first = false;
+            json += "[" + String(bucketUpperBound(i)) + "," + String(buckets[i]) + "]";
+        }
+        json += "]}";
+        return json;
+    }
+};
+
+#endif // LATENCY_HISTOGRAM_H
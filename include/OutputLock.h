@@ -0,0 +1,28 @@
+#ifndef OUTPUT_LOCK_H
+#define OUTPUT_LOCK_H
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// Holds the output mutex (ButtonManager's, recursive) for the lifetime of a
+// scope; no-op while the mutex doesn't exist yet. Anything that rewrites the
+// expander's output configuration takes it before the bus lock.
+class OutputLock
+{
+public:
+    explicit OutputLock(SemaphoreHandle_t mutex) : mutex(mutex)
+    {
+        if (mutex)
+            xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    }
+    ~OutputLock()
+    {
+        if (mutex)
+            xSemaphoreGiveRecursive(mutex);
+    }
+
+private:
+    SemaphoreHandle_t mutex;
+};
+
+#endif // OUTPUT_LOCK_H
@@ -0,0 +1,83 @@
+#ifndef PERSISTENCE_SERVICE_H
+#define PERSISTENCE_SERVICE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include "Config.h"
+
+#define PERSIST_INVALID_KEY 0xFF
+
+// Writes flash for its owners, at most once per key per minimum interval.
+// Owners keep their state in RAM, register a flush function and call
+// markDirty() on every change (any task); service() in the main loop calls
+// the flush once the interval since that key's last write has passed, so
+// a burst of changes (ANT toggled from a script) is one write. flushAll()
+// writes everything pending regardless of the interval; it runs from the
+// restart shutdown hook, so planned restarts (OTA, portal, /restart) lose
+// nothing.
+//
+// markDirty() runs in whatever task changed the setting (async_tcp for the
+// dashboard and CI-V) while service() runs in the loop: the dirty flag, its
+// timestamp and the coalesced count change only under a spinlock.
+//
+// Writes are counted per key since boot and over the device's lifetime
+// (stored in PREFS_WEAR_NAMESPACE, itself rate-limited to
+// PERSIST_WEAR_MIN_INTERVAL_MS). Brown-out resets are counted at boot.
+class PersistenceService
+{
+public:
+    typedef bool (*FlushFunction)(void *context);
+
+    PersistenceService();
+
+    bool begin(); // Opens the wear counters, hooks restart; call before registerKey()
+
+    // Returns PERSIST_INVALID_KEY when the table is full
+    uint8_t registerKey(const char *name, uint32_t minIntervalMs, FlushFunction flush, void *context);
+    void setMinInterval(uint8_t key, uint32_t minIntervalMs);
+
+    void markDirty(uint8_t key);
+    void service();  // Call in main loop
+    void flushAll(); // Everything pending, now
+
+    uint32_t getPendingCount() const;
+    String getJson();
+
+private:
+    struct KeyState
+    {
+        const char *name;
+        FlushFunction flush;
+        void *context;
+        uint32_t minIntervalMs;
+        volatile bool dirty;    // dirty, dirtySinceMs, coalesced: under lock
+        uint32_t dirtySinceMs;  // First change not yet written
+        uint32_t lastWriteMs;
+        bool written;           // lastWriteMs is valid
+        uint32_t writes;        // Since boot
+        uint32_t coalesced;     // Changes folded into an earlier pending write
+        uint32_t failures;
+        uint32_t lifetimeBase;  // Lifetime writes before this boot
+        uint32_t lifetimeSaved; // Lifetime count last stored
+    };
+
+    KeyState keys[PERSIST_MAX_KEYS];
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    uint8_t keyCount;
+    uint8_t wearKey;
+    Preferences wear;
+    bool wearOpen;
+    uint32_t brownouts; // Lifetime
+    bool brownoutBoot;
+
+    static PersistenceService *instance;
+    static void onShutdown();
+    static bool flushWear(void *context);
+
+    bool flushKey(uint8_t key);
+    void clearDirty(uint8_t key);
+    uint32_t lifetime(const KeyState &state) const { return state.lifetimeBase + state.writes; }
+};
+
+#endif // PERSISTENCE_SERVICE_H
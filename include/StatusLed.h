@@ -0,0 +1,77 @@
+#ifndef STATUS_LED_H
+#define STATUS_LED_H
+
+#include <Arduino.h>
+#include <driver/rmt.h>
+#include "Config.h"
+
+enum LedEffect : uint8_t
+{
+    LED_SOLID = 0,
+    LED_BLINK,    // colors[0] on / off, half a period each
+    LED_BREATHE,  // colors[0] fading in and out over one period
+    LED_SEQUENCE  // colors[0..count-1], one period each
+};
+
+struct LedPattern
+{
+    LedEffect effect;
+    uint16_t periodMs;
+    uint8_t colorCount;
+    RGBColor colors[LED_PATTERN_MAX_COLORS];
+};
+
+// System states the LED shows, in priority order (see ledPatternTable)
+enum LedState : uint8_t
+{
+    LED_STATE_OFF = 0,
+    LED_STATE_BOOT,
+    LED_STATE_OTA,
+    LED_STATE_PORTAL,      // Captive portal waiting for WiFi credentials
+    LED_STATE_WIFI_DOWN,
+    LED_STATE_FAULT,       // Hardware fault (expander missing, outputs not verifying)
+    LED_STATE_REMOTE,      // Remote CI-V WebSocket connected
+    LED_STATE_READY,
+    LED_STATE_COUNT
+};
+
+// One WS2812 pixel on an RMT TX channel. Callers set a state or pattern
+// (cheap, any number of times per loop); render() works out the color the
+// pattern gives for the current time and only transmits when that color
+// differs from the last one sent. Transmission is queued to the RMT
+// peripheral and returns immediately - no bit-banging with interrupts off.
+// If the previous frame is still on the wire the change waits for the next
+// render().
+class StatusLed
+{
+public:
+    StatusLed();
+
+    bool begin(uint8_t pin, uint8_t level); // level scales every color (0-255)
+    bool isReady() const { return ready; }
+
+    void setState(LedState state);              // Pattern from the state table
+    void setPattern(const LedPattern &pattern); // Ad-hoc pattern (restarts its phase only if it changed)
+    void render(uint32_t nowMs);                // Call in main loop
+
+    uint32_t getPushCount() const { return pushes; }
+
+    static const LedPattern &patternFor(LedState state);
+
+private:
+    rmt_item32_t items[24]; // One GRB frame; must stay valid while RMT sends it
+    bool ready;
+    uint8_t brightness;
+
+    LedPattern pattern;
+    uint32_t phaseStartMs;
+    RGBColor shown;
+    bool pending; // A change couldn't be sent yet
+    uint32_t lastRenderMs;
+    uint32_t pushes;
+
+    RGBColor colorAt(uint32_t nowMs) const;
+    bool push(const RGBColor &color);
+};
+
+#endif // STATUS_LED_H
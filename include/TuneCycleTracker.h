@@ -0,0 +1,90 @@
+#ifndef TUNE_CYCLE_TRACKER_H
+#define TUNE_CYCLE_TRACKER_H
+
+#include <Arduino.h>
+#include "ButtonId.h"
+#include "Config.h"
+
+enum TuneCycleOutcome : uint8_t
+{
+    CYCLE_OK = 0,   // TUNING rose and fell, SWR good afterwards
+    CYCLE_HIGH_SWR, // Tuner gave up / finished without a match
+    CYCLE_NO_START, // TUNING never rose after the TUNE pulse
+    CYCLE_TIMEOUT,  // TUNING still active after TUNE_CYCLE_MAX_MS
+    CYCLE_OUTCOME_COUNT
+};
+
+// One finished cycle
+struct TuneCycle
+{
+    uint32_t startMs;    // TUNE pulse
+    uint32_t durationMs; // TUNE pulse to TUNING falling (0 for no-start)
+    uint32_t freqHz;     // 0 = unknown
+    uint8_t ant;         // 0 = ANT 1, 1 = ANT 2
+    uint8_t band;        // Index into the band table
+    uint8_t outcome;
+};
+
+// Per antenna/band statistics: outcome counts and a ring of the most
+// recent match times for rolling percentiles
+struct TuneCycleBucket
+{
+    uint32_t outcomes[CYCLE_OUTCOME_COUNT];
+    uint16_t recentMs[TUNE_CYCLE_HISTORY]; // Match times of successful cycles
+    uint8_t recentCount;
+    uint8_t recentNext;
+};
+
+// Follows each TUNE pulse through the tuner's TUNING indicator (rise, then
+// fall) and reads SWR once it has settled, giving a duration and outcome
+// per cycle. Cycles are binned by antenna and by the amateur band of the
+// radio's frequency (from the tune memory's CI-V snoop) when known.
+class TuneCycleTracker
+{
+public:
+    typedef void (*CycleCallback)(const String &json); // Finished cycle, for the dashboard
+
+    TuneCycleTracker();
+
+    // Feeds
+    void onButtonPress(ButtonId buttonId); // Any task
+    void update(bool tuning, bool swrGood, uint32_t freqHz, bool ant2); // Call in main loop
+
+    void setCycleCallback(CycleCallback callback) { cycleCallback = callback; }
+    void reset();
+
+    String getStatusJson();
+    String getLastCycleJson(); // {"type":"tune_cycle",...} for the dashboard
+    static const char *outcomeName(uint8_t outcome);
+    static uint8_t bandFor(uint32_t freqHz);
+
+private:
+    enum State : uint8_t
+    {
+        IDLE,
+        WAIT_RISE,  // TUNE pressed, waiting for TUNING
+        TUNING,     // Waiting for TUNING to fall
+        SETTLE      // Letting SWR settle before reading it
+    };
+
+    volatile bool tunePressed; // Set from the press callback
+    volatile uint32_t tunePressedMs;
+
+    State state;
+    TuneCycle current;
+    uint32_t fellAtMs;
+    uint32_t aborted; // Cycles restarted by another TUNE before finishing
+
+    TuneCycleBucket buckets[2][TUNE_CYCLE_BAND_COUNT]; // [ant][band]
+    TuneCycleBucket overall;
+    TuneCycle last;
+    bool haveLast;
+    CycleCallback cycleCallback;
+
+    void finish(uint8_t outcome, uint32_t durationMs);
+    static uint16_t percentile(const TuneCycleBucket &bucket, uint8_t pct);
+    static void record(TuneCycleBucket &bucket, uint8_t outcome, uint32_t durationMs);
+    static String bucketJson(const TuneCycleBucket &bucket);
+};
+
+#endif // TUNE_CYCLE_TRACKER_H
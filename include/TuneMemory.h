@@ -0,0 +1,96 @@
+#ifndef TUNE_MEMORY_H
+#define TUNE_MEMORY_H
+
+#include <Arduino.h>
+#include "ButtonId.h"
+#include "Config.h"
+
+// Forward declarations
+class ConfigManager;
+class ButtonManager;
+class PersistenceService;
+
+#define TUNE_MEMORY_FLAG_ANT 0x01 // ant field is meaningful (latching ANT model)
+
+// One remembered match per frequency segment
+struct TuneMemoryEntry
+{
+    uint16_t segment; // frequency / TUNE_MEMORY_SEGMENT_HZ
+    int16_t cSteps;   // Capacitor position, in steps from the zero point
+    int16_t lSteps;   // Inductor position, in steps from the zero point
+    uint8_t ant;      // 0 = ANT 1, 1 = ANT 2
+    uint8_t flags;
+};
+
+// Learns which C/L step position (and ANT) gave a good SWR indication per
+// frequency segment, and replays it through the button sequencer when the
+// radio moves to another segment. The radio's frequency comes from snooped
+// CI-V 00/03 frames. The C/L position is counted from every C/L press; a
+// TUNE cycle moves the tuner on its own, so it makes the position unknown
+// until the user zeroes it again.
+//
+// The table is kept sorted by segment, in RAM and as-is on LittleFS
+// (TUNE_MEMORY_FILE); lookups are a binary search.
+class TuneMemory
+{
+private:
+    ConfigManager *config;
+    ButtonManager *buttons;
+    PersistenceService *persistence;
+    uint8_t persistKey;
+
+    TuneMemoryEntry entries[TUNE_MEMORY_MAX_ENTRIES];
+    uint16_t entryCount;
+
+    // Tuner position estimate (updated from the press callback, any task)
+    volatile int16_t cPos;
+    volatile int16_t lPos;
+    volatile bool positionKnown;
+    volatile bool positionChanged;
+
+    // Radio state
+    uint32_t frequencyHz;
+    uint16_t currentSegment;
+    uint16_t handledSegment; // Segment last replayed or recorded
+    unsigned long frequencyChangedAt;
+
+    unsigned long swrGoodSince;
+
+    // Helper methods
+    int lowerBound(uint16_t segment) const;
+    bool store(uint16_t segment);
+    bool replay(const TuneMemoryEntry &entry);
+    bool load();
+    bool save();
+    void markDirty(); // Saved by the persistence service, TUNE_MEMORY_SAVE_INTERVAL apart
+    static bool flushFile(void *context);
+
+public:
+    TuneMemory(ConfigManager *configManager, ButtonManager *buttonManager, PersistenceService *persistenceService);
+
+    bool begin();  // Loads the table from LittleFS
+    void update(bool swrGood); // Call in main loop - records, replays
+
+    // Feeds
+    void onCivFrame(const uint8_t *frame, size_t length);
+    void onButtonPress(ButtonId buttonId, uint32_t durationMs); // 0 = hold of unknown length
+
+    // Position
+    void zeroPosition(); // Tuner is at the reference point (e.g. both at minimum)
+    bool isPositionKnown() const { return positionKnown; }
+
+    // Table
+    const TuneMemoryEntry *lookup(uint16_t segment) const; // Exact, else nearest within TUNE_MEMORY_MAX_DISTANCE
+    bool recordNow();
+    bool forget(uint32_t freqHz);
+    void clear();
+    uint16_t getEntryCount() const { return entryCount; }
+
+    uint32_t getFrequency() const { return frequencyHz; }
+    static uint16_t segmentFor(uint32_t freqHz) { return freqHz / TUNE_MEMORY_SEGMENT_HZ; }
+    static bool parseFrequency(const uint8_t *bcd, uint32_t &freqHz); // 5 bytes, Icom BCD order
+
+    String getStatusJson(bool includeEntries = true);
+};
+
+#endif // TUNE_MEMORY_H
@@ -0,0 +1,61 @@
+#ifndef TUNER_MODEL_H
+#define TUNER_MODEL_H
+
+#include <Arduino.h>
+#include "JsonWriter.h"
+
+// =========================================================================
+// TUNER MODEL REGISTRY
+// =========================================================================
+//
+// Everything that differs between tuner models, in one table. The active
+// model is resolved once (boot, model change) and cached as a pointer into
+// the table, so behaviour checks are a bit test instead of a string match.
+//
+// Adding a model: append a TunerModelId before TUNER_MODEL_COUNT and a row
+// to tunerModels[] in the same position, with a CI-V code not used yet.
+
+enum TunerModelId : uint8_t
+{
+    TUNER_MODEL_991_994 = 0,
+    TUNER_MODEL_998,
+    TUNER_MODEL_COUNT
+};
+
+enum TunerCapability : uint16_t
+{
+    TUNER_CAP_ANT_MOMENTARY = 1 << 0,        // ANT is a toggle pulse; otherwise a latched ANT 1/ANT 2 line
+    TUNER_CAP_AUTO = 1 << 1,                 // Has the AUTO/SEMI latch (checked in ButtonManager::setButtonOutput)
+    TUNER_CAP_INDICATOR_ACTIVE_LOW = 1 << 2  // TUNING/SWR lines pull low when active
+};
+
+struct TunerModel
+{
+    TunerModelId id;
+    const char *name;       // Stored in the config, shown in the UI
+    uint8_t civCode;        // CI-V 30 model byte
+    uint16_t caps;          // TunerCapability bits
+    uint16_t antPulseMs;    // ANT press for momentary models
+    uint16_t buttonPulseMs; // TUNE / C / L press from a CI-V 34 command
+
+    constexpr bool has(uint16_t cap) const { return (caps & cap) != 0; }
+};
+
+static constexpr TunerModel tunerModels[TUNER_MODEL_COUNT] = {
+    {TUNER_MODEL_991_994, "991-994", 0x00, TUNER_CAP_AUTO, 0, 200},
+    {TUNER_MODEL_998, "998", 0x01, TUNER_CAP_ANT_MOMENTARY, 500, 200}};
+
+static_assert(tunerModels[TUNER_MODEL_991_994].id == TUNER_MODEL_991_994 &&
+                  tunerModels[TUNER_MODEL_998].id == TUNER_MODEL_998,
+              "tunerModels[] rows must be in TunerModelId order");
+
+#define TUNER_MODEL_DEFAULT TUNER_MODEL_991_994
+
+// Lookups (nullptr if unknown)
+const TunerModel *findTunerModel(const char *name);
+const TunerModel *findTunerModelByCode(uint8_t civCode);
+
+// Model and capability flags as a JSON object
+void writeTunerModelJson(JsonWriter &json, const char *key, const TunerModel &model);
+
+#endif // TUNER_MODEL_H
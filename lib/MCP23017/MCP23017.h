@@ -2,31 +2,39 @@
 #ifndef MCP23017_H
 #define MCP23017_H
 
-#include <Wire.h>
-
-#define MCP23017_IODIRA 0x00
-#define MCP23017_IODIRB 0x01
-#define MCP23017_GPPUA 0x0C
-#define MCP23017_GPPUB 0x0D
-#define MCP23017_GPIOA 0x12
-#define MCP23017_GPIOB 0x13
-#define MCP23017_OLATA 0x14
-#define MCP23017_OLATB 0x15
-
-class MCP23017
+#include "MCP23017Bus.h"
+
+#ifdef MCP23017_SIMULATED_BUS
+// Host-native builds have no Arduino.h; provide the pin mode constants
+#ifndef INPUT
+#define INPUT 0x01
+#endif
+#ifndef OUTPUT
+#define OUTPUT 0x03
+#endif
+#ifndef INPUT_PULLUP
+#define INPUT_PULLUP 0x05
+#endif
+#endif
+
+template <typename Bus>
+class MCP23017Driver
 {
 public:
-    MCP23017(uint8_t address = 0x20) : _address(address), iodirA(0xFF), iodirB(0xFF), gppuA(0), gppuB(0), gpioA(0), gpioB(0) {}
+    MCP23017Driver(uint8_t address, Bus &bus) : bus(bus), _address(address), iodirA(0xFF), iodirB(0xFF), gppuA(0), gppuB(0), gpioA(0), gpioB(0) {}
 
+    // Pushes the cached configuration to the device. The bus itself must
+    // already be up (Wire.begin() is owned by whoever owns the bus).
+    // The latch goes first: after a power-on reset OLAT is 0, and turning
+    // the pins into outputs before it is restored would drive them LOW.
     void begin()
     {
-        Wire.begin();
-        writeRegister(MCP23017_IODIRA, iodirA);
-        writeRegister(MCP23017_IODIRB, iodirB);
-        writeRegister(MCP23017_GPPUA, gppuA); // Initialize pull-ups
-        writeRegister(MCP23017_GPPUB, gppuB); // Initialize pull-ups
-        writeRegister(MCP23017_GPIOA, gpioA);
-        writeRegister(MCP23017_GPIOB, gpioB);
+        uint8_t gpio[2] = {gpioA, gpioB};
+        uint8_t gppu[2] = {gppuA, gppuB}; // Initialize pull-ups
+        uint8_t iodir[2] = {iodirA, iodirB};
+        writeRegisters(MCP23017_GPIOA, gpio, 2);
+        writeRegisters(MCP23017_GPPUA, gppu, 2);
+        writeRegisters(MCP23017_IODIRA, iodir, 2);
     }
 
     void pinMode(uint8_t pin, uint8_t mode)
@@ -74,6 +82,39 @@ public:
         }
     }
 
+    // pinMode() for every pin in `pins` (bit n = pin n): IODIRA/B go out in
+    // one sequential write, GPPUA/B only if the pull-ups changed
+    void pinModeMask(uint16_t pins, uint8_t mode)
+    {
+        uint16_t iodir = getDirection();
+        uint16_t gppu = ((uint16_t)gppuB << 8) | gppuA;
+        uint16_t oldGppu = gppu;
+
+        if (mode == OUTPUT)
+        {
+            iodir &= ~pins;
+            gppu &= ~pins; // Outputs don't need pull-ups
+        }
+        else
+        {
+            iodir |= pins;
+            gppu = (mode == INPUT_PULLUP) ? (gppu | pins) : (gppu & ~pins);
+        }
+
+        iodirA = iodir & 0xFF;
+        iodirB = (iodir >> 8) & 0xFF;
+        gppuA = gppu & 0xFF;
+        gppuB = (gppu >> 8) & 0xFF;
+
+        if (gppu != oldGppu)
+        {
+            uint8_t buf[2] = {gppuA, gppuB};
+            writeRegisters(MCP23017_GPPUA, buf, 2);
+        }
+        uint8_t buf[2] = {iodirA, iodirB};
+        writeRegisters(MCP23017_IODIRA, buf, 2);
+    }
+
     void digitalWrite(uint8_t pin, uint8_t value)
     {
         if (pin < 8)
@@ -115,55 +156,106 @@ public:
     void enableInterruptsPA(uint8_t mode)
     {
         // GPINTENA: Enable interrupt on change for PA pins
-        writeRegister(0x04, 0xFF); // GPINTENA
+        writeRegister(MCP23017_GPINTENA, 0xFF);
         // INTCONA: Interrupt control (0=change, 1=compare to DEFVAL)
         if (mode == 0)
         {
-            writeRegister(0x08, 0x00); // INTCONA: interrupt on change
+            writeRegister(MCP23017_INTCONA, 0x00); // interrupt on change
         }
         else
         {
-            writeRegister(0x08, 0xFF); // INTCONA: compare to DEFVAL
+            writeRegister(MCP23017_INTCONA, 0xFF); // compare to DEFVAL
             if (mode == 1)
-                writeRegister(0x06, 0x00); // DEFVALA: rising edge (compare to 0)
+                writeRegister(MCP23017_DEFVALA, 0x00); // rising edge (compare to 0)
             else
-                writeRegister(0x06, 0xFF); // DEFVALA: falling edge (compare to 1)
+                writeRegister(MCP23017_DEFVALA, 0xFF); // falling edge (compare to 1)
         }
         // IOCON: Enable mirroring, open-drain, etc. if needed
     }
 
     void disableInterruptsPA()
     {
-        writeRegister(0x04, 0x00); // GPINTENA
+        writeRegister(MCP23017_GPINTENA, 0x00);
     }
 
     // Returns which PA pin triggered (INTFA)
     uint8_t getInterruptSourcePA()
     {
-        return readRegister(0x0E); // INTFA
+        return readRegister(MCP23017_INTFA);
     }
 
     // Clear interrupts (read INTCAPA)
     void clearInterruptsPA()
     {
-        readRegister(0x10); // INTCAPA
+        readRegister(MCP23017_INTCAPA);
     }
 
-    // Bulk GPIO operations
+    // Bulk GPIO operations (one sequential transaction each)
     uint16_t readAllPins()
     {
-        uint8_t a = readRegister(MCP23017_GPIOA);
-        uint8_t b = readRegister(MCP23017_GPIOB);
-        return ((uint16_t)b << 8) | a;
+        uint8_t buf[2] = {0, 0};
+        readRegisters(MCP23017_GPIOA, buf, 2);
+        return ((uint16_t)buf[1] << 8) | buf[0];
+    }
+
+    // Same, but reports a failed transaction instead of reading 0
+    bool readAllPins(uint16_t &value)
+    {
+        uint8_t buf[2] = {0, 0};
+        if (!readRegisters(MCP23017_GPIOA, buf, 2))
+        {
+            return false;
+        }
+        value = ((uint16_t)buf[1] << 8) | buf[0];
+        return true;
     }
 
     void writeAllPins(uint16_t value)
     {
-        writeRegister(MCP23017_GPIOA, value & 0xFF);
-        writeRegister(MCP23017_GPIOB, (value >> 8) & 0xFF);
+        gpioA = value & 0xFF;
+        gpioB = (value >> 8) & 0xFF;
+        uint8_t buf[2] = {gpioA, gpioB};
+        writeRegisters(MCP23017_GPIOA, buf, 2);
     }
 
+    // Last value written to (or staged for) the output latch, no bus access
+    uint16_t getOutputLatch() const { return ((uint16_t)gpioB << 8) | gpioA; }
+
+    // Cached IODIR (bit set = input), no bus access
+    uint16_t getDirection() const { return ((uint16_t)iodirB << 8) | iodirA; }
+
+    // IODIR as the device reports it. Differs from getDirection() after the
+    // expander reset on its own (power-on IODIR is all inputs).
+    bool readDirection(uint16_t &value)
+    {
+        uint8_t buf[2] = {0, 0};
+        if (!readRegisters(MCP23017_IODIRA, buf, 2))
+        {
+            return false;
+        }
+        value = ((uint16_t)buf[1] << 8) | buf[0];
+        return true;
+    }
+
+    // Pin levels and output latch as the device reports them, in one
+    // sequential read (GPIOA..OLATB). False if the bus transaction failed.
+    bool readOutputState(uint16_t &gpio, uint16_t &olat)
+    {
+        uint8_t buf[4] = {0, 0, 0, 0};
+        if (!readRegisters(MCP23017_GPIOA, buf, 4))
+        {
+            return false;
+        }
+        gpio = ((uint16_t)buf[1] << 8) | buf[0];
+        olat = ((uint16_t)buf[3] << 8) | buf[2];
+        return true;
+    }
+
+    uint8_t getAddress() const { return _address; }
+    Bus &getBus() { return bus; }
+
 private:
+    Bus &bus;
     uint8_t _address;
     uint8_t iodirA, iodirB;
     uint8_t gppuA, gppuB;
@@ -171,24 +263,41 @@ private:
 
     void writeRegister(uint8_t reg, uint8_t value)
     {
-        Wire.beginTransmission(_address);
-        Wire.write(reg);
-        Wire.write(value);
-        Wire.endTransmission();
+        bus.writeRegisters(_address, reg, &value, 1);
     }
 
     uint8_t readRegister(uint8_t reg)
     {
-        Wire.beginTransmission(_address);
-        Wire.write(reg);
-        Wire.endTransmission();
-        Wire.requestFrom(_address, (uint8_t)1);
-        if (Wire.available())
+        uint8_t value = 0;
+        readRegisters(reg, &value, 1);
+        return value;
+    }
+
+    bool writeRegisters(uint8_t reg, const uint8_t *data, size_t len)
+    {
+        return bus.writeRegisters(_address, reg, data, len);
+    }
+
+    bool readRegisters(uint8_t reg, uint8_t *data, size_t len)
+    {
+        if (!bus.readRegisters(_address, reg, data, len))
         {
-            return Wire.read();
+            memset(data, 0, len); // Failed reads report LOW, as before
+            return false;
         }
-        return 0;
+        return true;
     }
 };
 
+// Bus used by the firmware. Everything goes through the tracing wrapper so
+// I2C transactions can be counted; host builds use the simulator only, the
+// device can switch to it at boot for demo mode.
+#ifdef MCP23017_SIMULATED_BUS
+typedef TracingBus<SimulatedMCP23017Bus> MCP23017Bus;
+#else
+typedef TracingBus<SwitchableMCP23017Bus> MCP23017Bus;
+#endif
+
+typedef MCP23017Driver<MCP23017Bus> MCP23017;
+
 #endif // MCP23017_H
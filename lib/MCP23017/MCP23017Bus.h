@@ -0,0 +1,608 @@
+#ifndef MCP23017_BUS_H
+#define MCP23017_BUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// =========================================================================
+// I2C BUS CONCEPT
+// =========================================================================
+//
+// MCP23017Driver<Bus> talks to the expander only through these three calls,
+// so any type providing them can be plugged in:
+//
+//   bool writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, size_t len);
+//   bool readRegisters(uint8_t address, uint8_t reg, uint8_t *data, size_t len);
+//   bool probe(uint8_t address);
+//
+// Each call is exactly one I2C transaction (register pointer + payload,
+// repeated start for reads). Multi-byte calls rely on the MCP23017's
+// sequential addressing (IOCON.SEQOP = 0, BANK = 0), so GPIOA/GPIOB or
+// IODIRA/IODIRB can be moved in a single burst.
+//
+// Recovery hooks used by the health supervisor (trivial on the simulator):
+//
+//   void lock(); void unlock();               // Hold the bus across several calls
+//   bool linesIdle(uint8_t sda, uint8_t scl); // SDA and SCL both released
+//   bool recover(uint8_t sda, uint8_t scl, uint32_t clockHz); // Bus clear + re-init
+//
+// Implementations:
+//   MCP23017WireBus        - real hardware via an Arduino TwoWire instance
+//   SimulatedMCP23017Bus   - register-accurate model of up to 8 expanders
+//   SwitchableMCP23017Bus  - one of the two above, picked at boot (demo mode)
+//   TracingBus<Inner>      - counts transactions/bytes of any inner bus
+
+// Register map (IOCON.BANK = 0)
+#define MCP23017_IODIRA 0x00
+#define MCP23017_IODIRB 0x01
+#define MCP23017_IPOLA 0x02
+#define MCP23017_IPOLB 0x03
+#define MCP23017_GPINTENA 0x04
+#define MCP23017_GPINTENB 0x05
+#define MCP23017_DEFVALA 0x06
+#define MCP23017_DEFVALB 0x07
+#define MCP23017_INTCONA 0x08
+#define MCP23017_INTCONB 0x09
+#define MCP23017_IOCONA 0x0A
+#define MCP23017_IOCONB 0x0B
+#define MCP23017_GPPUA 0x0C
+#define MCP23017_GPPUB 0x0D
+#define MCP23017_INTFA 0x0E
+#define MCP23017_INTFB 0x0F
+#define MCP23017_INTCAPA 0x10
+#define MCP23017_INTCAPB 0x11
+#define MCP23017_GPIOA 0x12
+#define MCP23017_GPIOB 0x13
+#define MCP23017_OLATA 0x14
+#define MCP23017_OLATB 0x15
+#define MCP23017_REGISTER_COUNT 0x16
+
+#define MCP23017_IOCON_SEQOP 0x20
+
+// Hardware address range (A2..A0 strapping)
+#define MCP23017_BASE_ADDRESS 0x20
+#define MCP23017_MAX_DEVICES 8
+
+#ifndef MCP23017_SIMULATED_BUS
+#include <Wire.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// =========================================================================
+// REAL HARDWARE BUS
+// =========================================================================
+
+// Every transaction holds a recursive bus lock, so a caller that needs the
+// bus to itself for a while (line recovery, re-initializing an expander)
+// can lock() around several transactions and nobody interleaves.
+class MCP23017WireBus
+{
+public:
+    explicit MCP23017WireBus(TwoWire &wire = Wire) : wire(wire), mutex(xSemaphoreCreateRecursiveMutex()) {}
+
+    void lock() { xSemaphoreTakeRecursive(mutex, portMAX_DELAY); }
+    void unlock() { xSemaphoreGiveRecursive(mutex); }
+
+    bool writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, size_t len)
+    {
+        Guard guard(*this);
+        wire.beginTransmission(address);
+        wire.write(reg);
+        wire.write(data, len);
+        return wire.endTransmission() == 0;
+    }
+
+    bool readRegisters(uint8_t address, uint8_t reg, uint8_t *data, size_t len)
+    {
+        Guard guard(*this);
+        wire.beginTransmission(address);
+        wire.write(reg);
+        if (wire.endTransmission(false) != 0)
+        {
+            return false;
+        }
+
+        if (wire.requestFrom(address, (uint8_t)len) != len)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < len; i++)
+        {
+            data[i] = wire.read();
+        }
+        return true;
+    }
+
+    bool probe(uint8_t address)
+    {
+        Guard guard(*this);
+        wire.beginTransmission(address);
+        return wire.endTransmission() == 0;
+    }
+
+    // Both lines high while nobody is transmitting. A slave stopped
+    // mid-byte (reset of the master, glitch on SCL) holds SDA low forever.
+    bool linesIdle(uint8_t sdaPin, uint8_t sclPin)
+    {
+        Guard guard(*this);
+        return digitalRead(sdaPin) == HIGH && digitalRead(sclPin) == HIGH;
+    }
+
+    // Standard bus clear: release the controller, clock SCL until the
+    // slave lets go of SDA (at most 9 clocks finish any byte), send a
+    // STOP, then bring the controller back up. True if SDA is free.
+    bool recover(uint8_t sdaPin, uint8_t sclPin, uint32_t clockHz)
+    {
+        Guard guard(*this);
+        wire.end();
+
+        pinMode(sdaPin, INPUT_PULLUP);
+        pinMode(sclPin, OUTPUT_OPEN_DRAIN);
+        digitalWrite(sclPin, HIGH);
+        delayMicroseconds(5);
+
+        for (uint8_t i = 0; i < 9 && digitalRead(sdaPin) == LOW; i++)
+        {
+            digitalWrite(sclPin, LOW);
+            delayMicroseconds(5);
+            digitalWrite(sclPin, HIGH);
+            delayMicroseconds(5);
+        }
+
+        // STOP: SDA rises while SCL is high
+        pinMode(sdaPin, OUTPUT_OPEN_DRAIN);
+        digitalWrite(sdaPin, LOW);
+        delayMicroseconds(5);
+        digitalWrite(sclPin, HIGH);
+        delayMicroseconds(5);
+        digitalWrite(sdaPin, HIGH);
+        delayMicroseconds(5);
+
+        pinMode(sdaPin, INPUT_PULLUP);
+        bool released = digitalRead(sdaPin) == HIGH;
+
+        wire.begin(sdaPin, sclPin, clockHz);
+        return released;
+    }
+
+    TwoWire &getWire() { return wire; }
+
+    class Guard
+    {
+    public:
+        explicit Guard(MCP23017WireBus &bus) : bus(bus) { bus.lock(); }
+        ~Guard() { bus.unlock(); }
+
+    private:
+        MCP23017WireBus &bus;
+    };
+
+private:
+    TwoWire &wire;
+    SemaphoreHandle_t mutex;
+};
+#endif // MCP23017_SIMULATED_BUS
+
+// =========================================================================
+// SIMULATED BUS
+// =========================================================================
+
+// Register-level model of MCP23017 expanders at 0x20-0x27. Outputs follow
+// OLAT, inputs follow externally driven levels (or the pull-up when the pin
+// is left floating), IPOL inverts GPIO reads, and interrupt-on-change sets
+// INTF/INTCAP until GPIO or INTCAP is read. Only BANK = 0 is modelled.
+class SimulatedMCP23017Bus
+{
+public:
+    SimulatedMCP23017Bus() : presentMask(0)
+    {
+        for (uint8_t i = 0; i < MCP23017_MAX_DEVICES; i++)
+        {
+            powerOnReset(devices[i]);
+        }
+    }
+
+    // Bus population
+    void attach(uint8_t address)
+    {
+        Device *dev = slot(address);
+        if (dev)
+        {
+            powerOnReset(*dev);
+            presentMask |= (1 << (address - MCP23017_BASE_ADDRESS));
+        }
+    }
+
+    void detach(uint8_t address)
+    {
+        if (slot(address))
+        {
+            presentMask &= ~(1 << (address - MCP23017_BASE_ADDRESS));
+        }
+    }
+
+    bool isAttached(uint8_t address) const
+    {
+        return address >= MCP23017_BASE_ADDRESS && address < MCP23017_BASE_ADDRESS + MCP23017_MAX_DEVICES &&
+               (presentMask & (1 << (address - MCP23017_BASE_ADDRESS)));
+    }
+
+    // Simulates a device reset (e.g. a brown-out on the expander only)
+    void reset(uint8_t address)
+    {
+        Device *dev = slot(address);
+        if (dev)
+        {
+            powerOnReset(*dev);
+        }
+    }
+
+    // External world: drive input pins (pin 0-15). Undriven pins float.
+    void driveInput(uint8_t address, uint8_t pin, bool level)
+    {
+        Device *dev = slot(address);
+        if (!dev || pin > 15)
+        {
+            return;
+        }
+        uint16_t before = pinLevels(*dev);
+        dev->driven |= (1 << pin);
+        if (level)
+            dev->external |= (1 << pin);
+        else
+            dev->external &= ~(1 << pin);
+        latchInterrupts(*dev, before);
+    }
+
+    void releaseInput(uint8_t address, uint8_t pin)
+    {
+        Device *dev = slot(address);
+        if (!dev || pin > 15)
+        {
+            return;
+        }
+        uint16_t before = pinLevels(*dev);
+        dev->driven &= ~(1 << pin);
+        latchInterrupts(*dev, before);
+    }
+
+    // Electrical level currently present on each pin (bit per pin)
+    uint16_t pinLevels(uint8_t address) const
+    {
+        const Device *dev = slot(address);
+        return dev ? pinLevels(*dev) : 0;
+    }
+
+    uint8_t registerValue(uint8_t address, uint8_t reg) const
+    {
+        const Device *dev = slot(address);
+        return (dev && reg < MCP23017_REGISTER_COUNT) ? peekRegister(*dev, reg) : 0;
+    }
+
+    // Bus concept
+    bool writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, size_t len)
+    {
+        if (!isAttached(address) || reg >= MCP23017_REGISTER_COUNT)
+        {
+            return false;
+        }
+        Device &dev = *slot(address);
+        for (size_t i = 0; i < len; i++)
+        {
+            writeRegister(dev, reg, data[i]);
+            reg = nextPointer(dev, reg);
+        }
+        return true;
+    }
+
+    bool readRegisters(uint8_t address, uint8_t reg, uint8_t *data, size_t len)
+    {
+        if (!isAttached(address) || reg >= MCP23017_REGISTER_COUNT)
+        {
+            return false;
+        }
+        Device &dev = *slot(address);
+        for (size_t i = 0; i < len; i++)
+        {
+            data[i] = readRegister(dev, reg);
+            reg = nextPointer(dev, reg);
+        }
+        return true;
+    }
+
+    bool probe(uint8_t address)
+    {
+        return isAttached(address);
+    }
+
+    // Recovery hooks: a simulated bus never hangs
+    void lock() {}
+    void unlock() {}
+    bool linesIdle(uint8_t, uint8_t) { return true; }
+    bool recover(uint8_t, uint8_t, uint32_t) { return true; }
+
+    SimulatedMCP23017Bus *simulator() { return this; }
+
+private:
+    struct Device
+    {
+        uint8_t regs[MCP23017_REGISTER_COUNT];
+        uint16_t external; // Levels driven from outside
+        uint16_t driven;   // Which pins are driven from outside
+    };
+
+    Device devices[MCP23017_MAX_DEVICES];
+    uint8_t presentMask;
+
+    Device *slot(uint8_t address)
+    {
+        if (address < MCP23017_BASE_ADDRESS || address >= MCP23017_BASE_ADDRESS + MCP23017_MAX_DEVICES)
+        {
+            return nullptr;
+        }
+        return &devices[address - MCP23017_BASE_ADDRESS];
+    }
+
+    const Device *slot(uint8_t address) const
+    {
+        return const_cast<SimulatedMCP23017Bus *>(this)->slot(address);
+    }
+
+    static void powerOnReset(Device &dev)
+    {
+        memset(dev.regs, 0, sizeof(dev.regs));
+        dev.regs[MCP23017_IODIRA] = 0xFF;
+        dev.regs[MCP23017_IODIRB] = 0xFF;
+        dev.external = 0;
+        dev.driven = 0;
+    }
+
+    static uint16_t pair(const Device &dev, uint8_t regA)
+    {
+        return ((uint16_t)dev.regs[regA + 1] << 8) | dev.regs[regA];
+    }
+
+    static void setPair(Device &dev, uint8_t regA, uint16_t value)
+    {
+        dev.regs[regA] = value & 0xFF;
+        dev.regs[regA + 1] = (value >> 8) & 0xFF;
+    }
+
+    static uint16_t pinLevels(const Device &dev)
+    {
+        uint16_t iodir = pair(dev, MCP23017_IODIRA);
+        uint16_t pullups = pair(dev, MCP23017_GPPUA);
+        uint16_t olat = pair(dev, MCP23017_OLATA);
+
+        uint16_t inputs = (dev.external & dev.driven) | (pullups & ~dev.driven);
+        return (inputs & iodir) | (olat & ~iodir);
+    }
+
+    static void latchInterrupts(Device &dev, uint16_t before)
+    {
+        uint16_t after = pinLevels(dev);
+        uint16_t enabled = pair(dev, MCP23017_GPINTENA) & pair(dev, MCP23017_IODIRA);
+        uint16_t intcon = pair(dev, MCP23017_INTCONA);
+        uint16_t defval = pair(dev, MCP23017_DEFVALA);
+
+        uint16_t fired = enabled & (((after ^ before) & ~intcon) | ((after ^ defval) & intcon));
+        uint16_t pending = pair(dev, MCP23017_INTFA);
+        if (fired & ~pending)
+        {
+            // INTCAP is only updated for the edge that raises the interrupt
+            setPair(dev, MCP23017_INTFA, pending | fired);
+            setPair(dev, MCP23017_INTCAPA, gpioValue(dev, after));
+        }
+    }
+
+    static uint16_t gpioValue(const Device &dev, uint16_t levels)
+    {
+        uint16_t iodir = pair(dev, MCP23017_IODIRA);
+        return levels ^ (pair(dev, MCP23017_IPOLA) & iodir);
+    }
+
+    static uint8_t nextPointer(const Device &dev, uint8_t reg)
+    {
+        if (dev.regs[MCP23017_IOCONA] & MCP23017_IOCON_SEQOP)
+        {
+            return reg; // Byte mode: pointer stays put
+        }
+        return (reg + 1) % MCP23017_REGISTER_COUNT;
+    }
+
+    static void writeRegister(Device &dev, uint8_t reg, uint8_t value)
+    {
+        uint16_t before = pinLevels(dev);
+
+        switch (reg)
+        {
+        case MCP23017_INTFA:
+        case MCP23017_INTFB:
+        case MCP23017_INTCAPA:
+        case MCP23017_INTCAPB:
+            return; // Read-only
+        case MCP23017_IOCONA:
+        case MCP23017_IOCONB:
+            dev.regs[MCP23017_IOCONA] = dev.regs[MCP23017_IOCONB] = value & 0x7E; // BANK not modelled
+            return;
+        case MCP23017_GPIOA:
+        case MCP23017_GPIOB:
+            dev.regs[reg + 2] = value; // Writes to GPIO land in OLAT
+            break;
+        default:
+            dev.regs[reg] = value;
+            break;
+        }
+
+        latchInterrupts(dev, before);
+    }
+
+    static uint8_t peekRegister(const Device &dev, uint8_t reg)
+    {
+        if (reg == MCP23017_GPIOA || reg == MCP23017_GPIOB)
+        {
+            uint16_t gpio = gpioValue(dev, pinLevels(dev));
+            return reg == MCP23017_GPIOA ? (gpio & 0xFF) : (gpio >> 8);
+        }
+        return dev.regs[reg];
+    }
+
+    static uint8_t readRegister(Device &dev, uint8_t reg)
+    {
+        uint8_t value = peekRegister(dev, reg);
+
+        // Reading GPIO or INTCAP clears the pending interrupt for that port
+        if (reg == MCP23017_GPIOA || reg == MCP23017_INTCAPA)
+        {
+            clearInterrupt(dev, 0);
+        }
+        else if (reg == MCP23017_GPIOB || reg == MCP23017_INTCAPB)
+        {
+            clearInterrupt(dev, 1);
+        }
+        return value;
+    }
+
+    static void clearInterrupt(Device &dev, uint8_t port)
+    {
+        dev.regs[MCP23017_INTFA + port] = 0;
+    }
+};
+
+#ifndef MCP23017_SIMULATED_BUS
+// =========================================================================
+// SWITCHABLE BUS
+// =========================================================================
+
+// Firmware bus: the real Wire bus, or the simulator for demo mode (a virtual
+// tuner drives the simulated expander's pins). Chosen once, before the first
+// transaction. Simulated transactions take the same bus lock as real ones,
+// so the pin model can be stepped from one task while others poll.
+class SwitchableMCP23017Bus
+{
+public:
+    SwitchableMCP23017Bus() : simulated(false) {}
+
+    void setSimulated(bool on) { simulated = on; }
+    bool isSimulated() const { return simulated; }
+    SimulatedMCP23017Bus *simulator() { return simulated ? &sim : nullptr; }
+
+    void lock() { wire.lock(); }
+    void unlock() { wire.unlock(); }
+
+    bool writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, size_t len)
+    {
+        if (!simulated)
+        {
+            return wire.writeRegisters(address, reg, data, len);
+        }
+        MCP23017WireBus::Guard guard(wire);
+        return sim.writeRegisters(address, reg, data, len);
+    }
+
+    bool readRegisters(uint8_t address, uint8_t reg, uint8_t *data, size_t len)
+    {
+        if (!simulated)
+        {
+            return wire.readRegisters(address, reg, data, len);
+        }
+        MCP23017WireBus::Guard guard(wire);
+        return sim.readRegisters(address, reg, data, len);
+    }
+
+    bool probe(uint8_t address)
+    {
+        if (!simulated)
+        {
+            return wire.probe(address);
+        }
+        MCP23017WireBus::Guard guard(wire);
+        return sim.probe(address);
+    }
+
+    bool linesIdle(uint8_t sdaPin, uint8_t sclPin)
+    {
+        return simulated || wire.linesIdle(sdaPin, sclPin);
+    }
+
+    bool recover(uint8_t sdaPin, uint8_t sclPin, uint32_t clockHz)
+    {
+        return simulated || wire.recover(sdaPin, sclPin, clockHz);
+    }
+
+private:
+    MCP23017WireBus wire;
+    SimulatedMCP23017Bus sim;
+    bool simulated;
+};
+#endif // MCP23017_SIMULATED_BUS
+
+// =========================================================================
+// TRACING BUS
+// =========================================================================
+
+struct I2CBusStats
+{
+    uint32_t transactions;
+    uint32_t writes;
+    uint32_t reads;
+    uint32_t probes;
+    uint32_t bytesWritten; // Register pointer + payload
+    uint32_t bytesRead;
+    uint32_t errors;
+
+    I2CBusStats() : transactions(0), writes(0), reads(0), probes(0), bytesWritten(0), bytesRead(0), errors(0) {}
+};
+
+// Wraps any bus and counts what goes over the wire. Counters are plain
+// integers: they are statistics, and a lost increment under contention
+// is acceptable.
+template <typename Inner>
+class TracingBus
+{
+public:
+    TracingBus() {}
+
+    Inner &inner() { return bus; }
+    const I2CBusStats &stats() const { return counters; }
+    void resetStats() { counters = I2CBusStats(); }
+
+    bool writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, size_t len)
+    {
+        bool ok = bus.writeRegisters(address, reg, data, len);
+        counters.transactions++;
+        counters.writes++;
+        counters.bytesWritten += 1 + len;
+        if (!ok)
+            counters.errors++;
+        return ok;
+    }
+
+    bool readRegisters(uint8_t address, uint8_t reg, uint8_t *data, size_t len)
+    {
+        bool ok = bus.readRegisters(address, reg, data, len);
+        counters.transactions++;
+        counters.reads++;
+        counters.bytesWritten += 1;
+        if (ok)
+            counters.bytesRead += len;
+        else
+            counters.errors++;
+        return ok;
+    }
+
+    bool probe(uint8_t address)
+    {
+        bool ok = bus.probe(address);
+        counters.transactions++;
+        counters.probes++;
+        return ok;
+    }
+
+private:
+    Inner bus;
+    I2CBusStats counters;
+};
+
+#endif // MCP23017_BUS_H
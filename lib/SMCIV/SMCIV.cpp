@@ -1,5 +1,4 @@
 #include "SMCIV.h"
-#include <Preferences.h>
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <vector>
@@ -9,11 +8,6 @@
 #include <WiFi.h>
 #include "../../include/Config.h"
 
-// Preferences storage for antenna port selection
-static Preferences antennaPrefs;
-// Preferences storage for configuration (including RCS type)
-static Preferences configPrefs;
-
 SMCIV::SMCIV()
 {
     wsClient = nullptr;
@@ -26,11 +20,28 @@ void SMCIV::begin(WebSocketsClient *client, unsigned char *civAddrPtr)
 {
     wsClient = client;
     civAddressPtr = civAddrPtr;
-    // Load selectedAntennaPort from NVS (default to 0, which represents port 1)
-    antennaPrefs.begin("switch", true);
-    selectedAntennaPort = antennaPrefs.getInt("selectedIndex", 0); // default to 0 (zero-based, represents port 1)
-    antennaPrefs.end();
-    Serial.printf("[DEBUG] NVS initial load: selectedAntennaPort=%u (represents port %u)\n", selectedAntennaPort, selectedAntennaPort + 1);
+}
+
+void SMCIV::restoreSettings(uint8_t antennaPort, uint8_t type)
+{
+    // Saved state from the application's config store: no callbacks, no save back
+    rcsType = type <= 1 ? type : 0;
+    selectedAntennaPort = antennaPort <= ((rcsType == 0) ? 4 : 7) ? antennaPort : 0;
+    Serial.printf("[DEBUG] Restored selectedAntennaPort=%u (represents port %u), rcsType=%u\n",
+                  selectedAntennaPort, selectedAntennaPort + 1, rcsType);
+}
+
+void SMCIV::setSettingsStoreCallback(SettingsStoreCallback callback)
+{
+    settingsStoreCallback = callback;
+}
+
+void SMCIV::storeSettings()
+{
+    if (settingsStoreCallback)
+    {
+        settingsStoreCallback(selectedAntennaPort, rcsType);
+    }
 }
 
 void SMCIV::loop()
@@ -131,7 +142,7 @@ void SMCIV::sendCivResponse(uint8_t cmd, uint8_t subcmd, uint8_t fromAddr)
                 valid = true;
             if (valid)
             {
-                setSelectedAntennaPort(newPort - 1); // Store zero-based internally and save to NVS
+                setSelectedAntennaPort(newPort - 1); // Store zero-based internally and persist
                 Serial.printf("[CI-V] Antenna port set to: %u (saved to NVS)\n", newPort);
                 uint8_t response[] = {0xFE, 0xFE, fromAddr, civAddr, 0x31, newPort, 0xFD};
                 if (wsClient)
@@ -190,11 +201,7 @@ void SMCIV::setSelectedAntennaPort(uint8_t port)
 
     selectedAntennaPort = port;
     Serial.printf("[SMCIV] setSelectedAntennaPort updated, new value: %u\n", selectedAntennaPort);
-    Serial.printf("[DEBUG] Writing selectedIndex=%u to NVS...\n", selectedAntennaPort);
-    antennaPrefs.begin("switch", false);
-    antennaPrefs.putInt("selectedIndex", selectedAntennaPort);
-    antennaPrefs.end();
-    Serial.println("[DEBUG] NVS write complete.");
+    storeSettings();
 
     // Call GPIO callback to update physical outputs
     if (gpioCallback)
@@ -238,6 +245,12 @@ void SMCIV::setCivResponseCallback(CivResponseCallback callback)
     Serial.println("[SMCIV] CI-V response callback registered");
 }
 
+void SMCIV::setCivFrameCallback(CivFrameCallback callback)
+{
+    civFrameCallback = callback;
+    Serial.println("[SMCIV] CI-V frame callback registered");
+}
+
 void SMCIV::sendCivHexResponse(const uint8_t *response, size_t length)
 {
     String hexMsg = formatBytesToHex(response, length);
@@ -263,7 +276,11 @@ void SMCIV::setRcsType(uint8_t value)
         if (selectedAntennaPort > maxPort)
         {
             Serial.printf("[SMCIV] Current antenna port %u exceeds limit for RCS type %u, resetting to 0\n", selectedAntennaPort, rcsType);
-            setSelectedAntennaPort(0);
+            setSelectedAntennaPort(0); // Stores both
+        }
+        else
+        {
+            storeSettings();
         }
     }
     else
@@ -317,6 +334,12 @@ void SMCIV::handleIncomingWsMessage(const String &asciiHex)
     if (bytes.size() < 5)
         return;
 
+    // Let observers see the frame before address filtering drops it
+    if (civFrameCallback)
+    {
+        civFrameCallback(bytes.data(), bytes.size());
+    }
+
     Serial.print("[CI-V] Incoming command bytes: ");
     size_t lastCmd = bytes.size();
     if (lastCmd > 0 && bytes[lastCmd - 1] == 0xFD)
@@ -457,7 +480,7 @@ void SMCIV::handleIncomingWsMessage(const String &asciiHex)
                 valid = true;
             if (valid)
             {
-                setSelectedAntennaPort(newPort - 1); // store zero-based and save to NVS
+                setSelectedAntennaPort(newPort - 1); // store zero-based and persist
                 Serial.printf("[CI-V] Antenna port set to: %u (saved to NVS)\n", newPort);
                 uint8_t response[] = {0xFE, 0xFE, fromAddr, myAddr, 0x31, newPort, 0xFD};
                 if (wsClient)
@@ -545,6 +568,28 @@ void SMCIV::handleIncomingWsMessage(const String &asciiHex)
         return;
     }
 
+    // Handle button macro sequence commands (CMD 35): FE FE addr from 35 subcmd [data...] FD
+    if (cmd == 0x35 && bytes.size() >= 7 && bytes[bytes.size() - 1] == 0xFD && isMine)
+    {
+        const uint8_t *dataPtr = &bytes[6];
+        size_t dataLen = bytes.size() - 7;
+
+        // FD/FE inside the data would end/restart the frame on a real CI-V bus
+        for (size_t i = 0; i < dataLen; i++)
+        {
+            if (dataPtr[i] == 0xFD || dataPtr[i] == 0xFE)
+            {
+                uint8_t response[8] = {0xFE, 0xFE, fromAddr, myAddr, 0x35, subcmd, 0xFA, 0xFD};
+                DEBUG_PRINTF("[CI-V] Rejecting command 35 with a framing byte in its data\n");
+                sendCivHexResponse(response, sizeof(response));
+                return;
+            }
+        }
+
+        handleTunerCommand(cmd, subcmd, fromAddr, dataPtr, dataLen);
+        return;
+    }
+
     if (!(cmd == 0x19 && subcmd == 0x01))
     {
         uint8_t response[8] = {0xFE, 0xFE, fromAddr, myAddr, cmd, subcmd, myAddr, 0xFD};
@@ -591,9 +636,15 @@ void SMCIV::setTunerModelSetCallback(TunerModelSetCallback callback)
     tunerModelSetCallback = callback;
 }
 
+void SMCIV::setTunerSequenceCallback(TunerSequenceCallback callback)
+{
+    tunerSequenceCallback = callback;
+}
+
 void SMCIV::handleTunerCommand(uint8_t cmd, uint8_t subcmd, uint8_t fromAddr, const uint8_t *data, size_t dataLen)
 {
     uint8_t civAddr = civAddressPtr ? *civAddressPtr : 0xB8;
+    lastSenderAddress = fromAddr;
 
     Serial.printf("[CI-V TUNER] Command: 0x%02X, SubCmd: 0x%02X, From: 0x%02X\n", cmd, subcmd, fromAddr);
 
@@ -603,11 +654,10 @@ void SMCIV::handleTunerCommand(uint8_t cmd, uint8_t subcmd, uint8_t fromAddr, co
     {
         if (subcmd == 0x01) // Read Model
         {
-            String model = tunerModelCallback ? tunerModelCallback() : "991-994";
-            uint8_t modelData = (model.indexOf("998") >= 0) ? 0x01 : 0x00;
+            uint8_t modelData = tunerModelCallback ? tunerModelCallback() : 0x00;
 
             uint8_t response[7] = {0xFE, 0xFE, fromAddr, civAddr, 0x30, modelData, 0xFD};
-            Serial.printf("[CI-V TUNER] Model read response: %s (data: 0x%02X)\n", model.c_str(), modelData);
+            Serial.printf("[CI-V TUNER] Model read response (data: 0x%02X)\n", modelData);
 
             if (wsClient)
             {
@@ -620,19 +670,10 @@ void SMCIV::handleTunerCommand(uint8_t cmd, uint8_t subcmd, uint8_t fromAddr, co
             uint8_t modelCode = data[0];
             bool success = false;
 
-            // Validate model code first
-            if (modelCode == 0x00 || modelCode == 0x01)
-            {
-                if (tunerModelSetCallback)
-                {
-                    success = tunerModelSetCallback(modelCode);
-                }
-            }
-            else
+            // The application knows which model codes exist; unknown ones fail there
+            if (tunerModelSetCallback)
             {
-                // Invalid model code - force failure
-                success = false;
-                Serial.printf("[CI-V TUNER] Invalid model code: 0x%02X (valid: 0x00, 0x01)\n", modelCode);
+                success = tunerModelSetCallback(modelCode);
             }
 
             if (success)
@@ -723,8 +764,7 @@ void SMCIV::handleTunerCommand(uint8_t cmd, uint8_t subcmd, uint8_t fromAddr, co
 
             if (tunerButtonCallback)
             {
-                tunerButtonCallback(buttonCode);
-                success = true; // Assume success for button presses
+                success = tunerButtonCallback(buttonCode); // NAK if refused (interlock, unknown code)
             }
 
             // Send ACK/NAK with original command and button code
@@ -740,6 +780,25 @@ void SMCIV::handleTunerCommand(uint8_t cmd, uint8_t subcmd, uint8_t fromAddr, co
         break;
     }
 
+    case 0x35: // Button macro sequences
+    {
+        bool success = tunerSequenceCallback && tunerSequenceCallback(subcmd, data, dataLen);
+        Serial.printf("[CI-V TUNER] Sequence command (subcmd: 0x%02X, %u data bytes): %s\n",
+                      subcmd, (unsigned)dataLen, success ? "ACK" : "NAK");
+
+        if (success)
+        {
+            uint8_t response[6] = {0xFE, 0xFE, fromAddr, civAddr, 0xFB, 0xFD};
+            sendCivHexResponse(response, sizeof(response));
+        }
+        else
+        {
+            uint8_t response[8] = {0xFE, 0xFE, fromAddr, civAddr, 0x35, subcmd, 0xFA, 0xFD};
+            sendCivHexResponse(response, sizeof(response));
+        }
+        break;
+    }
+
     default:
     {
         // Unknown command - send NAK
@@ -14,12 +14,22 @@ public:
     typedef void (*GpioOutputCallback)(uint8_t antennaIndex);
     // Callback function type for CI-V response sending
     typedef void (*CivResponseCallback)(const String &hexResponse);
+    // Callback function type for observing every parsed frame, addressed to us or not
+    typedef void (*CivFrameCallback)(const uint8_t *frame, size_t length);
+    // Callback function type for persisting the switch settings (SMCIV keeps no storage of its own)
+    typedef void (*SettingsStoreCallback)(uint8_t antennaPort, uint8_t rcsType);
 
     SMCIV();
 
     // Initialize with WebSocket client pointer and CI-V address pointer
     void begin(WebSocketsClient *client, uint8_t *civAddrPtr);
 
+    // Restore saved antenna port and switch type (call after begin, before callbacks fire)
+    void restoreSettings(uint8_t antennaPort, uint8_t rcsType);
+
+    // Set callback that persists antenna port and switch type when either changes
+    void setSettingsStoreCallback(SettingsStoreCallback callback);
+
     // Main loop to be called regularly
     void loop();
 
@@ -54,37 +64,48 @@ public:
     // Set callback function for CI-V response sending
     void setCivResponseCallback(CivResponseCallback callback);
 
+    // Set callback function for snooping all incoming frames (e.g. radio frequency reports)
+    void setCivFrameCallback(CivFrameCallback callback);
+
     // =========================================================================
     // ANTENNA TUNER SPECIFIC COMMANDS
     // =========================================================================
 
     // Callback function types for antenna tuner integration
-    typedef void (*TunerButtonCallback)(uint8_t buttonCode);       // For CMD 34 button presses
+    typedef bool (*TunerButtonCallback)(uint8_t buttonCode);       // For CMD 34 button presses (false = NAK)
     typedef bool (*TunerIndicatorCallback)(uint8_t indicatorType); // For CMD 33 indicator reads
-    typedef String (*TunerModelCallback)();                        // For CMD 30 model reads
+    typedef uint8_t (*TunerModelCallback)();                       // For CMD 30 model reads (model code)
     typedef bool (*TunerModelSetCallback)(uint8_t modelCode);      // For CMD 30 model sets
+    typedef bool (*TunerSequenceCallback)(uint8_t subcmd, const uint8_t *data, size_t dataLen); // For CMD 35 button macros
 
     // Set callback functions for antenna tuner integration
     void setTunerButtonCallback(TunerButtonCallback callback);
     void setTunerIndicatorCallback(TunerIndicatorCallback callback);
     void setTunerModelCallback(TunerModelCallback callback);
     void setTunerModelSetCallback(TunerModelSetCallback callback);
+    void setTunerSequenceCallback(TunerSequenceCallback callback);
 
     // Handle antenna tuner specific CI-V commands
     void handleTunerCommand(uint8_t cmd, uint8_t subcmd, uint8_t fromAddr, const uint8_t *data, size_t dataLen);
 
+    // Sender of the tuner command currently being handled (valid inside tuner callbacks)
+    uint8_t getLastSenderAddress() const { return lastSenderAddress; }
+
 private:
     WebSocketsClient *wsClient = nullptr;
     uint8_t *civAddressPtr = nullptr;
     AntennaStateCallback antennaCallback = nullptr;
     GpioOutputCallback gpioCallback = nullptr;
     CivResponseCallback civResponseCallback = nullptr;
+    CivFrameCallback civFrameCallback = nullptr;
+    SettingsStoreCallback settingsStoreCallback = nullptr;
 
     // Antenna tuner callbacks
     TunerButtonCallback tunerButtonCallback = nullptr;
     TunerIndicatorCallback tunerIndicatorCallback = nullptr;
     TunerModelCallback tunerModelCallback = nullptr;
     TunerModelSetCallback tunerModelSetCallback = nullptr;
+    TunerSequenceCallback tunerSequenceCallback = nullptr;
 
     // Helper to format byte array to uppercase hex string
     static String formatBytesToHex(const uint8_t *data, size_t len);
@@ -95,9 +116,11 @@ private:
 private:
     uint8_t calculateChecksum(uint8_t *data, size_t length);
     void sendResponse(const uint8_t *response, size_t length);
+    void storeSettings();
 
     uint8_t selectedAntennaPort = 1; // zero-based index of selected antenna port (default 1)
     uint8_t rcsType = 0;             // Switch Model: 0 for RCS-8 (5 ports), 1 for RCS-10 (8 ports)
+    uint8_t lastSenderAddress = 0;
 };
 
 #endif // SMCIV_H
\ No newline at end of file
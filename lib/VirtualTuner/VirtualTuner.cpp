@@ -0,0 +1,266 @@
+#include "VirtualTuner.h"
+
+// Button index for the hold-repeat timers
+#define VT_CUP 0
+#define VT_CDN 1
+#define VT_LUP 2
+#define VT_LDN 3
+
+static uint8_t clampPosition(int32_t value)
+{
+    return value < 0 ? 0 : (value >= VTUNER_POSITIONS ? VTUNER_POSITIONS - 1 : (uint8_t)value);
+}
+
+static uint8_t distance(uint8_t a, uint8_t b)
+{
+    return a > b ? a - b : b - a;
+}
+
+VirtualTuner::VirtualTuner(SimulatedMCP23017Bus &simBus, uint8_t expanderAddress, const VirtualTunerPins &pinMap)
+    : bus(simBus), address(expanderAddress), pins(pinMap), posL(VTUNER_POSITIONS / 2), posC(VTUNER_POSITIONS / 2),
+      antenna(0), frequencyHz(VTUNER_DEFAULT_FREQ_HZ), indicatorsActiveLow(false), phase(IDLE), phaseEndMs(0), stuck(false), missMatch(false),
+      lastPressed(0), lastStepMs(0), dropUntilMs(0), dropped(false), rng(0x1234567), tunes(0), faultsInjected(0), presses(0)
+{
+    memset(nextRepeatMs, 0, sizeof(nextRepeatMs));
+    memset(faultPct, 0, sizeof(faultPct));
+}
+
+const char *VirtualTuner::faultName(uint8_t fault)
+{
+    switch (fault)
+    {
+    case VTUNER_FAULT_NO_START:
+        return "no_start";
+    case VTUNER_FAULT_NO_MATCH:
+        return "no_match";
+    case VTUNER_FAULT_STUCK:
+        return "stuck";
+    case VTUNER_FAULT_CHATTER:
+        return "chatter";
+    default:
+        return "unknown";
+    }
+}
+
+// =========================================================================
+// MATCH MODEL
+// =========================================================================
+
+// Lower bands want more L and C; the 25 kHz wobble makes neighbouring
+// segments differ a little, the way a real antenna does
+uint8_t VirtualTuner::getMatchL() const
+{
+    uint32_t khz = frequencyHz / 1000;
+    khz = khz < 1800 ? 1800 : (khz > 54000 ? 54000 : khz);
+    return clampPosition(40 + (54000 - khz) * 200 / 52200 + (khz / 25) % 7 + antenna * 17);
+}
+
+uint8_t VirtualTuner::getMatchC() const
+{
+    uint32_t khz = frequencyHz / 1000;
+    khz = khz < 1800 ? 1800 : (khz > 54000 ? 54000 : khz);
+    return clampPosition(30 + (54000 - khz) * 150 / 52200 + ((khz / 25) % 5) * 2 + antenna * 23);
+}
+
+bool VirtualTuner::isMatched() const
+{
+    return distance(posL, getMatchL()) <= VTUNER_MATCH_WINDOW && distance(posC, getMatchC()) <= VTUNER_MATCH_WINDOW;
+}
+
+// =========================================================================
+// FAULT INJECTION
+// =========================================================================
+
+uint32_t VirtualTuner::random(uint32_t range)
+{
+    // xorshift32: repeatable runs from a fixed seed
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return range ? rng % range : 0;
+}
+
+bool VirtualTuner::roll(VirtualTunerFault fault)
+{
+    if (faultPct[fault] == 0 || random(100) >= faultPct[fault])
+    {
+        return false;
+    }
+    faultsInjected++;
+    return true;
+}
+
+void VirtualTuner::setFault(VirtualTunerFault fault, uint8_t percent)
+{
+    if (fault < VTUNER_FAULT_COUNT)
+    {
+        faultPct[fault] = percent > 100 ? 100 : percent;
+    }
+}
+
+void VirtualTuner::dropExpander(uint32_t durationMs)
+{
+    bus.detach(address);
+    dropped = true;
+    dropUntilMs = lastStepMs + durationMs;
+    faultsInjected++;
+}
+
+void VirtualTuner::resetExpander()
+{
+    bus.reset(address);
+    faultsInjected++;
+}
+
+// =========================================================================
+// SIMULATION STEP
+// =========================================================================
+
+void VirtualTuner::step(uint32_t nowMs)
+{
+    lastStepMs = nowMs;
+
+    if (dropped)
+    {
+        if ((int32_t)(nowMs - dropUntilMs) < 0)
+        {
+            return;
+        }
+        dropped = false;
+        bus.attach(address); // Comes back with power-on defaults
+        lastPressed = 0;
+    }
+
+    // Buttons: output pins (IODIR bit clear) driven low
+    uint16_t iodir = ((uint16_t)bus.registerValue(address, MCP23017_IODIRB) << 8) | bus.registerValue(address, MCP23017_IODIRA);
+    uint16_t pressed = ~bus.pinLevels(address) & ~iodir;
+    uint16_t edges = pressed & ~lastPressed;
+    lastPressed = pressed;
+
+    const uint8_t buttonPins[] = {pins.cup, pins.cdn, pins.lup, pins.ldn, pins.tune, pins.ant};
+    for (uint8_t i = 0; i < sizeof(buttonPins); i++)
+    {
+        if (edges & (1 << buttonPins[i]))
+        {
+            onPress(buttonPins[i], nowMs);
+        }
+    }
+
+    // Held C/L keep stepping (ignored while the tuner is busy)
+    for (uint8_t i = VT_CUP; i <= VT_LDN; i++)
+    {
+        if ((pressed & (1 << buttonPins[i])) && !(edges & (1 << buttonPins[i])) && phase == IDLE &&
+            (int32_t)(nowMs - nextRepeatMs[i]) >= 0)
+        {
+            nudge(i);
+            nextRepeatMs[i] = nowMs + VTUNER_STEP_REPEAT_MS;
+        }
+    }
+
+    // Tune cycle
+    if (phase != IDLE && !(phase == HUNTING && stuck) && (int32_t)(nowMs - phaseEndMs) >= 0)
+    {
+        switch (phase)
+        {
+        case STARTING:
+            if (roll(VTUNER_FAULT_NO_START))
+            {
+                phase = IDLE;
+                break;
+            }
+            stuck = roll(VTUNER_FAULT_STUCK);
+            missMatch = roll(VTUNER_FAULT_NO_MATCH);
+            phase = HUNTING;
+            phaseEndMs = nowMs + VTUNER_HUNT_BASE_MS +
+                         (distance(posL, getMatchL()) + distance(posC, getMatchC())) * VTUNER_HUNT_STEP_MS +
+                         random(VTUNER_HUNT_JITTER_MS);
+            break;
+
+        case HUNTING:
+            if (missMatch)
+            {
+                // Gave up somewhere off the match point
+                posL = clampPosition(getMatchL() + VTUNER_MATCH_WINDOW + 2 + (int32_t)random(10));
+                posC = clampPosition(getMatchC() - VTUNER_MATCH_WINDOW - 2 - (int32_t)random(10));
+            }
+            else
+            {
+                posL = clampPosition(getMatchL() + (int32_t)random(3) - 1);
+                posC = clampPosition(getMatchC() + (int32_t)random(3) - 1);
+            }
+            phase = SETTLING;
+            phaseEndMs = nowMs + VTUNER_SWR_SETTLE_MS;
+            break;
+
+        default:
+            phase = IDLE;
+            break;
+        }
+    }
+
+    driveOutputs();
+}
+
+void VirtualTuner::onPress(uint8_t pin, uint32_t nowMs)
+{
+    presses++;
+
+    if (pin == pins.tune)
+    {
+        startTune(nowMs);
+        return;
+    }
+    if (pin == pins.ant)
+    {
+        antenna ^= 1;
+        return;
+    }
+    if (phase != IDLE)
+    {
+        return; // Front panel is locked while tuning
+    }
+
+    uint8_t index = pin == pins.cup ? VT_CUP : pin == pins.cdn ? VT_CDN : pin == pins.lup ? VT_LUP : VT_LDN;
+    nudge(index);
+    nextRepeatMs[index] = nowMs + VTUNER_STEP_REPEAT_MS;
+}
+
+void VirtualTuner::nudge(uint8_t index)
+{
+    switch (index)
+    {
+    case VT_CUP:
+        posC = clampPosition(posC + 1);
+        break;
+    case VT_CDN:
+        posC = clampPosition(posC - 1);
+        break;
+    case VT_LUP:
+        posL = clampPosition(posL + 1);
+        break;
+    default:
+        posL = clampPosition(posL - 1);
+        break;
+    }
+}
+
+void VirtualTuner::startTune(uint32_t nowMs)
+{
+    // A new TUNE also clears a stuck cycle
+    tunes++;
+    stuck = false;
+    phase = STARTING;
+    phaseEndMs = nowMs + VTUNER_START_DELAY_MS;
+}
+
+void VirtualTuner::driveOutputs()
+{
+    bool swr = (phase == IDLE || phase == STARTING) && isMatched();
+    if (roll(VTUNER_FAULT_CHATTER)) // Rolled per step, so the rate scales with the step rate
+    {
+        swr = !swr; // One-sample glitch; the next step restores the line
+    }
+
+    bus.driveInput(address, pins.tuning, (phase == HUNTING) != indicatorsActiveLow);
+    bus.driveInput(address, pins.swr, swr != indicatorsActiveLow);
+}
@@ -0,0 +1,134 @@
+#ifndef VIRTUAL_TUNER_H
+#define VIRTUAL_TUNER_H
+
+#include <stdint.h>
+#include "../MCP23017/MCP23017Bus.h"
+
+// =========================================================================
+// VIRTUAL TUNER
+// =========================================================================
+//
+// Stand-in for the tuner on a SimulatedMCP23017Bus expander: watches the
+// button outputs (active low) and drives TUNING and SWR the way the real
+// box does, active high unless the model's lines pull low
+// (setIndicatorsActiveLow). No Arduino dependency, so it runs in host-native
+// builds (MCP23017_SIMULATED_BUS, see test/test_virtual_tuner) as well as
+// in the firmware's demo mode.
+//
+// Model:
+//   - L and C are step positions (0..VTUNER_POSITIONS-1). A press moves one
+//     step, holding keeps stepping every VTUNER_STEP_REPEAT_MS.
+//   - Each antenna/frequency has a match point; SWR is good while both L
+//     and C are within the match window of it.
+//   - TUNE: TUNING rises after VTUNER_START_DELAY_MS, the tuner hunts for a
+//     time proportional to the distance to the match point (plus jitter),
+//     lands on it, TUNING falls, SWR is valid VTUNER_SWR_SETTLE_MS later.
+//   - ANT toggles the antenna on every press.
+//
+// Faults are injected per tune cycle with a probability, or one-shot at the
+// expander level (drop off the bus, power-on reset).
+//
+// step() must be called regularly (every few ms) with a monotonic clock,
+// holding whatever lock serializes access to the simulated bus.
+
+#define VTUNER_POSITIONS 256
+#define VTUNER_MATCH_WINDOW 3       // +/- steps around the match point
+#define VTUNER_STEP_REPEAT_MS 100   // Held C/L button
+#define VTUNER_START_DELAY_MS 150   // TUNE pulse to TUNING rising
+#define VTUNER_HUNT_BASE_MS 400     // Fixed part of a tune cycle
+#define VTUNER_HUNT_STEP_MS 6       // Per L+C step to the match point
+#define VTUNER_HUNT_JITTER_MS 300
+#define VTUNER_SWR_SETTLE_MS 80     // TUNING falling to SWR valid
+#define VTUNER_DEFAULT_FREQ_HZ 14200000
+
+struct VirtualTunerPins
+{
+    uint8_t tuning, swr;                   // Inputs to the controller
+    uint8_t cup, cdn, lup, ldn, tune, ant; // Controller outputs (active low)
+};
+
+enum VirtualTunerFault : uint8_t
+{
+    VTUNER_FAULT_NO_START = 0, // TUNING never rises
+    VTUNER_FAULT_NO_MATCH,     // Cycle ends off the match point (high SWR)
+    VTUNER_FAULT_STUCK,        // TUNING stays up until the next TUNE
+    VTUNER_FAULT_CHATTER,      // SWR line glitches for single steps (percent per step)
+    VTUNER_FAULT_COUNT
+};
+
+class VirtualTuner
+{
+public:
+    VirtualTuner(SimulatedMCP23017Bus &bus, uint8_t address, const VirtualTunerPins &pins);
+
+    void step(uint32_t nowMs);
+
+    // Radio frequency picks the match point (0 = VTUNER_DEFAULT_FREQ_HZ)
+    void setFrequency(uint32_t freqHz) { frequencyHz = freqHz ? freqHz : VTUNER_DEFAULT_FREQ_HZ; }
+
+    // Indicator polarity of the emulated model; lines follow on the next step()
+    void setIndicatorsActiveLow(bool activeLow) { indicatorsActiveLow = activeLow; }
+
+    // Fault injection
+    void setFault(VirtualTunerFault fault, uint8_t percent);
+    uint8_t getFault(VirtualTunerFault fault) const { return fault < VTUNER_FAULT_COUNT ? faultPct[fault] : 0; }
+    void dropExpander(uint32_t durationMs); // Gone from the bus, comes back power-on reset
+    void resetExpander();                   // Power-on reset in place (IODIR all inputs)
+    void seed(uint32_t value) { rng = value ? value : 1; }
+
+    // State
+    uint8_t getL() const { return posL; }
+    uint8_t getC() const { return posC; }
+    uint8_t getAntenna() const { return antenna; } // 0 = ANT 1
+    uint8_t getMatchL() const;
+    uint8_t getMatchC() const;
+    bool isTuning() const { return phase == HUNTING; }
+    bool isMatched() const;
+    uint32_t getTuneCount() const { return tunes; }
+    uint32_t getFaultCount() const { return faultsInjected; }
+    uint32_t getPressCount() const { return presses; }
+    static const char *faultName(uint8_t fault);
+
+private:
+    enum Phase : uint8_t
+    {
+        IDLE,
+        STARTING, // TUNE seen, TUNING not up yet
+        HUNTING,
+        SETTLING  // TUNING down, SWR not valid yet
+    };
+
+    SimulatedMCP23017Bus &bus;
+    uint8_t address;
+    VirtualTunerPins pins;
+
+    uint8_t posL, posC, antenna;
+    uint32_t frequencyHz;
+    bool indicatorsActiveLow;
+
+    Phase phase;
+    uint32_t phaseEndMs;
+    bool stuck;
+    bool missMatch;
+
+    uint16_t lastPressed;          // Button pins seen low last step
+    uint32_t nextRepeatMs[4];      // CUP, CDN, LUP, LDN hold repeat
+    uint32_t lastStepMs;
+    uint32_t dropUntilMs;
+    bool dropped;
+
+    uint8_t faultPct[VTUNER_FAULT_COUNT];
+    uint32_t rng;
+    uint32_t tunes;
+    uint32_t faultsInjected;
+    uint32_t presses;
+
+    uint32_t random(uint32_t range);
+    bool roll(VirtualTunerFault fault);
+    void onPress(uint8_t pin, uint32_t nowMs);
+    void nudge(uint8_t index);
+    void startTune(uint32_t nowMs);
+    void driveOutputs();
+};
+
+#endif // VIRTUAL_TUNER_H
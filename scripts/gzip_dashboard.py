@@ -0,0 +1,57 @@
+"""
+Pre-build script: gzip the dashboard into the filesystem image.
+
+web/index.html is compressed to data/index.html.gz (the firmware streams it
+as is with Content-Encoding: gzip) and its content hash is written to
+data/index.html.etag for If-None-Match revalidation. The output is
+deterministic (no timestamp in the gzip header) and only rewritten when it
+changes, so an unchanged page doesn't rebuild the LittleFS image.
+"""
+
+import gzip
+import hashlib
+import io
+import os
+
+Import("env")  # noqa: F821 (provided by PlatformIO)
+
+SOURCE = os.path.join("web", "index.html")
+TARGET = os.path.join("data", "index.html.gz")
+ETAG = os.path.join("data", "index.html.etag")
+
+
+def write_if_changed(path, content):
+    if os.path.exists(path):
+        with open(path, "rb") as f:
+            if f.read() == content:
+                return False
+    with open(path, "wb") as f:
+        f.write(content)
+    return True
+
+
+def build_dashboard(project_dir):
+    source = os.path.join(project_dir, SOURCE)
+    if not os.path.exists(source):
+        print("[gzip_dashboard] %s not found, skipping" % SOURCE)
+        return
+
+    with open(source, "rb") as f:
+        html = f.read()
+
+    buffer = io.BytesIO()
+    with gzip.GzipFile(filename="", mode="wb", fileobj=buffer, compresslevel=9, mtime=0) as gz:
+        gz.write(html)
+    compressed = buffer.getvalue()
+
+    etag = '"%s"\n' % hashlib.sha1(compressed).hexdigest()[:16]
+
+    os.makedirs(os.path.join(project_dir, "data"), exist_ok=True)
+    changed = write_if_changed(os.path.join(project_dir, TARGET), compressed)
+    write_if_changed(os.path.join(project_dir, ETAG), etag.encode("ascii"))
+
+    print("[gzip_dashboard] %s: %d -> %d bytes%s" %
+          (SOURCE, len(html), len(compressed), "" if changed else " (unchanged)"))
+
+
+build_dashboard(env.subst("$PROJECT_DIR"))  # noqa: F821
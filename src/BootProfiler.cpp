@@ -0,0 +1,106 @@
+#include "BootProfiler.h"
+
+BootProfiler::BootProfiler() : count(0), openStage(-1), completeUs(0)
+{
+}
+
+void BootProfiler::begin(const char *name)
+{
+    end();
+    if (count >= BOOT_PROFILER_MAX_STAGES)
+    {
+        return;
+    }
+
+    BootStage &stage = stages[count];
+    stage.name = name;
+    stage.startUs = micros();
+    stage.durationUs = 0;
+    stage.ok = true;
+    openStage = count++;
+}
+
+void BootProfiler::end(bool ok)
+{
+    if (openStage < 0)
+    {
+        return;
+    }
+
+    BootStage &stage = stages[openStage];
+    stage.durationUs = micros() - stage.startUs;
+    stage.ok = ok;
+    openStage = -1;
+
+    DEBUG_PRINTF("[BOOT] %s: %lu.%03lu ms%s\n", stage.name, (unsigned long)(stage.durationUs / 1000),
+                 (unsigned long)(stage.durationUs % 1000), ok ? "" : " (FAILED)");
+}
+
+void BootProfiler::mark(const char *name)
+{
+    end();
+    if (count >= BOOT_PROFILER_MAX_STAGES)
+    {
+        return;
+    }
+
+    BootStage &stage = stages[count++];
+    stage.name = name;
+    stage.startUs = micros();
+    stage.durationUs = 0;
+    stage.ok = true;
+
+    DEBUG_PRINTF("[BOOT] %s at %lu ms\n", name, (unsigned long)(stage.startUs / 1000));
+}
+
+void BootProfiler::finish()
+{
+    end();
+    completeUs = micros();
+}
+
+uint32_t BootProfiler::msSinceBoot(const char *name) const
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (strcmp(stages[i].name, name) == 0 && (int8_t)i != openStage)
+        {
+            return (stages[i].startUs + stages[i].durationUs) / 1000;
+        }
+    }
+    return 0;
+}
+
+String BootProfiler::getJson()
+{
+    String json = "{";
+    json += "\"complete\":" + String(isComplete() ? "true" : "false") + ",";
+    json += "\"total_ms\":" + String(getTotalMs()) + ",";
+    json += "\"stages\":[";
+    for (uint8_t i = 0; i < count; i++)
+    {
+        const BootStage &stage = stages[i];
+        json += i ? "," : "";
+        json += "{\"name\":\"" + String(stage.name) + "\",";
+        json += "\"start_us\":" + String(stage.startUs) + ",";
+        json += "\"duration_us\":" + String((int8_t)i == openStage ? micros() - stage.startUs : stage.durationUs) + ",";
+        json += "\"ok\":" + String(stage.ok ? "true" : "false");
+        json += (int8_t)i == openStage ? ",\"running\":true}" : "}";
+    }
+    json += "]}";
+    return json;
+}
+
+void BootProfiler::print()
+{
+    DEBUG_PRINTLN("============== BOOT PROFILE ==============");
+    for (uint8_t i = 0; i < count; i++)
+    {
+        const BootStage &stage = stages[i];
+        DEBUG_PRINTF("%-16s @%6lu ms  %6lu.%03lu ms  %s\n", stage.name, (unsigned long)(stage.startUs / 1000),
+                     (unsigned long)(stage.durationUs / 1000), (unsigned long)(stage.durationUs % 1000),
+                     stage.ok ? "OK" : "FAILED");
+    }
+    DEBUG_PRINTF("Boot complete after %lu ms\n", (unsigned long)getTotalMs());
+    DEBUG_PRINTLN("==========================================");
+}
@@ -1,17 +1,32 @@
 #include "ButtonManager.h"
 #include "ConfigManager.h"
+#include "OutputLock.h"
 
-// Static button mapping table
+// Static button mapping table, indexed by ButtonId
 const ButtonMapping ButtonManager::buttonMappings[BUTTON_COUNT] = {
-    {BUTTON_CUP_PIN, "button-cup", "Capacitor Up", BTN_IDX_CUP},
-    {BUTTON_CDN_PIN, "button-cdn", "Capacitor Down", BTN_IDX_CDN},
-    {BUTTON_LUP_PIN, "button-lup", "Inductor Up", BTN_IDX_LUP},
-    {BUTTON_LDN_PIN, "button-ldn", "Inductor Down", BTN_IDX_LDN},
-    {BUTTON_TUNE_PIN, "button-tune", "Tune", BTN_IDX_TUNE},
-    {BUTTON_ANT_PIN, "button-ant", "Antenna", BTN_IDX_ANT}};
+    {BUTTON_CUP_PIN, BTN_CUP, "Capacitor Up"},
+    {BUTTON_CDN_PIN, BTN_CDN, "Capacitor Down"},
+    {BUTTON_LUP_PIN, BTN_LUP, "Inductor Up"},
+    {BUTTON_LDN_PIN, BTN_LDN, "Inductor Down"},
+    {BUTTON_TUNE_PIN, BTN_TUNE, "Tune"},
+    {BUTTON_ANT_PIN, BTN_ANT, "Antenna"}};
+
+#define BTN_BIT(id) (1u << (id))
+
+// Interlock table, indexed by ButtonId. Opposite directions never overlap,
+// and TUNE never overlaps a manual C/L step.
+const InterlockRule ButtonManager::interlockTable[BUTTON_COUNT] = {
+    {BTN_CUP, BTN_BIT(BTN_CDN) | BTN_BIT(BTN_TUNE), true},
+    {BTN_CDN, BTN_BIT(BTN_CUP) | BTN_BIT(BTN_TUNE), true},
+    {BTN_LUP, BTN_BIT(BTN_LDN) | BTN_BIT(BTN_TUNE), true},
+    {BTN_LDN, BTN_BIT(BTN_LUP) | BTN_BIT(BTN_TUNE), true},
+    {BTN_TUNE, BTN_BIT(BTN_CUP) | BTN_BIT(BTN_CDN) | BTN_BIT(BTN_LUP) | BTN_BIT(BTN_LDN), true},
+    {BTN_ANT, 0, false}};
 
 ButtonManager::ButtonManager(MCP23017 *mcpInstance, ConfigManager *configManager)
-    : mcp(mcpInstance), config(configManager)
+    : mcp(mcpInstance), config(configManager), outputMutex(nullptr), releaseQueue(nullptr), outputShadow(0), outputMask(0), outputsDirty(false), outputsOnline(true), outputsConfigured(false), outputFlushes(0), outputsCoalesced(0),
+      outputVerifyFailures(0), outputPinFaults(0), outputResyncs(0), outputReadbackErrors(0),
+      interlockRejects(0), interlockPreempts(0), sequencer(this), repeater(this, configManager), pressCallback(nullptr), eventLog(nullptr)
 {
     // Initialize button states to HIGH (inactive)
     for (int i = 0; i < BUTTON_COUNT; i++)
@@ -30,6 +45,8 @@ ButtonManager::ButtonManager(MCP23017 *mcpInstance, ConfigManager *configManager
         {
             momentaryActions[i] = MomentaryAction(255); // Invalid pin
         }
+        timerContexts[i].owner = this;
+        timerContexts[i].index = i;
     }
 }
 
@@ -47,115 +64,475 @@ bool ButtonManager::begin()
         return false;
     }
 
+    if (!outputMutex)
+    {
+        outputMutex = xSemaphoreCreateRecursiveMutex();
+    }
+
+    if (!startPulseTimers())
+    {
+        DEBUG_PRINTLN("[WARNING] ButtonManager: pulse timers unavailable, pulses released from main loop");
+    }
+
+    if (!sequencer.begin())
+    {
+        DEBUG_PRINTLN("[WARNING] ButtonManager: sequencer unavailable");
+    }
+
+    if (!repeater.begin())
+    {
+        DEBUG_PRINTLN("[WARNING] ButtonManager: hold-to-repeat unavailable");
+    }
+
     setupOutputs();
 
     DEBUG_PRINTLN("[INFO] ButtonManager initialized");
     return true;
 }
 
-bool ButtonManager::setMCP(MCP23017 *mcpInstance)
+bool ButtonManager::startPulseTimers()
 {
-    if (!mcpInstance)
+    if (releaseQueue)
+    {
+        return true; // Already running
+    }
+
+    releaseQueue = xQueueCreate(PULSE_QUEUE_LENGTH, sizeof(PulseRelease));
+    if (!releaseQueue)
     {
-        DEBUG_PRINTLN("[ERROR] ButtonManager: Cannot set null MCP instance");
         return false;
     }
 
-    mcp = mcpInstance;
-    DEBUG_PRINTLN("[INFO] ButtonManager: MCP instance updated");
-    return true;
+    if (xTaskCreate(releaseTask, "btn-release", PULSE_TASK_STACK, this, PULSE_TASK_PRIORITY, nullptr) != pdPASS)
+    {
+        DEBUG_PRINTLN("[ERROR] Failed to start button release task");
+        return false;
+    }
+
+    bool allCreated = true;
+    for (int i = 0; i < BUTTON_COUNT; i++)
+    {
+        uint8_t momentaryIdx = buttonMappings[i].id;
+
+        esp_timer_create_args_t args = {};
+        args.callback = onPulseTimer;
+        args.arg = &timerContexts[momentaryIdx];
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = buttonIdToText(buttonMappings[i].id);
+
+        if (esp_timer_create(&args, &momentaryActions[momentaryIdx].timer) != ESP_OK)
+        {
+            DEBUG_PRINTF("[ERROR] Failed to create pulse timer for %s\n", buttonMappings[i].name);
+            momentaryActions[momentaryIdx].timer = nullptr;
+            allCreated = false;
+        }
+    }
+
+    return allCreated;
 }
 
-void ButtonManager::setupOutputs()
+// Runs in the esp_timer task: only hand the release to the high-priority task
+void ButtonManager::onPulseTimer(void *arg)
 {
-    if (!mcp)
+    PulseTimerContext *ctx = (PulseTimerContext *)arg;
+    PulseRelease release;
+    release.index = ctx->index;
+    release.generation = ctx->generation;
+    release.pressWidthMs = 0;
+    xQueueSendToFront(ctx->owner->releaseQueue, &release, 0);
+}
+
+// Any task, never blocks: presses queue behind pending releases
+bool ButtonManager::queuePulse(ButtonId buttonId, uint16_t durationMs, const EventSource &source)
+{
+    if (!releaseQueue || !isMappedButton(buttonId) || durationMs == 0)
     {
-        DEBUG_PRINTLN("[ERROR] setupOutputs: MCP23017 instance is null");
-        return;
+        return false;
     }
 
-    DEBUG_PRINTLN("[INFO] Setting up button outputs...");
+    PulseRelease press;
+    press.index = buttonId;
+    press.generation = 0;
+    press.pressWidthMs = durationMs;
+    press.source = source;
+    return xQueueSendToBack(releaseQueue, &press, 0) == pdTRUE;
+}
 
-    // Test MCP23017 communication first
-    DEBUG_PRINTF("[INFO] Testing MCP23017 communication at address 0x%02X...\n", MCP23017_ADDRESS);
+void ButtonManager::releaseTask(void *arg)
+{
+    ButtonManager *self = (ButtonManager *)arg;
+    PulseRelease release;
 
-    try
+    for (;;)
     {
-        // Test basic I/O configuration
-        mcp->pinMode(0, OUTPUT);
-        mcp->digitalWrite(0, HIGH);
-        bool testRead = mcp->digitalRead(0);
-        DEBUG_PRINTF("[INFO] MCP23017 test - Set pin 0 HIGH, read back: %s\n", testRead ? "HIGH" : "LOW");
+        if (xQueueReceive(self->releaseQueue, &release, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
 
-        mcp->digitalWrite(0, LOW);
-        testRead = mcp->digitalRead(0);
-        DEBUG_PRINTF("[INFO] MCP23017 test - Set pin 0 LOW, read back: %s\n", testRead ? "HIGH" : "LOW");
+        if (release.pressWidthMs)
+        {
+            self->pulseButton((ButtonId)release.index, release.pressWidthMs, release.source);
+        }
+        else
+        {
+            self->completePulse(release);
+        }
     }
-    catch (...)
+}
+
+void ButtonManager::completePulse(const PulseRelease &release)
+{
+    OutputLock lock(outputMutex);
+
+    MomentaryAction &action = momentaryActions[release.index];
+    if (!action.inProgress || action.generation != release.generation)
     {
-        DEBUG_PRINTLN("[ERROR] MCP23017 communication test failed - exception caught");
-        return;
+        return; // Released or re-pressed in the meantime
     }
 
-    // Configure all button pins as outputs
-    for (int i = 0; i < BUTTON_COUNT; i++)
+    writePin(action.mcpPin, HIGH); // Release
+    action.inProgress = false;
+    recordPulseWidth(action.requestedUs, esp_timer_get_time() - action.pressedAtUs);
+    logRelease(release.index);
+}
+
+void ButtonManager::cancelPulseTimer(uint8_t momentaryIdx)
+{
+    MomentaryAction &action = momentaryActions[momentaryIdx];
+    if (action.timer)
     {
-        uint8_t pin = buttonMappings[i].mcpPin;
-        try
+        esp_timer_stop(action.timer); // Fails harmlessly if not armed
+    }
+    loopReleases.cancel(momentaryIdx);
+    action.generation++;
+}
+
+void ButtonManager::recordPulseWidth(uint32_t requestedUs, int64_t actualUs)
+{
+    int32_t errorUs = (int32_t)(actualUs - (int64_t)requestedUs);
+
+    if (pulseJitter.lateness.count() == 0 || errorUs < pulseJitter.minErrorUs)
+        pulseJitter.minErrorUs = errorUs;
+    if (pulseJitter.lateness.count() == 0 || errorUs > pulseJitter.maxErrorUs)
+        pulseJitter.maxErrorUs = errorUs;
+
+    pulseJitter.lateness.record(errorUs > 0 ? (uint32_t)errorUs : 0);
+}
+
+void ButtonManager::logEvent(EventKind kind, ButtonId buttonId, const EventSource &source, uint32_t value)
+{
+    if (eventLog)
+    {
+        eventLog->record(kind, buttonId, source, value);
+    }
+}
+
+void ButtonManager::logRelease(uint8_t momentaryIdx)
+{
+    const MomentaryAction &action = momentaryActions[momentaryIdx];
+    logEvent(EVT_RELEASE, (ButtonId)momentaryIdx, action.source,
+             (uint32_t)((esp_timer_get_time() - action.pressedAtUs) / 1000));
+}
+
+// =========================================================================
+// INTERLOCKS
+// =========================================================================
+
+// Higher wins a conflict; equal priority means first come, first served
+uint8_t ButtonManager::sourcePriority(uint8_t sourceType)
+{
+    switch (sourceType)
+    {
+    case SRC_DASHBOARD: // Operator at the controls
+    case SRC_CIV:
+        return 4;
+    case SRC_HTTP:
+    case SRC_REPEAT:
+        return 3;
+    case SRC_SEQUENCE:
+        return 2;
+    case SRC_TUNE_MEMORY:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+InterlockResult ButtonManager::arbitrate(ButtonId buttonId, const EventSource &source)
+{
+    const InterlockRule &rule = interlockTable[buttonId];
+    InterlockResult result = INTERLOCK_OK;
+
+    // A step train owns C/L/TUNE until it finishes; only the train itself presses
+    if (rule.trainExclusive &&
+        ((sequencer.isRunning() && source.type != sequencer.getSourceType()) ||
+         (repeater.isRunning() && source.type != SRC_REPEAT)))
+    {
+        result = INTERLOCK_TRAIN_BUSY;
+    }
+
+    // Conflicting outputs: preempt lower-priority holders, otherwise refuse.
+    // Preempted releases are only staged so they go out in the same write
+    // as the new press.
+    uint8_t priority = sourcePriority(source.type);
+    for (uint8_t i = 0; i < BUTTON_COUNT && result == INTERLOCK_OK; i++)
+    {
+        if (!(rule.conflicts & BTN_BIT(i)) || !momentaryActions[i].inProgress)
         {
-            mcp->pinMode(pin, OUTPUT);
-            mcp->digitalWrite(pin, HIGH); // Inactive state for active-low logic
-            DEBUG_PRINTF("[DEBUG] Button %s (pin %d) configured as OUTPUT HIGH\n",
-                         buttonMappings[i].name, pin);
+            continue;
         }
-        catch (...)
+
+        if (priority <= sourcePriority(momentaryActions[i].source.type))
         {
-            DEBUG_PRINTF("[ERROR] Failed to configure button %s (pin %d)\n",
-                         buttonMappings[i].name, pin);
+            result = INTERLOCK_CONFLICT;
+            break;
         }
+
+        cancelPulseTimer(i);
+        stagePin(momentaryActions[i].mcpPin, HIGH);
+        momentaryActions[i].inProgress = false;
+        logRelease(i);
+        interlockPreempts++;
+        DEBUG_PRINTF("[INTERLOCK] %s preempted by %s\n", buttonIdToText((ButtonId)i), buttonIdToText(buttonId));
     }
 
-    // Configure AUTO button pin (not in buttonMappings array)
-    mcp->pinMode(BUTTON_AUTO_PIN, OUTPUT);
-    mcp->digitalWrite(BUTTON_AUTO_PIN, HIGH); // Inactive state for active-low logic
-    DEBUG_PRINTF("[DEBUG] Button AUTO (pin %d) configured as OUTPUT HIGH\n", BUTTON_AUTO_PIN);
+    if (result != INTERLOCK_OK)
+    {
+        interlockRejects++;
+        logEvent(EVT_REJECT, buttonId, source, result);
+        DEBUG_PRINTF("[INTERLOCK] %s from %s refused: %s\n", buttonIdToText(buttonId), EventLog::sourceName(source.type),
+                     result == INTERLOCK_TRAIN_BUSY ? "step train running" : "conflicting output active");
+    }
+    return result;
+}
 
-    // Set initial states based on saved configuration
-    setButtonOutput("button-ant");
-    setButtonOutput("button-auto");
+String ButtonManager::getInterlockJson()
+{
+    String json = "{";
+    json += "\"rejects\":" + String(interlockRejects) + ",";
+    json += "\"preempts\":" + String(interlockPreempts) + ",";
+    json += "\"rules\":[";
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+    {
+        if (i > 0)
+        {
+            json += ",";
+        }
+        json += "{\"button\":\"" + String(buttonIdToText(interlockTable[i].button)) + "\",\"conflicts\":[";
+        bool first = true;
+        for (uint8_t j = 0; j < BUTTON_COUNT; j++)
+        {
+            if (interlockTable[i].conflicts & BTN_BIT(j))
+            {
+                json += String(first ? "" : ",") + "\"" + buttonIdToText((ButtonId)j) + "\"";
+                first = false;
+            }
+        }
+        json += "],\"train_exclusive\":" + String(interlockTable[i].trainExclusive ? "true" : "false") + "}";
+    }
+    json += "]}";
+    return json;
+}
+
+void ButtonManager::stagePin(uint8_t pin, uint8_t level)
+{
+    OutputLock lock(outputMutex);
+    uint16_t bit = 1u << pin;
+
+    if (outputsDirty)
+    {
+        outputsCoalesced++;
+    }
+    outputMask |= bit;
+    outputShadow = level ? (outputShadow | bit) : (outputShadow & ~bit);
+    outputsDirty = true;
 }
 
-int ButtonManager::findButtonIndex(const String &buttonId)
+void ButtonManager::writePin(uint8_t pin, uint8_t level)
 {
-    // Handle alternative button IDs
-    String normalizedId = buttonId;
-    if (buttonId == "button-cup1")
-        normalizedId = "button-cup";
-    else if (buttonId == "button-lup1")
-        normalizedId = "button-lup";
-    else if (buttonId == "button-cup2")
-        normalizedId = "button-cdn";
-    else if (buttonId == "button-lup2")
-        normalizedId = "button-ldn";
+    OutputLock lock(outputMutex);
+    stagePin(pin, level);
+    flushOutputs(); // Anything else staged goes out in the same burst
+}
+
+void ButtonManager::flushOutputs()
+{
+    OutputLock lock(outputMutex);
+    if (!outputsDirty || !mcp || !outputsOnline)
+    {
+        return;
+    }
+    outputsDirty = false;
+
+    // Pins we don't own keep whatever the driver last wrote
+    uint16_t latch = mcp->getOutputLatch();
+    uint16_t value = (latch & ~outputMask) | (outputShadow & outputMask);
+    if (value != latch)
+    {
+        mcp->writeAllPins(value);
+        outputFlushes++;
+
+        // A latch that doesn't read back means the expander reset (OLAT
+        // back to 0, pins back to inputs): push the cached configuration
+        // again and check once more. A pin level that doesn't follow a
+        // correct latch is a stuck or shorted line, which re-initializing
+        // won't fix: it is only counted and logged.
+        uint16_t latchMismatch, pinMismatch;
+        if (verifyOutputs(value, latchMismatch, pinMismatch) && latchMismatch)
+        {
+            outputResyncs++;
+            mcp->begin();
+            if (verifyOutputs(value, latchMismatch, pinMismatch) && !latchMismatch)
+            {
+                DEBUG_PRINTLN("[OUTPUT] Expander resynced after latch mismatch");
+            }
+        }
+    }
+}
+
+void ButtonManager::setOutputsOnline(bool online)
+{
+    OutputLock lock(outputMutex);
+    if (online == outputsOnline)
+    {
+        return;
+    }
+    outputsOnline = online;
+
+    // The registry pushed the driver's latch on re-attach; anything staged
+    // since then is compared against it and written on the next flush. An
+    // expander missing since boot gets its latch and directions now.
+    if (online)
+    {
+        outputsDirty = true;
+        if (!outputsConfigured && mcp)
+        {
+            configureOutputs();
+        }
+    }
+    DEBUG_PRINTF("[OUTPUT] Primary expander %s\n", online ? "attached, flushing staged outputs" : "detached, staging outputs");
+}
+
+bool ButtonManager::verifyOutputs(uint16_t expected, uint16_t &latchMismatch, uint16_t &pinMismatch)
+{
+    latchMismatch = 0;
+    pinMismatch = 0;
+
+    uint16_t gpio, olat;
+    if (!mcp->readOutputState(gpio, olat))
+    {
+        outputReadbackErrors++;
+        return false; // Nothing to compare, and a bus error is not a reason to resync
+    }
+
+    // Only pins that are currently outputs drive their level onto GPIO
+    uint16_t driven = outputMask & ~mcp->getDirection();
+    latchMismatch = (olat ^ expected) & outputMask;
+    pinMismatch = (gpio ^ expected) & driven & ~latchMismatch;
+    uint16_t mismatch = latchMismatch | pinMismatch;
 
     for (int i = 0; i < BUTTON_COUNT; i++)
     {
-        if (normalizedId == buttonMappings[i].id)
+        lastButtonStates[i] = (gpio >> buttonMappings[i].mcpPin) & 1 ? HIGH : LOW;
+    }
+
+    if (mismatch == 0)
+    {
+        return true;
+    }
+
+    if (latchMismatch)
+    {
+        outputVerifyFailures++;
+    }
+    else
+    {
+        outputPinFaults++;
+    }
+
+    // Attribute the fault to the first affected button (AUTO has no ButtonId)
+    ButtonId subject = BTN_NONE;
+    for (int i = 0; i < BUTTON_COUNT && subject == BTN_NONE; i++)
+    {
+        if (mismatch & (1u << buttonMappings[i].mcpPin))
         {
-            return i;
+            subject = buttonMappings[i].id;
         }
     }
-    return -1;
+    logEvent(EVT_OUTPUT_FAULT, subject, EventSource(SRC_HARDWARE), mismatch);
+
+    DEBUG_PRINTF("[OUTPUT] %s mismatch: wrote 0x%04X, OLAT 0x%04X, GPIO 0x%04X\n",
+                 latchMismatch ? "Latch" : "Pin level", expected, olat, gpio);
+    return true;
+}
+
+bool ButtonManager::setMCP(MCP23017 *mcpInstance)
+{
+    if (!mcpInstance)
+    {
+        DEBUG_PRINTLN("[ERROR] ButtonManager: Cannot set null MCP instance");
+        return false;
+    }
+
+    mcp = mcpInstance;
+    DEBUG_PRINTLN("[INFO] ButtonManager: MCP instance updated");
+    return true;
+}
+
+void ButtonManager::setupOutputs()
+{
+    if (!mcp)
+    {
+        DEBUG_PRINTLN("[ERROR] setupOutputs: MCP23017 instance is null");
+        return;
+    }
+
+    DEBUG_PRINTLN("[INFO] Setting up button outputs...");
+
+    // Pin 0 is the TUNING input: nothing here may drive it. Whether the
+    // expander answers is the write-verify's job (first flush below).
+
+    // Stage every output's initial level (inactive, then the saved ANT/AUTO
+    // states); configureOutputs() writes the latch once, before the pins
+    // become outputs, so nothing glitches active on the way up
+    for (int i = 0; i < BUTTON_COUNT; i++)
+    {
+        stagePin(buttonMappings[i].mcpPin, HIGH); // Inactive state for active-low logic
+    }
+    stagePin(BUTTON_AUTO_PIN, HIGH);
+    setButtonOutput(BTN_ANT);
+    setButtonOutput(BTN_AUTO);
+    configureOutputs();
+}
+
+void ButtonManager::configureOutputs()
+{
+    OutputLock lock(outputMutex);
+    if (!outputsOnline)
+    {
+        // Neither the latch nor IODIR may reach an expander that comes
+        // back from reset with OLAT at 0; setOutputsOnline() finishes this
+        DEBUG_PRINTLN("[OUTPUT] Primary expander not attached, output setup deferred");
+        return;
+    }
+
+    flushOutputs();
+
+    // All button pins (the mapping table plus AUTO) in one IODIR write
+    mcp->pinModeMask(outputMask, OUTPUT);
+    outputsConfigured = true;
+    DEBUG_PRINTF("[DEBUG] Button outputs configured (mask 0x%04X)\n", outputMask);
 }
 
-bool ButtonManager::isValidButton(const String &buttonId)
+bool ButtonManager::isMappedButton(ButtonId buttonId)
 {
-    return findButtonIndex(buttonId) >= 0;
+    return buttonId < BUTTON_COUNT;
 }
 
-bool ButtonManager::setButtonOutput(const String &buttonId, bool state)
+bool ButtonManager::setButtonOutput(ButtonId buttonId, bool state, const EventSource &source)
 {
-    DEBUG_PRINTF("[DEBUG] setButtonOutput(%s, %s) called\n", buttonId.c_str(), state ? "true" : "false");
+    DEBUG_PRINTF("[DEBUG] setButtonOutput(%s, %s) called\n", buttonIdToText(buttonId), state ? "true" : "false");
 
     if (!mcp)
     {
@@ -164,15 +541,16 @@ bool ButtonManager::setButtonOutput(const String &buttonId, bool state)
     }
 
     // Handle special buttons (ANT/AUTO) that have custom logic
-    if (buttonId == "button-ant")
+    if (buttonId == BTN_ANT)
     {
         // For ANT button, update config state and set hardware directly
         config->setAntState(state);
+        logEvent(EVT_LATCH, BTN_ANT, source, state);
 
         if (isAntButtonMomentary())
         {
             // In momentary mode (Model 998), always inactive
-            mcp->digitalWrite(BUTTON_ANT_PIN, HIGH);
+            stagePin(BUTTON_ANT_PIN, HIGH);
             DEBUG_PRINTF("[DEBUG] ANT button (pin %d) set to inactive (HIGH) for momentary mode\n", BUTTON_ANT_PIN);
         }
         else
@@ -181,7 +559,7 @@ bool ButtonManager::setButtonOutput(const String &buttonId, bool state)
             // NOTE: Logic inverted - ANT 1 (false) should be ACTIVE (LOW), ANT 2 (true) should be INACTIVE (HIGH)
             try
             {
-                mcp->digitalWrite(BUTTON_ANT_PIN, state ? HIGH : LOW);
+                stagePin(BUTTON_ANT_PIN, state ? HIGH : LOW);
                 DEBUG_PRINTF("[DEBUG] ANT button (pin %d) set to %s for latching mode (state=%s)\n",
                              BUTTON_ANT_PIN, state ? "INACTIVE (HIGH)" : "ACTIVE (LOW)", state ? "true" : "false");
             }
@@ -193,36 +571,54 @@ bool ButtonManager::setButtonOutput(const String &buttonId, bool state)
         }
         return true;
     }
-    else if (buttonId == "button-auto")
+    else if (buttonId == BTN_AUTO)
     {
+        if (!hasAutoLatch())
+        {
+            // No AUTO/SEMI latch on this model: refuse, keep the line inactive
+            stagePin(BUTTON_AUTO_PIN, HIGH);
+            DEBUG_PRINTF("[DEBUG] AUTO ignored, model %s has no AUTO latch\n", config->getTunerModel().name);
+            return false;
+        }
+
         // For AUTO button, update config state and set hardware directly
         config->setAutoState(state);
-        mcp->digitalWrite(BUTTON_AUTO_PIN, state ? LOW : HIGH);
+        logEvent(EVT_LATCH, BTN_AUTO, source, state);
+        stagePin(BUTTON_AUTO_PIN, state ? LOW : HIGH);
         DEBUG_PRINTF("[DEBUG] AUTO button (pin %d) set to %s (state=%s)\n",
                      BUTTON_AUTO_PIN, state ? "ACTIVE (LOW)" : "INACTIVE (HIGH)", state ? "true" : "false");
         return true;
     }
 
     // Handle other buttons using the mapping table
-    int index = findButtonIndex(buttonId);
-    if (index < 0)
+    if (!isMappedButton(buttonId))
+    {
+        DEBUG_PRINTF("[ERROR] Invalid button ID: %u\n", buttonId);
+        return false;
+    }
+
+    uint8_t pin = buttonMappings[buttonId].mcpPin;
+    OutputLock lock(outputMutex);
+    if (state && arbitrate(buttonId, source) != INTERLOCK_OK)
     {
-        DEBUG_PRINTF("[ERROR] Invalid button ID: %s\n", buttonId.c_str());
         return false;
     }
 
-    uint8_t pin = buttonMappings[index].mcpPin;
-    mcp->digitalWrite(pin, state ? LOW : HIGH); // Active-low logic
+    writePin(pin, state ? LOW : HIGH); // Active-low logic
+    momentaryActions[buttonId].inProgress = state; // Held outputs take part in the interlock
+    momentaryActions[buttonId].source = source;
+    momentaryActions[buttonId].pressedAtUs = esp_timer_get_time();
+    logEvent(EVT_LATCH, buttonId, source, state);
 
     DEBUG_PRINTF("[DEBUG] Button %s set to %s\n",
-                 buttonMappings[index].name, state ? "ACTIVE" : "INACTIVE");
+                 buttonMappings[buttonId].name, state ? "ACTIVE" : "INACTIVE");
 
     return true;
 }
 
-bool ButtonManager::setButtonOutput(const String &buttonId)
+bool ButtonManager::setButtonOutput(ButtonId buttonId, const EventSource &source)
 {
-    DEBUG_PRINTF("[DEBUG] setButtonOutput called for: %s\n", buttonId.c_str());
+    DEBUG_PRINTF("[DEBUG] setButtonOutput called for: %s\n", buttonIdToText(buttonId));
 
     if (!mcp)
     {
@@ -236,12 +632,12 @@ bool ButtonManager::setButtonOutput(const String &buttonId)
         return false;
     }
 
-    if (buttonId == "button-ant")
+    if (buttonId == BTN_ANT)
     {
         if (isAntButtonMomentary())
         {
             // In momentary mode (Model 998), always inactive
-            mcp->digitalWrite(BUTTON_ANT_PIN, HIGH);
+            stagePin(BUTTON_ANT_PIN, HIGH);
             DEBUG_PRINTF("[DEBUG] ANT button (pin %d) set to inactive (HIGH) for momentary mode\n", BUTTON_ANT_PIN);
         }
         else
@@ -250,41 +646,56 @@ bool ButtonManager::setButtonOutput(const String &buttonId)
             // NOTE: Logic inverted - ANT 1 (false) should be ACTIVE (LOW), ANT 2 (true) should be INACTIVE (HIGH)
             bool antState = config->getAntState();
             DEBUG_PRINTF("[DEBUG] Retrieved ANT state from config: %s\n", antState ? "true (ANT 2)" : "false (ANT 1)");
-            mcp->digitalWrite(BUTTON_ANT_PIN, antState ? HIGH : LOW);
+            if (source.type != SRC_INTERNAL)
+            {
+                logEvent(EVT_LATCH, BTN_ANT, source, antState);
+            }
+            stagePin(BUTTON_ANT_PIN, antState ? HIGH : LOW);
             DEBUG_PRINTF("[DEBUG] ANT button (pin %d) set to %s for latching mode (state=%s)\n",
                          BUTTON_ANT_PIN, antState ? "INACTIVE (HIGH)" : "ACTIVE (LOW)", antState ? "true" : "false");
         }
         return true;
     }
-    else if (buttonId == "button-auto")
+    else if (buttonId == BTN_AUTO)
     {
+        if (!hasAutoLatch())
+        {
+            // No AUTO/SEMI latch on this model (e.g. after a model switch)
+            stagePin(BUTTON_AUTO_PIN, HIGH);
+            DEBUG_PRINTF("[DEBUG] AUTO button (pin %d) set to inactive (HIGH), no AUTO latch\n", BUTTON_AUTO_PIN);
+            return true;
+        }
+
         bool autoState = config->getAutoState();
-        mcp->digitalWrite(BUTTON_AUTO_PIN, autoState ? LOW : HIGH);
+        if (source.type != SRC_INTERNAL)
+        {
+            logEvent(EVT_LATCH, BTN_AUTO, source, autoState);
+        }
+        stagePin(BUTTON_AUTO_PIN, autoState ? LOW : HIGH);
         DEBUG_PRINTF("[DEBUG] AUTO button (pin %d) set to %s (state=%s)\n",
                      BUTTON_AUTO_PIN, autoState ? "ACTIVE (LOW)" : "INACTIVE (HIGH)", autoState ? "true" : "false");
         return true;
     }
 
-    DEBUG_PRINTF("[ERROR] setButtonOutput without state not supported for: %s\n", buttonId.c_str());
+    DEBUG_PRINTF("[ERROR] setButtonOutput without state not supported for: %s\n", buttonIdToText(buttonId));
     return false;
 }
 
-bool ButtonManager::pressButton(const String &buttonId)
+bool ButtonManager::pressButton(ButtonId buttonId, const EventSource &source)
 {
-    return setButtonOutput(buttonId, true);
+    return setButtonOutput(buttonId, true, source);
 }
 
-bool ButtonManager::releaseButton(const String &buttonId)
+bool ButtonManager::releaseButton(ButtonId buttonId, const EventSource &source)
 {
-    return setButtonOutput(buttonId, false);
+    return setButtonOutput(buttonId, false, source);
 }
 
-bool ButtonManager::pulseButton(const String &buttonId, unsigned long durationMs)
+bool ButtonManager::pulseButton(ButtonId buttonId, unsigned long durationMs, const EventSource &source)
 {
-    int index = findButtonIndex(buttonId);
-    if (index < 0)
+    if (!isMappedButton(buttonId))
     {
-        DEBUG_PRINTF("[ERROR] pulseButton: Invalid button ID: %s\n", buttonId.c_str());
+        DEBUG_PRINTF("[ERROR] pulseButton: Invalid button ID: %u\n", buttonId);
         return false;
     }
 
@@ -294,120 +705,155 @@ bool ButtonManager::pulseButton(const String &buttonId, unsigned long durationMs
         return false;
     }
 
-    uint8_t pin = buttonMappings[index].mcpPin;
-    uint8_t momentaryIdx = buttonMappings[index].momentaryIndex;
+    uint8_t pin = buttonMappings[buttonId].mcpPin;
+    uint8_t momentaryIdx = buttonId;
+    MomentaryAction &action = momentaryActions[momentaryIdx];
+
+    OutputLock lock(outputMutex);
+    if (arbitrate(buttonId, source) != INTERLOCK_OK)
+    {
+        return false;
+    }
+    cancelPulseTimer(momentaryIdx);
 
     // Start the pulse
-    mcp->digitalWrite(pin, LOW); // Press (active low)
-    momentaryActions[momentaryIdx].inProgress = true;
-    momentaryActions[momentaryIdx].expireMillis = millis() + durationMs;
+    writePin(pin, LOW); // Press (active low)
+    if (pressCallback)
+    {
+        pressCallback(buttonId, durationMs);
+    }
+    action.inProgress = true;
+    action.pressedAtUs = esp_timer_get_time();
+    action.requestedUs = durationMs * 1000;
+    action.source = source;
+    logEvent(EVT_PULSE, buttonId, source, durationMs);
+
+    // Release is timed by esp_timer, independent of how long loop() takes
+    timerContexts[momentaryIdx].generation = action.generation;
+    if (!action.timer || esp_timer_start_once(action.timer, action.requestedUs) != ESP_OK)
+    {
+        loopReleases.schedule(momentaryIdx, millis() + durationMs); // Fallback: processMomentaryActions()
+    }
 
     DEBUG_PRINTF("[DEBUG] Button pulse started for %s (pin %d) - %lums duration\n",
-                 buttonMappings[index].name, pin, durationMs);
+                 buttonMappings[buttonId].name, pin, durationMs);
 
     return true;
 }
 
-bool ButtonManager::startMomentaryAction(const String &buttonId)
+bool ButtonManager::startMomentaryAction(ButtonId buttonId, const EventSource &source)
 {
-    int index = findButtonIndex(buttonId);
-    if (index < 0)
+    if (!isMappedButton(buttonId))
     {
         return false;
     }
 
-    uint8_t pin = buttonMappings[index].mcpPin;
-    uint8_t momentaryIdx = buttonMappings[index].momentaryIndex;
+    uint8_t pin = buttonMappings[buttonId].mcpPin;
+    uint8_t momentaryIdx = buttonId;
+
+    OutputLock lock(outputMutex);
+    if (arbitrate(buttonId, source) != INTERLOCK_OK)
+    {
+        return false;
+    }
+    cancelPulseTimer(momentaryIdx); // A hold supersedes any running pulse
+    momentaryActions[momentaryIdx].pressedAtUs = esp_timer_get_time();
+    momentaryActions[momentaryIdx].source = source;
+    logEvent(EVT_PRESS, buttonId, source);
 
     // Special handling for ANT button in momentary mode
-    if (buttonId == "button-ant" && isAntButtonMomentary())
+    if (buttonId == BTN_ANT && isAntButtonMomentary())
     {
-        mcp->digitalWrite(pin, LOW);
-        momentaryActions[momentaryIdx].inProgress = true;
-        momentaryActions[momentaryIdx].expireMillis = 0; // No timeout
+        writePin(pin, LOW);
+        momentaryActions[momentaryIdx].inProgress = true; // No timeout
         DEBUG_PRINTLN("[DEBUG] ANT momentary action started (Model 998)");
         return true;
     }
 
     // Standard momentary action
-    mcp->digitalWrite(pin, LOW); // Press (active low)
-    momentaryActions[momentaryIdx].inProgress = true;
-    momentaryActions[momentaryIdx].expireMillis = 0; // No timeout - wait for release
+    writePin(pin, LOW); // Press (active low)
+    if (pressCallback)
+    {
+        pressCallback(buttonId, 0); // Length unknown until released
+    }
+    momentaryActions[momentaryIdx].inProgress = true; // No timeout - wait for release
 
     DEBUG_PRINTF("[DEBUG] Momentary action started for %s (pin %d)\n",
-                 buttonMappings[index].name, pin);
+                 buttonMappings[buttonId].name, pin);
 
     return true;
 }
 
-bool ButtonManager::stopMomentaryAction(const String &buttonId)
+bool ButtonManager::stopMomentaryAction(ButtonId buttonId, const EventSource &source)
 {
-    int index = findButtonIndex(buttonId);
-    if (index < 0)
+    if (!isMappedButton(buttonId))
     {
         return false;
     }
 
-    uint8_t pin = buttonMappings[index].mcpPin;
-    uint8_t momentaryIdx = buttonMappings[index].momentaryIndex;
+    uint8_t pin = buttonMappings[buttonId].mcpPin;
+    uint8_t momentaryIdx = buttonId;
+
+    OutputLock lock(outputMutex);
+    cancelPulseTimer(momentaryIdx);
 
-    mcp->digitalWrite(pin, HIGH); // Release (inactive high)
+    writePin(pin, HIGH); // Release (inactive high)
+    if (momentaryActions[momentaryIdx].inProgress)
+    {
+        momentaryActions[momentaryIdx].source = source;
+        logRelease(momentaryIdx);
+    }
     momentaryActions[momentaryIdx].inProgress = false;
-    momentaryActions[momentaryIdx].expireMillis = 0;
 
     DEBUG_PRINTF("[DEBUG] Momentary action stopped for %s (pin %d)\n",
-                 buttonMappings[index].name, pin);
+                 buttonMappings[buttonId].name, pin);
 
     return true;
 }
 
 void ButtonManager::processMomentaryActions()
 {
-    unsigned long now = millis();
+    if (loopReleases.empty())
+    {
+        return; // Common case: timed pulses are released by esp_timer
+    }
 
-    for (int i = 0; i < MOMENTARY_ACTION_COUNT; i++)
+    OutputLock lock(outputMutex);
+    uint32_t now = millis();
+    uint8_t i;
+
+    while (loopReleases.popExpired(now, i))
     {
-        // Only auto-release buttons with timeout set (expireMillis > 0)
-        if (momentaryActions[i].inProgress &&
-            momentaryActions[i].expireMillis > 0 &&
-            now >= momentaryActions[i].expireMillis)
+        if (!momentaryActions[i].inProgress)
         {
+            continue;
+        }
 
-            mcp->digitalWrite(momentaryActions[i].mcpPin, HIGH); // Release
-            momentaryActions[i].inProgress = false;
+        writePin(momentaryActions[i].mcpPin, HIGH); // Release
+        momentaryActions[i].inProgress = false;
+        recordPulseWidth(momentaryActions[i].requestedUs, esp_timer_get_time() - momentaryActions[i].pressedAtUs);
+        logRelease(i);
 
-            DEBUG_PRINTF("[DEBUG] Auto-releasing MCP pin %d\n", momentaryActions[i].mcpPin);
-        }
+        DEBUG_PRINTF("[DEBUG] Auto-releasing MCP pin %d\n", momentaryActions[i].mcpPin);
     }
 }
 
-void ButtonManager::scanButtonStates()
+uint32_t ButtonManager::msUntilNextRelease()
 {
-    for (int i = 0; i < BUTTON_COUNT; i++)
-    {
-        uint8_t pin = buttonMappings[i].mcpPin;
-        int currentState = mcp->digitalRead(pin);
-
-        if (currentState != lastButtonStates[i])
-        {
-            lastButtonStates[i] = currentState;
-            DEBUG_PRINTF("[DEBUG] Button state change: %s = %s\n",
-                         buttonMappings[i].name,
-                         currentState == HIGH ? "HIGH" : "LOW");
-        }
-    }
+    OutputLock lock(outputMutex);
+    return loopReleases.msUntilNext(millis());
 }
 
-bool ButtonManager::getButtonState(const String &buttonId)
+bool ButtonManager::getButtonState(ButtonId buttonId)
 {
-    int index = findButtonIndex(buttonId);
-    if (index < 0)
+    if (!isMappedButton(buttonId))
     {
         return false;
     }
 
-    uint8_t pin = buttonMappings[index].mcpPin;
-    return mcp->digitalRead(pin) == LOW; // Active-low logic
+    uint8_t pin = buttonMappings[buttonId].mcpPin;
+    OutputLock lock(outputMutex);
+    return !(outputShadow & (1u << pin)); // Active-low logic; flushes are verified on write
 }
 
 int ButtonManager::getLastButtonState(uint8_t index)
@@ -421,20 +867,62 @@ int ButtonManager::getLastButtonState(uint8_t index)
 
 bool ButtonManager::isAntButtonMomentary()
 {
-    return config->getCurrentCivModel().indexOf("998") >= 0;
+    return config->tunerHas(TUNER_CAP_ANT_MOMENTARY);
+}
+
+bool ButtonManager::hasAutoLatch()
+{
+    return config->tunerHas(TUNER_CAP_AUTO);
 }
 
 void ButtonManager::handleModelSwitch()
 {
     // Clear any in-progress ANT button momentary action
-    momentaryActions[BTN_IDX_ANT].inProgress = false;
-    momentaryActions[BTN_IDX_ANT].expireMillis = 0;
+    OutputLock lock(outputMutex);
+    cancelPulseTimer(BTN_ANT);
+    momentaryActions[BTN_ANT].inProgress = false;
 
     // Reset ANT button output based on new model
-    setButtonOutput("button-ant");
+    setButtonOutput(BTN_ANT);
 
     DEBUG_PRINTF("[DEBUG] Button states reset after model switch to %s\n",
-                 config->getCurrentCivModel().c_str());
+                 config->getCurrentCivModel());
+}
+
+String ButtonManager::getPulseJitterJson()
+{
+    PulseJitterStats snapshot;
+    uint32_t flushes, coalesced, verifyFailures, pinFaults, resyncs, readbackErrors;
+    {
+        OutputLock lock(outputMutex);
+        snapshot = pulseJitter;
+        flushes = outputFlushes;
+        coalesced = outputsCoalesced;
+        verifyFailures = outputVerifyFailures;
+        pinFaults = outputPinFaults;
+        resyncs = outputResyncs;
+        readbackErrors = outputReadbackErrors;
+    }
+
+    String json = "{";
+    json += "\"pulses\":" + String(snapshot.lateness.count()) + ",";
+    json += "\"min_error_us\":" + String(snapshot.minErrorUs) + ",";
+    json += "\"max_error_us\":" + String(snapshot.maxErrorUs) + ",";
+    json += "\"lateness\":" + snapshot.lateness.toJson() + ",";
+    json += "\"output_writes\":" + String(flushes) + ",";
+    json += "\"output_changes_coalesced\":" + String(coalesced) + ",";
+    json += "\"output_verify_failures\":" + String(verifyFailures) + ",";
+    json += "\"output_pin_faults\":" + String(pinFaults) + ",";
+    json += "\"output_resyncs\":" + String(resyncs) + ",";
+    json += "\"output_readback_errors\":" + String(readbackErrors);
+    json += "}";
+    return json;
+}
+
+void ButtonManager::resetPulseJitter()
+{
+    OutputLock lock(outputMutex);
+    pulseJitter = PulseJitterStats();
 }
 
 void ButtonManager::printButtonStates()
@@ -448,15 +936,14 @@ void ButtonManager::printButtonStates()
     DEBUG_PRINTLN("====================");
 }
 
-String ButtonManager::getButtonInfo(const String &buttonId)
+String ButtonManager::getButtonInfo(ButtonId buttonId)
 {
-    int index = findButtonIndex(buttonId);
-    if (index < 0)
+    if (!isMappedButton(buttonId))
     {
         return "Invalid button";
     }
 
-    const ButtonMapping &btn = buttonMappings[index];
+    const ButtonMapping &btn = buttonMappings[buttonId];
     bool state = getButtonState(buttonId);
 
     return String(btn.name) + " (Pin " + String(btn.mcpPin) + "): " +
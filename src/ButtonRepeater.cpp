@@ -0,0 +1,229 @@
+#include "ButtonRepeater.h"
+#include "ButtonManager.h"
+#include "ConfigManager.h"
+
+ButtonRepeater::ButtonRepeater(ButtonManager *buttonManager, ConfigManager *configManager)
+    : buttons(buttonManager), config(configManager), timer(nullptr), mutex(nullptr),
+      button(BTN_NONE), ownerId(0), pulseCount(0), intervalMs(0), nextPulseUs(0), lastKeepaliveUs(0),
+      trainsStarted(0), keepaliveTimeouts(0)
+{
+    memset(&curve, 0, sizeof(curve));
+}
+
+bool ButtonRepeater::begin()
+{
+    if (timer)
+    {
+        return true;
+    }
+
+    mutex = xSemaphoreCreateMutex();
+    if (!mutex)
+    {
+        return false;
+    }
+
+    esp_timer_create_args_t args = {};
+    args.callback = onTimer;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "btn-repeat";
+
+    if (esp_timer_create(&args, &timer) != ESP_OK)
+    {
+        DEBUG_PRINTLN("[ERROR] Failed to create repeat timer");
+        timer = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool ButtonRepeater::isRepeatable(ButtonId buttonId)
+{
+    return buttonId == BTN_CUP || buttonId == BTN_CDN || buttonId == BTN_LUP || buttonId == BTN_LDN;
+}
+
+// =========================================================================
+// TRAIN CONTROL
+// =========================================================================
+
+bool ButtonRepeater::start(ButtonId buttonId, uint32_t owner)
+{
+    if (!timer || !isRepeatable(buttonId))
+    {
+        return false;
+    }
+
+    // A running macro owns the buttons
+    if (buttons->getSequencer().isRunning())
+    {
+        DEBUG_PRINTLN("[REPEAT] Sequence running, not starting repeat");
+        return false;
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    ButtonId replaced = button;
+    uint32_t replacedPulses = replaced != BTN_NONE ? stopLocked() : 0;
+
+    curve = config->getRepeatCurve();
+    button = buttonId;
+    ownerId = owner;
+    pulseCount = 0;
+    intervalMs = 0;
+    nextPulseUs = esp_timer_get_time();
+    lastKeepaliveUs = nextPulseUs;
+    trainsStarted++;
+    xSemaphoreGive(mutex);
+
+    if (replaced != BTN_NONE)
+    {
+        DEBUG_PRINTF("[REPEAT] Stop %s after %lu pulses (replaced)\n", buttonIdToText(replaced), (unsigned long)replacedPulses);
+    }
+    DEBUG_PRINTF("[REPEAT] Start %s for client %lu\n", buttonIdToText(buttonId), (unsigned long)owner);
+
+    // First pulse immediately, from the timer task like the rest
+    esp_timer_start_once(timer, 0);
+    return true;
+}
+
+void ButtonRepeater::keepalive(ButtonId buttonId, uint32_t owner)
+{
+    if (!timer)
+    {
+        return;
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (button == buttonId && ownerId == owner)
+    {
+        lastKeepaliveUs = esp_timer_get_time();
+    }
+    xSemaphoreGive(mutex);
+}
+
+void ButtonRepeater::stop(ButtonId buttonId, uint32_t owner)
+{
+    stopMatching(buttonId, owner, false, false, "released");
+}
+
+void ButtonRepeater::stopOwner(uint32_t owner)
+{
+    stopMatching(BTN_NONE, owner, true, false, "client gone");
+}
+
+void ButtonRepeater::stopAll()
+{
+    stopMatching(BTN_NONE, 0, true, true, "stopped");
+}
+
+void ButtonRepeater::stopMatching(ButtonId buttonId, uint32_t owner, bool anyButton, bool anyOwner, const char *reason)
+{
+    if (!timer)
+    {
+        return;
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    ButtonId stopped = button;
+    bool matches = stopped != BTN_NONE && (anyButton || stopped == buttonId) && (anyOwner || ownerId == owner);
+    uint32_t pulses = matches ? stopLocked() : 0;
+    xSemaphoreGive(mutex);
+
+    if (matches)
+    {
+        DEBUG_PRINTF("[REPEAT] Stop %s after %lu pulses (%s)\n", buttonIdToText(stopped), (unsigned long)pulses, reason);
+    }
+}
+
+uint32_t ButtonRepeater::stopLocked()
+{
+    // A pulse already started finishes on its own release timer
+    esp_timer_stop(timer);
+    button = BTN_NONE;
+    return pulseCount;
+}
+
+void ButtonRepeater::onTimer(void *arg)
+{
+    ((ButtonRepeater *)arg)->advance();
+}
+
+// Runs in the esp_timer task: no bus access or printing here, the press
+// itself is handed to the button release task
+void ButtonRepeater::advance()
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+
+    if (button == BTN_NONE)
+    {
+        xSemaphoreGive(mutex);
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    if (now - lastKeepaliveUs > (int64_t)REPEAT_KEEPALIVE_TIMEOUT_MS * 1000)
+    {
+        keepaliveTimeouts++; // Reported in the status JSON
+        stopLocked();
+        xSemaphoreGive(mutex);
+        return;
+    }
+
+    if (buttons->queuePulse(button, curve.widthMs, EventSource(SRC_REPEAT, ownerId)))
+    {
+        pulseCount++;
+    }
+
+    // Hold-off after the first pulse, then accelerate down to minMs
+    if (pulseCount == 1)
+    {
+        intervalMs = curve.delayMs;
+    }
+    else if (pulseCount == 2)
+    {
+        intervalMs = curve.startMs;
+    }
+    else
+    {
+        intervalMs = intervalMs * (100 - curve.accelPercent) / 100;
+        if (intervalMs < curve.minMs)
+        {
+            intervalMs = curve.minMs;
+        }
+    }
+
+    // Absolute deadlines so callback latency doesn't stretch the train
+    nextPulseUs += (int64_t)intervalMs * 1000;
+    int64_t delayUs = nextPulseUs - now;
+    esp_timer_start_once(timer, delayUs > 0 ? delayUs : 0);
+
+    xSemaphoreGive(mutex);
+}
+
+// =========================================================================
+// STATUS
+// =========================================================================
+
+String ButtonRepeater::getStatusJson()
+{
+    if (!mutex)
+    {
+        return "{\"active\":false}";
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    ButtonId active = button;
+    uint32_t pulses = pulseCount;
+    uint32_t interval = intervalMs;
+    xSemaphoreGive(mutex);
+
+    String json = "{";
+    json += "\"active\":" + String(active != BTN_NONE ? "true" : "false") + ",";
+    json += "\"button\":\"" + String(active != BTN_NONE ? buttonIdToText(active) : "") + "\",";
+    json += "\"pulses\":" + String(pulses) + ",";
+    json += "\"interval_ms\":" + String(interval) + ",";
+    json += "\"trains\":" + String(trainsStarted) + ",";
+    json += "\"keepalive_timeouts\":" + String(keepaliveTimeouts);
+    json += "}";
+    return json;
+}
@@ -0,0 +1,444 @@
+#include "ButtonSequencer.h"
+#include "ButtonManager.h"
+#include <LittleFS.h>
+
+// On-flash format: "SQ", version, step count, then 5 bytes per step
+// (button, width LE16, gap LE16)
+#define SEQUENCE_FILE_MAGIC0 'S'
+#define SEQUENCE_FILE_MAGIC1 'Q'
+#define SEQUENCE_FILE_VERSION 1
+#define SEQUENCE_FILE_STEP_SIZE 5
+
+static const char *stateName(SequencerState state)
+{
+    switch (state)
+    {
+    case SEQ_RUNNING:
+        return "running";
+    case SEQ_DONE:
+        return "done";
+    case SEQ_STOPPED:
+        return "stopped";
+    default:
+        return "idle";
+    }
+}
+
+ButtonSequencer::ButtonSequencer(ButtonManager *buttonManager)
+    : buttons(buttonManager), timer(nullptr), mutex(nullptr), stepCount(0), nextStep(0),
+      state(SEQ_IDLE), nextStartUs(0), source(SRC_SEQUENCE), reportedState(SEQ_IDLE), reportedStep(0), progressCallback(nullptr)
+{
+    name[0] = '\0';
+}
+
+bool ButtonSequencer::begin()
+{
+    if (timer)
+    {
+        return true;
+    }
+
+    mutex = xSemaphoreCreateMutex();
+    if (!mutex)
+    {
+        return false;
+    }
+
+    esp_timer_create_args_t args = {};
+    args.callback = onTimer;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "btn-sequence";
+
+    if (esp_timer_create(&args, &timer) != ESP_OK)
+    {
+        DEBUG_PRINTLN("[ERROR] Failed to create sequencer timer");
+        timer = nullptr;
+        return false;
+    }
+    return true;
+}
+
+// =========================================================================
+// PLAYBACK
+// =========================================================================
+
+bool ButtonSequencer::run(const SequenceStep *newSteps, uint8_t count, const char *newName, const EventSource &newSource)
+{
+    if (!timer || count == 0 || count > SEQUENCE_MAX_STEPS)
+    {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (!isValidStep(newSteps[i]))
+        {
+            DEBUG_PRINTF("[SEQ] Rejecting sequence: invalid step %u\n", i);
+            return false;
+        }
+    }
+
+    // A hold-to-repeat train owns the C/L outputs until released
+    if (buttons->getRepeater().isRunning())
+    {
+        DEBUG_PRINTLN("[SEQ] Repeat train running, not starting sequence");
+        return false;
+    }
+
+    stop();
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    memcpy(steps, newSteps, count * sizeof(SequenceStep));
+    stepCount = count;
+    nextStep = 0;
+    strncpy(name, newName ? newName : "", SEQUENCE_NAME_MAX);
+    name[SEQUENCE_NAME_MAX] = '\0';
+    source = newSource;
+    nextStartUs = esp_timer_get_time();
+    state = SEQ_RUNNING;
+    xSemaphoreGive(mutex);
+
+    DEBUG_PRINTF("[SEQ] Running %s%s(%u steps)\n", name, name[0] ? " " : "", count);
+
+    // First step immediately, from the timer task like the rest
+    esp_timer_start_once(timer, 0);
+    return true;
+}
+
+bool ButtonSequencer::runNamed(const char *sequenceName)
+{
+    SequenceStep loaded[SEQUENCE_MAX_STEPS];
+    uint8_t count = 0;
+    if (!loadNamed(sequenceName, loaded, count))
+    {
+        return false;
+    }
+    return run(loaded, count, sequenceName);
+}
+
+void ButtonSequencer::stop()
+{
+    if (!timer)
+    {
+        return;
+    }
+
+    esp_timer_stop(timer);
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    bool wasRunning = (state == SEQ_RUNNING);
+    if (wasRunning)
+    {
+        state = SEQ_STOPPED;
+    }
+    uint8_t stoppedAt = nextStep;
+    xSemaphoreGive(mutex);
+
+    if (wasRunning)
+    {
+        DEBUG_PRINTF("[SEQ] Stopped at step %u/%u\n", stoppedAt, stepCount);
+    }
+}
+
+void ButtonSequencer::onTimer(void *arg)
+{
+    ((ButtonSequencer *)arg)->advance();
+}
+
+// Runs in the esp_timer task: no bus access or printing here, the press
+// itself is handed to the button release task
+void ButtonSequencer::advance()
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+
+    if (state != SEQ_RUNNING)
+    {
+        xSemaphoreGive(mutex);
+        return;
+    }
+
+    if (nextStep >= stepCount)
+    {
+        state = SEQ_DONE; // Last step's release and gap have elapsed
+        xSemaphoreGive(mutex);
+        return;
+    }
+
+    const SequenceStep &step = steps[nextStep++];
+    if (!buttons->queuePulse(step.button, step.widthMs, source))
+    {
+        state = SEQ_STOPPED; // Release task unavailable or backed up; update() reports it
+        xSemaphoreGive(mutex);
+        return;
+    }
+
+    // Deadlines are absolute so a late callback doesn't push later steps out
+    nextStartUs += (int64_t)(step.widthMs + step.gapMs) * 1000;
+    int64_t delayUs = nextStartUs - esp_timer_get_time();
+    esp_timer_start_once(timer, delayUs > 0 ? delayUs : 0);
+
+    xSemaphoreGive(mutex);
+}
+
+void ButtonSequencer::update()
+{
+    if (state == reportedState && nextStep == reportedStep)
+    {
+        return;
+    }
+
+    reportedState = state;
+    reportedStep = nextStep;
+
+    if (progressCallback)
+    {
+        progressCallback(getStatusJson());
+    }
+}
+
+String ButtonSequencer::getStatusJson()
+{
+    String json = "{";
+    json += "\"type\":\"sequence_progress\",";
+    json += "\"name\":\"" + String(name) + "\",";
+    json += "\"state\":\"" + String(stateName(state)) + "\",";
+    json += "\"step\":" + String(nextStep) + ",";
+    json += "\"total\":" + String(stepCount);
+    json += "}";
+    return json;
+}
+
+// =========================================================================
+// STORAGE
+// =========================================================================
+
+String ButtonSequencer::pathFor(const char *sequenceName)
+{
+    return String(SEQUENCE_DIR) + "/" + sequenceName + ".seq";
+}
+
+bool ButtonSequencer::save(const char *sequenceName, const SequenceStep *saveSteps, uint8_t count)
+{
+    if (!isValidName(sequenceName) || count == 0 || count > SEQUENCE_MAX_STEPS)
+    {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (!isValidStep(saveSteps[i]))
+        {
+            return false;
+        }
+    }
+
+    if (!LittleFS.exists(SEQUENCE_DIR))
+    {
+        LittleFS.mkdir(SEQUENCE_DIR);
+    }
+
+    File file = LittleFS.open(pathFor(sequenceName), "w");
+    if (!file)
+    {
+        DEBUG_PRINTF("[SEQ] Failed to open %s for writing\n", pathFor(sequenceName).c_str());
+        return false;
+    }
+
+    uint8_t header[4] = {SEQUENCE_FILE_MAGIC0, SEQUENCE_FILE_MAGIC1, SEQUENCE_FILE_VERSION, count};
+    bool ok = file.write(header, sizeof(header)) == sizeof(header);
+
+    for (uint8_t i = 0; ok && i < count; i++)
+    {
+        uint8_t record[SEQUENCE_FILE_STEP_SIZE] = {
+            saveSteps[i].button,
+            (uint8_t)(saveSteps[i].widthMs & 0xFF), (uint8_t)(saveSteps[i].widthMs >> 8),
+            (uint8_t)(saveSteps[i].gapMs & 0xFF), (uint8_t)(saveSteps[i].gapMs >> 8)};
+        ok = file.write(record, sizeof(record)) == sizeof(record);
+    }
+    file.close();
+
+    DEBUG_PRINTF("[SEQ] Saved %s (%u steps): %s\n", sequenceName, count, ok ? "OK" : "FAILED");
+    return ok;
+}
+
+bool ButtonSequencer::loadNamed(const char *sequenceName, SequenceStep *loadSteps, uint8_t &count)
+{
+    count = 0;
+    if (!isValidName(sequenceName))
+    {
+        return false;
+    }
+
+    File file = LittleFS.open(pathFor(sequenceName), "r");
+    if (!file)
+    {
+        DEBUG_PRINTF("[SEQ] Sequence not found: %s\n", sequenceName);
+        return false;
+    }
+
+    uint8_t header[4];
+    if (file.read(header, sizeof(header)) != sizeof(header) ||
+        header[0] != SEQUENCE_FILE_MAGIC0 || header[1] != SEQUENCE_FILE_MAGIC1 ||
+        header[2] != SEQUENCE_FILE_VERSION || header[3] == 0 || header[3] > SEQUENCE_MAX_STEPS)
+    {
+        DEBUG_PRINTF("[SEQ] Corrupt sequence file: %s\n", sequenceName);
+        file.close();
+        return false;
+    }
+
+    for (uint8_t i = 0; i < header[3]; i++)
+    {
+        uint8_t record[SEQUENCE_FILE_STEP_SIZE];
+        if (file.read(record, sizeof(record)) != sizeof(record))
+        {
+            file.close();
+            return false;
+        }
+        loadSteps[i].button = (ButtonId)record[0];
+        loadSteps[i].widthMs = record[1] | ((uint16_t)record[2] << 8);
+        loadSteps[i].gapMs = record[3] | ((uint16_t)record[4] << 8);
+        if (!isValidStep(loadSteps[i]))
+        {
+            file.close();
+            return false;
+        }
+    }
+    file.close();
+
+    count = header[3];
+    return true;
+}
+
+bool ButtonSequencer::remove(const char *sequenceName)
+{
+    return isValidName(sequenceName) && LittleFS.remove(pathFor(sequenceName));
+}
+
+String ButtonSequencer::listJson()
+{
+    String json = "[";
+    File dir = LittleFS.open(SEQUENCE_DIR);
+    if (dir && dir.isDirectory())
+    {
+        bool first = true;
+        for (File file = dir.openNextFile(); file; file = dir.openNextFile())
+        {
+            String fileName = file.name();
+            size_t steps = file.size() > 4 ? (file.size() - 4) / SEQUENCE_FILE_STEP_SIZE : 0;
+            file.close();
+
+            int slash = fileName.lastIndexOf('/');
+            if (slash >= 0)
+            {
+                fileName = fileName.substring(slash + 1);
+            }
+            if (!fileName.endsWith(".seq"))
+            {
+                continue;
+            }
+            fileName = fileName.substring(0, fileName.length() - 4);
+
+            if (!first)
+            {
+                json += ",";
+            }
+            first = false;
+            json += "{\"name\":\"" + fileName + "\",\"steps\":" + String(steps) + "}";
+        }
+    }
+    json += "]";
+    return json;
+}
+
+// =========================================================================
+// PARSING / VALIDATION
+// =========================================================================
+
+// CI-V 35: 3 bytes per step - 34-style button code, width, gap (10 ms units).
+// A byte above SEQUENCE_CIV_MAX_BYTE would be taken for framing on the bus,
+// so a step list containing one is rejected rather than half-played.
+uint8_t ButtonSequencer::parseCivSteps(const uint8_t *data, size_t len, SequenceStep *out)
+{
+    if (len == 0 || len % 3 != 0 || len / 3 > SEQUENCE_MAX_STEPS)
+    {
+        return 0;
+    }
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (data[i] > SEQUENCE_CIV_MAX_BYTE)
+        {
+            return 0;
+        }
+    }
+
+    uint8_t count = len / 3;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        out[i].button = buttonIdFromCivCode(data[i * 3]);
+        out[i].widthMs = data[i * 3 + 1] * SEQUENCE_CIV_UNIT_MS;
+        out[i].gapMs = data[i * 3 + 2] * SEQUENCE_CIV_UNIT_MS;
+        if (!isValidStep(out[i]))
+        {
+            return 0;
+        }
+    }
+    return count;
+}
+
+// Dashboard: [["button-cup", widthMs, gapMs], ...]
+uint8_t ButtonSequencer::parseJsonSteps(JsonArrayConst array, SequenceStep *out)
+{
+    if (array.isNull() || array.size() == 0 || array.size() > SEQUENCE_MAX_STEPS)
+    {
+        return 0;
+    }
+
+    uint8_t count = 0;
+    for (JsonVariantConst step : array)
+    {
+        long width = step[1] | 0L;
+        long gap = step[2] | (long)SEQUENCE_MIN_GAP_MS;
+        if (width < 0 || width > 0xFFFF || gap < 0 || gap > 0xFFFF)
+        {
+            return 0;
+        }
+
+        out[count].button = buttonIdFromText(step[0].as<const char *>());
+        out[count].widthMs = width;
+        out[count].gapMs = gap;
+        if (!isValidStep(out[count]))
+        {
+            return 0;
+        }
+        count++;
+    }
+    return count;
+}
+
+bool ButtonSequencer::isValidName(const char *sequenceName)
+{
+    if (!sequenceName || !sequenceName[0])
+    {
+        return false;
+    }
+
+    size_t len = 0;
+    for (const char *c = sequenceName; *c; c++, len++)
+    {
+        if (len >= SEQUENCE_NAME_MAX || !(isalnum((unsigned char)*c) || *c == '_' || *c == '-'))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ButtonSequencer::isValidStep(const SequenceStep &step)
+{
+    // ANT/AUTO are model-dependent latches, not macro material
+    return step.button <= BTN_TUNE &&
+           step.widthMs >= SEQUENCE_MIN_WIDTH_MS && step.widthMs <= SEQUENCE_MAX_WIDTH_MS &&
+           step.gapMs >= SEQUENCE_MIN_GAP_MS && step.gapMs <= SEQUENCE_MAX_GAP_MS;
+}
@@ -1,9 +1,40 @@
 #include "ConfigManager.h"
+#include <stddef.h>
 
-ConfigManager::ConfigManager()
-    : antState(false), autoState(false), currentCivModel(DEFAULT_CIV_MODEL),
-      deviceNumber(1), civAddress(CIV_BASE_ADDRESS + 1)
+static_assert(offsetof(StoredConfig, crc) + sizeof(uint32_t) == sizeof(StoredConfig),
+              "StoredConfig.crc must be the last field");
+
+static const char *const slotKeys[2] = {"cfgA", "cfgB"};
+
+// Smallest blob worth reading: header plus CRC
+#define CONFIG_BLOB_MIN_LENGTH (offsetof(StoredConfig, deviceNumber) + sizeof(uint32_t))
+
+// CRC-32 (IEEE, reflected); bitwise, the blob is only ~64 bytes
+static uint32_t crc32(const uint8_t *data, size_t length)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static void copyModel(char *dest, const char *model)
 {
+    strncpy(dest, model, CONFIG_CIV_MODEL_MAX - 1);
+    dest[CONFIG_CIV_MODEL_MAX - 1] = '\0';
+}
+
+ConfigManager::ConfigManager(PersistenceService *persistenceService)
+    : persistence(persistenceService), persistKey(PERSIST_INVALID_KEY), storeOpen(false), tunerModel(&tunerModels[TUNER_MODEL_DEFAULT]), civAddress(CIV_BASE_ADDRESS + 1),
+      activeSlot(-1), saveCount(0), saveFailures(0), migrated(false), saveMutex(nullptr)
+{
+    setDefaults(cfg);
 }
 
 ConfigManager::~ConfigManager()
@@ -15,169 +46,454 @@ bool ConfigManager::begin()
 {
     DEBUG_PRINTLN("[INFO] Initializing ConfigManager...");
 
-    // Test preferences access
-    if (!devicePrefs.begin(PREFS_DEVICE_NAMESPACE, false))
+    saveMutex = xSemaphoreCreateMutex();
+    storeOpen = store.begin(PREFS_STORE_NAMESPACE, false);
+    if (!storeOpen)
     {
-        DEBUG_PRINTLN("[ERROR] Failed to initialize device preferences");
+        DEBUG_PRINTLN("[ERROR] Failed to open config store");
+        updateCivAddress();
         return false;
     }
-    devicePrefs.end();
 
     loadAllSettings();
 
+    // Setter changes reach flash through the persistence service (coalesced)
+    if (persistence)
+    {
+        persistKey = persistence->registerKey("config", PERSIST_CONFIG_MIN_INTERVAL_MS, flushStore, this);
+    }
+
     DEBUG_PRINTLN("[INFO] ConfigManager initialized successfully");
     return true;
 }
 
-void ConfigManager::loadAllSettings()
+// =========================================================================
+// STORE
+// =========================================================================
+
+void ConfigManager::setDefaults(StoredConfig &config)
+{
+    // Zeroed first so padding bytes are deterministic under the CRC
+    memset(&config, 0, sizeof(config));
+    config.magic = CONFIG_BLOB_MAGIC;
+    config.version = CONFIG_BLOB_VERSION;
+    config.length = sizeof(StoredConfig);
+
+    config.deviceNumber = 1;
+    config.radioAddress = DEFAULT_RADIO_ADDRESS;
+    config.tuneMemoryAuto = true;
+    config.indicatorSettleMs = INDICATOR_SETTLE_DEFAULT_MS;
+    config.indicatorSampleHz = INDICATOR_SAMPLER_DEFAULT_HZ;
+    config.repeatCurve.widthMs = REPEAT_DEFAULT_WIDTH_MS;
+    config.repeatCurve.delayMs = REPEAT_DEFAULT_DELAY_MS;
+    config.repeatCurve.startMs = REPEAT_DEFAULT_START_MS;
+    config.repeatCurve.minMs = REPEAT_DEFAULT_MIN_MS;
+    config.repeatCurve.accelPercent = REPEAT_DEFAULT_ACCEL_PCT;
+    copyModel(config.civModel, DEFAULT_CIV_MODEL);
+}
+
+void ConfigManager::sanitize(StoredConfig &config)
+{
+    // A good CRC only says the bytes are what was written, not that they're sane
+    StoredConfig defaults;
+    setDefaults(defaults);
+
+    config.deviceNumber = constrain(config.deviceNumber, MIN_DEVICE_NUMBER, MAX_DEVICE_NUMBER);
+    config.rcsType = config.rcsType > 1 ? 0 : config.rcsType;
+    if (config.antennaPort > (config.rcsType == 0 ? 4 : 7))
+    {
+        config.antennaPort = 0;
+    }
+    config.indicatorSettleMs = constrain(config.indicatorSettleMs, 0, INDICATOR_SETTLE_MAX_MS);
+    config.indicatorSampleHz = constrain(config.indicatorSampleHz, 0, INDICATOR_SAMPLER_MAX_HZ);
+    if (!isValidRepeatCurve(config.repeatCurve))
+    {
+        config.repeatCurve = defaults.repeatCurve;
+    }
+    config.civModel[CONFIG_CIV_MODEL_MAX - 1] = '\0';
+    if (config.civModel[0] == '\0')
+    {
+        copyModel(config.civModel, DEFAULT_CIV_MODEL);
+    }
+}
+
+bool ConfigManager::readSlot(uint8_t slot, StoredConfig &out)
 {
-    // Load device number and calculate CI-V address
-    devicePrefs.begin(PREFS_DEVICE_NAMESPACE, false);
-    if (devicePrefs.isKey("deviceNumber"))
+    uint8_t raw[sizeof(StoredConfig) + 64]; // Room for a newer, longer layout
+    size_t length = store.getBytesLength(slotKeys[slot]);
+    if (length < CONFIG_BLOB_MIN_LENGTH || length > sizeof(raw) ||
+        store.getBytes(slotKeys[slot], raw, length) != length)
     {
-        deviceNumber = devicePrefs.getInt("deviceNumber", 1);
+        return false;
+    }
+
+    StoredConfig header;
+    memcpy(&header, raw, offsetof(StoredConfig, deviceNumber));
+    uint32_t storedCrc;
+    memcpy(&storedCrc, raw + length - sizeof(uint32_t), sizeof(uint32_t));
+
+    if (header.magic != CONFIG_BLOB_MAGIC || header.version == 0 || header.version > CONFIG_BLOB_VERSION ||
+        header.length != length || crc32(raw, length - sizeof(uint32_t)) != storedCrc)
+    {
+        DEBUG_PRINTF("[CONFIG] Slot %c invalid (%u bytes)\n", 'A' + slot, (unsigned)length);
+        return false;
+    }
+
+    // Fields this blob doesn't have keep their defaults
+    setDefaults(out);
+    size_t fields = length - sizeof(uint32_t);
+    memcpy(&out, raw, fields < offsetof(StoredConfig, crc) ? fields : offsetof(StoredConfig, crc));
+    out.magic = CONFIG_BLOB_MAGIC;
+    out.version = CONFIG_BLOB_VERSION;
+    out.length = sizeof(StoredConfig);
+    sanitize(out);
+    return true;
+}
+
+bool ConfigManager::save()
+{
+    if (!storeOpen)
+    {
+        return false;
+    }
+
+    xSemaphoreTake(saveMutex, portMAX_DELAY);
+
+    // Always the slot not holding the current copy: a torn write only loses this update
+    uint8_t slot = activeSlot == 0 ? 1 : 0;
+    StoredConfig image = cfg;
+    image.sequence = cfg.sequence + 1;
+    image.crc = crc32((const uint8_t *)&image, offsetof(StoredConfig, crc));
+
+    bool ok = store.putBytes(slotKeys[slot], &image, sizeof(image)) == sizeof(image);
+    if (ok)
+    {
+        cfg.sequence = image.sequence;
+        activeSlot = slot;
+        saveCount++;
     }
     else
     {
-        deviceNumber = 1;
-        devicePrefs.putInt("deviceNumber", deviceNumber);
+        saveFailures++;
     }
-    devicePrefs.end();
 
-    deviceNumber = constrain(deviceNumber, MIN_DEVICE_NUMBER, MAX_DEVICE_NUMBER);
-    updateCivAddress();
+    xSemaphoreGive(saveMutex);
+
+    if (!ok)
+    {
+        DEBUG_PRINTF("[ERROR] Config save to slot %c failed\n", 'A' + slot);
+    }
+    return ok;
+}
+
+void ConfigManager::requestSave()
+{
+    if (persistence && persistKey != PERSIST_INVALID_KEY)
+    {
+        persistence->markDirty(persistKey);
+    }
+    else
+    {
+        save(); // Not registered with the store yet: write through
+    }
+}
+
+bool ConfigManager::flushStore(void *context)
+{
+    return ((ConfigManager *)context)->save();
+}
+
+void ConfigManager::migrateLegacy()
+{
+    // Pre-blob firmware: one key per setting over five namespaces. Read
+    // once, the old keys stay where they are (a downgrade still finds them).
+    Preferences legacy;
 
-    // Load CI-V model
-    civModelPrefs.begin(PREFS_CIV_MODEL_NAMESPACE, false);
-    currentCivModel = civModelPrefs.getString("model", DEFAULT_CIV_MODEL);
-    civModelPrefs.end();
+    if (legacy.begin(PREFS_DEVICE_NAMESPACE, true))
+    {
+        cfg.deviceNumber = legacy.getInt("deviceNumber", cfg.deviceNumber);
+        legacy.end();
+    }
+
+    if (legacy.begin(PREFS_CIV_MODEL_NAMESPACE, true))
+    {
+        copyModel(cfg.civModel, legacy.getString("model", DEFAULT_CIV_MODEL).c_str());
+        legacy.end();
+    }
+
+    if (legacy.begin(PREFS_CONFIG_NAMESPACE, true))
+    {
+        cfg.radioAddress = legacy.getUChar("radioAddr", cfg.radioAddress);
+        cfg.tuneMemoryAuto = legacy.getBool("tmAuto", cfg.tuneMemoryAuto);
+        cfg.indicatorSettleMs = constrain(legacy.getUInt("dbSettle", cfg.indicatorSettleMs), 0, INDICATOR_SETTLE_MAX_MS);
+        cfg.indicatorSampleHz = constrain(legacy.getUInt("smpHz", cfg.indicatorSampleHz), 0, INDICATOR_SAMPLER_MAX_HZ);
+        cfg.demoMode = legacy.getBool("demo", cfg.demoMode);
+        cfg.antState = legacy.getBool("ant", cfg.antState);
+        cfg.autoState = legacy.getBool("auto", cfg.autoState);
+
+        RepeatCurve storedCurve;
+        if (legacy.getBytesLength("rptCurve") == sizeof(RepeatCurve) &&
+            legacy.getBytes("rptCurve", &storedCurve, sizeof(RepeatCurve)) == sizeof(RepeatCurve))
+        {
+            cfg.repeatCurve = storedCurve; // sanitize() drops it if invalid
+        }
+        legacy.end();
+    }
+
+    if (legacy.begin(PREFS_SWITCH_NAMESPACE, true))
+    {
+        cfg.antennaPort = legacy.getInt("selectedIndex", cfg.antennaPort);
+        legacy.end();
+    }
+
+    sanitize(cfg);
+}
+
+void ConfigManager::loadAllSettings()
+{
+    StoredConfig slots[2];
+    bool valid[2] = {false, false};
+    if (storeOpen)
+    {
+        valid[0] = readSlot(0, slots[0]);
+        valid[1] = readSlot(1, slots[1]);
+    }
+
+    if (valid[0] || valid[1])
+    {
+        // Higher sequence wins (wrap-safe compare)
+        uint8_t slot = !valid[0] || (valid[1] && (int32_t)(slots[1].sequence - slots[0].sequence) > 0) ? 1 : 0;
+        cfg = slots[slot];
+        activeSlot = slot;
+        DEBUG_PRINTF("[CONFIG] Loaded slot %c, sequence %lu\n", 'A' + slot, (unsigned long)cfg.sequence);
+    }
+    else
+    {
+        setDefaults(cfg);
+        activeSlot = -1;
+        if (storeOpen)
+        {
+            DEBUG_PRINTLN("[CONFIG] No config blob, migrating legacy keys");
+            migrateLegacy();
+            migrated = save();
+        }
+    }
 
-    // Load button states
-    loadLatchedStates();
+    updateCivAddress();
+    resolveTunerModel();
 
     DEBUG_PRINTF("[INFO] Configuration loaded - Device: %d, Model: %s, CIV: 0x%02X\n",
-                 deviceNumber, currentCivModel.c_str(), civAddress);
+                 cfg.deviceNumber, cfg.civModel, civAddress);
+    DEBUG_PRINTF("[INFO] Latched states loaded - ANT: %s, AUTO: %s\n",
+                 cfg.antState ? "ANT 2" : "ANT 1",
+                 cfg.autoState ? "AUTO" : "SEMI");
 }
 
+// =========================================================================
+// SETTINGS
+// =========================================================================
+
 void ConfigManager::setDeviceNumber(uint8_t number)
 {
     uint8_t newNumber = constrain(number, MIN_DEVICE_NUMBER, MAX_DEVICE_NUMBER);
 
-    if (newNumber != deviceNumber)
+    if (newNumber != cfg.deviceNumber)
     {
-        deviceNumber = newNumber;
+        cfg.deviceNumber = newNumber;
         updateCivAddress();
-
-        // Save to preferences
-        devicePrefs.begin(PREFS_DEVICE_NAMESPACE, false);
-        devicePrefs.putInt("deviceNumber", deviceNumber);
-        devicePrefs.end();
+        requestSave();
 
         DEBUG_PRINTF("[INFO] Device number updated to %d (CI-V: 0x%02X)\n",
-                     deviceNumber, civAddress);
+                     cfg.deviceNumber, civAddress);
     }
 }
 
-void ConfigManager::updateCivAddress()
+void ConfigManager::setRadioAddress(uint8_t address)
 {
-    civAddress = CIV_BASE_ADDRESS + deviceNumber;
-    DEBUG_PRINTF("[CONFIG] Device Number: %d, CI-V Address calculated: 0x%02X (base: 0x%02X)\n",
-                 deviceNumber, civAddress, CIV_BASE_ADDRESS);
+    if (address == cfg.radioAddress)
+    {
+        return;
+    }
+
+    cfg.radioAddress = address;
+    requestSave();
+
+    DEBUG_PRINTF("[INFO] Radio CI-V address updated to 0x%02X\n", cfg.radioAddress);
 }
 
-bool ConfigManager::setCivModel(const String &model)
+void ConfigManager::setIndicatorSettleMs(uint32_t requestedMs)
 {
-    if (model == currentCivModel)
+    // Clamp at full width; the stored field is only 16 bits
+    uint16_t settleMs = constrain(requestedMs, (uint32_t)0, (uint32_t)INDICATOR_SETTLE_MAX_MS);
+    if (settleMs == cfg.indicatorSettleMs)
     {
-        return true; // No change needed
+        return;
     }
 
-    DEBUG_PRINTF("[INFO] Attempting to change CI-V model from %s to %s\n",
-                 currentCivModel.c_str(), model.c_str());
+    cfg.indicatorSettleMs = settleMs;
+    requestSave();
 
-    civModelPrefs.begin(PREFS_CIV_MODEL_NAMESPACE, false);
-    size_t bytesWritten = civModelPrefs.putString("model", model);
-    civModelPrefs.end();
+    DEBUG_PRINTF("[INFO] Indicator debounce settle time set to %u ms\n", cfg.indicatorSettleMs);
+}
 
-    if (bytesWritten > 0)
+void ConfigManager::setIndicatorSampleHz(uint32_t requestedHz)
+{
+    uint16_t rateHz = constrain(requestedHz, (uint32_t)0, (uint32_t)INDICATOR_SAMPLER_MAX_HZ);
+    if (rateHz == cfg.indicatorSampleHz)
     {
-        String oldModel = currentCivModel;
-        currentCivModel = model;
+        return;
+    }
 
-        // Verify the save by reading it back
-        civModelPrefs.begin(PREFS_CIV_MODEL_NAMESPACE, false);
-        String verifyModel = civModelPrefs.getString("model", "ERROR");
-        civModelPrefs.end();
+    cfg.indicatorSampleHz = rateHz;
+    requestSave();
 
-        if (verifyModel == model)
-        {
-            DEBUG_PRINTF("[INFO] CI-V model successfully changed to %s (%d bytes)\n",
-                         currentCivModel.c_str(), bytesWritten);
-            return true;
-        }
-        else
-        {
-            // Rollback on verification failure
-            currentCivModel = oldModel;
-            DEBUG_PRINTF("[ERROR] CI-V model verification failed! Expected: %s, Got: %s\n",
-                         model.c_str(), verifyModel.c_str());
-            return false;
-        }
+    DEBUG_PRINTF("[INFO] Indicator trace sample rate set to %u Hz\n", cfg.indicatorSampleHz);
+}
+
+void ConfigManager::setDemoMode(bool enabled)
+{
+    if (enabled == cfg.demoMode)
+    {
+        return;
     }
-    else
+
+    cfg.demoMode = enabled;
+    requestSave();
+
+    DEBUG_PRINTF("[INFO] Demo mode %s (takes effect after restart)\n", cfg.demoMode ? "enabled" : "disabled");
+}
+
+void ConfigManager::setTuneMemoryAuto(bool enabled)
+{
+    if (enabled == cfg.tuneMemoryAuto)
     {
-        DEBUG_PRINTF("[ERROR] Failed to save CI-V model to preferences\n");
+        return;
+    }
+
+    cfg.tuneMemoryAuto = enabled;
+    requestSave();
+
+    DEBUG_PRINTF("[INFO] Tune memory auto-replay %s\n", cfg.tuneMemoryAuto ? "enabled" : "disabled");
+}
+
+bool ConfigManager::isValidRepeatCurve(const RepeatCurve &curve)
+{
+    // Every interval must leave the tuner a visible release before the next press
+    return curve.widthMs >= SEQUENCE_MIN_WIDTH_MS && curve.widthMs <= SEQUENCE_MAX_WIDTH_MS &&
+           curve.minMs >= curve.widthMs + SEQUENCE_MIN_GAP_MS &&
+           curve.startMs >= curve.minMs && curve.delayMs >= curve.minMs &&
+           curve.delayMs <= SEQUENCE_MAX_GAP_MS && curve.startMs <= SEQUENCE_MAX_GAP_MS &&
+           curve.accelPercent <= REPEAT_MAX_ACCEL_PCT;
+}
+
+bool ConfigManager::setRepeatCurve(const RepeatCurve &curve)
+{
+    if (!isValidRepeatCurve(curve))
+    {
+        DEBUG_PRINTLN("[CONFIG] Rejecting invalid repeat curve");
         return false;
     }
+
+    cfg.repeatCurve = curve;
+    requestSave();
+
+    DEBUG_PRINTF("[INFO] Repeat curve: width %u ms, delay %u ms, %u -> %u ms at %u%%/pulse\n",
+                 curve.widthMs, curve.delayMs, curve.startMs, curve.minMs, curve.accelPercent);
+    return true;
+}
+
+void ConfigManager::resolveTunerModel()
+{
+    tunerModel = findTunerModel(cfg.civModel);
+    if (!tunerModel)
+    {
+        // Free-form name from older firmware: "998" anywhere meant the 998
+        tunerModel = &tunerModels[strstr(cfg.civModel, "998") ? TUNER_MODEL_998 : TUNER_MODEL_DEFAULT];
+        DEBUG_PRINTF("[CONFIG] Unknown tuner model '%s', using %s\n", cfg.civModel, tunerModel->name);
+        copyModel(cfg.civModel, tunerModel->name);
+    }
+}
+
+void ConfigManager::updateCivAddress()
+{
+    civAddress = CIV_BASE_ADDRESS + cfg.deviceNumber;
+    DEBUG_PRINTF("[CONFIG] Device Number: %d, CI-V Address calculated: 0x%02X (base: 0x%02X)\n",
+                 cfg.deviceNumber, civAddress, CIV_BASE_ADDRESS);
+}
+
+bool ConfigManager::setCivModel(const String &model)
+{
+    const TunerModel *next = findTunerModel(model.c_str());
+    if (!next)
+    {
+        DEBUG_PRINTF("[ERROR] Unknown tuner model '%s'\n", model.c_str());
+        return false;
+    }
+    return setTunerModel(next->id);
+}
+
+bool ConfigManager::setTunerModel(TunerModelId id)
+{
+    if (id >= TUNER_MODEL_COUNT)
+    {
+        return false;
+    }
+    if (tunerModel->id == id)
+    {
+        return true; // No change needed
+    }
+
+    DEBUG_PRINTF("[INFO] CI-V model changed from %s to %s\n", tunerModel->name, tunerModels[id].name);
+
+    tunerModel = &tunerModels[id];
+    copyModel(cfg.civModel, tunerModel->name);
+    requestSave();
+    return true;
 }
 
 void ConfigManager::setAntState(bool state)
 {
-    if (antState != state)
+    if (cfg.antState != state)
     {
-        antState = state;
-        saveLatchedStates();
+        cfg.antState = state;
+        requestSave();
         DEBUG_PRINTF("[INFO] ANT state changed to %s\n", state ? "ANT 2" : "ANT 1");
     }
 }
 
 void ConfigManager::setAutoState(bool state)
 {
-    if (autoState != state)
+    if (cfg.autoState != state)
     {
-        autoState = state;
-        saveLatchedStates();
+        cfg.autoState = state;
+        requestSave();
         DEBUG_PRINTF("[INFO] AUTO state changed to %s\n", state ? "AUTO" : "SEMI");
     }
 }
 
-void ConfigManager::loadLatchedStates()
+void ConfigManager::setSwitchSettings(uint8_t antennaPort, uint8_t rcsType)
 {
-    configPrefs.begin(PREFS_CONFIG_NAMESPACE, false);
-    antState = configPrefs.getBool("ant", false);
-    autoState = configPrefs.getBool("auto", false);
-    configPrefs.end();
-
-    DEBUG_PRINTF("[INFO] Latched states loaded - ANT: %s, AUTO: %s\n",
-                 antState ? "ANT 2" : "ANT 1",
-                 autoState ? "AUTO" : "SEMI");
-}
+    if (antennaPort == cfg.antennaPort && rcsType == cfg.rcsType)
+    {
+        return;
+    }
 
-void ConfigManager::saveLatchedStates()
-{
-    configPrefs.begin(PREFS_CONFIG_NAMESPACE, false);
-    configPrefs.putBool("ant", antState);
-    configPrefs.putBool("auto", autoState);
-    configPrefs.end();
+    cfg.antennaPort = antennaPort;
+    cfg.rcsType = rcsType;
+    sanitize(cfg);
+    requestSave();
 
-    DEBUG_PRINTF("[DEBUG] Latched states saved - ANT: %s, AUTO: %s\n",
-                 antState ? "ANT 2" : "ANT 1",
-                 autoState ? "AUTO" : "SEMI");
+    DEBUG_PRINTF("[INFO] Antenna switch saved - port %u, %s\n", cfg.antennaPort + 1,
+                 cfg.rcsType == 0 ? "RCS-8" : "RCS-10");
 }
 
 bool ConfigManager::hasWifiCredentials()
 {
-    wifiPrefs.begin(PREFS_WIFI_NAMESPACE, true); // Read-only
+    Preferences wifiPrefs;
+    if (!wifiPrefs.begin(PREFS_WIFI_NAMESPACE, true)) // Read-only
+    {
+        return false;
+    }
     bool hasSSID = wifiPrefs.isKey("ssid");
     bool hasPassword = wifiPrefs.isKey("password");
     wifiPrefs.end();
@@ -187,6 +503,7 @@ bool ConfigManager::hasWifiCredentials()
 
 void ConfigManager::clearWifiCredentials()
 {
+    Preferences wifiPrefs;
     wifiPrefs.begin(PREFS_WIFI_NAMESPACE, false);
     wifiPrefs.clear();
     wifiPrefs.end();
@@ -194,56 +511,99 @@ void ConfigManager::clearWifiCredentials()
     DEBUG_PRINTLN("[INFO] WiFi credentials cleared");
 }
 
+// =========================================================================
+// STATUS
+// =========================================================================
+
 void ConfigManager::printConfiguration()
 {
     DEBUG_PRINTLN("========== CONFIGURATION ==========");
     DEBUG_PRINTF("Project: %s v%s\n", PROJECT_NAME, PROJECT_VERSION);
     DEBUG_PRINTF("Build: %s\n", FIRMWARE_BUILD_DATE);
-    DEBUG_PRINTF("Device Number: %d\n", deviceNumber);
+    DEBUG_PRINTF("Device Number: %d\n", cfg.deviceNumber);
     DEBUG_PRINTF("CI-V Address: 0x%02X\n", civAddress);
-    DEBUG_PRINTF("CI-V Model: %s\n", currentCivModel.c_str());
-    DEBUG_PRINTF("ANT State: %s\n", antState ? "ANT 2" : "ANT 1");
-    DEBUG_PRINTF("AUTO State: %s\n", autoState ? "AUTO" : "SEMI");
+    DEBUG_PRINTF("CI-V Model: %s\n", cfg.civModel);
+    DEBUG_PRINTF("Radio Address: 0x%02X\n", cfg.radioAddress);
+    DEBUG_PRINTF("Indicator Debounce: %u ms\n", cfg.indicatorSettleMs);
+    DEBUG_PRINTF("ANT State: %s\n", cfg.antState ? "ANT 2" : "ANT 1");
+    DEBUG_PRINTF("AUTO State: %s\n", cfg.autoState ? "AUTO" : "SEMI");
+    DEBUG_PRINTF("Antenna Switch: port %u, %s\n", cfg.antennaPort + 1, cfg.rcsType == 0 ? "RCS-8" : "RCS-10");
     DEBUG_PRINTF("Model Type: %s\n", isModelMomentary() ? "Momentary" : "Latching");
+    DEBUG_PRINTF("Store: slot %c, sequence %lu, %lu saves\n", activeSlot < 0 ? '-' : 'A' + activeSlot,
+                 (unsigned long)cfg.sequence, (unsigned long)saveCount);
     DEBUG_PRINTLN("===================================");
 }
 
-String ConfigManager::getConfigurationJson()
+void ConfigManager::writeJson(JsonWriter &json) const
 {
-    String json = "{";
-    json += "\"project_name\":\"" + String(PROJECT_NAME) + "\",";
-    json += "\"version\":\"" + String(PROJECT_VERSION) + "\",";
-    json += "\"build_date\":\"" + String(FIRMWARE_BUILD_DATE) + "\",";
-    json += "\"device_number\":" + String(deviceNumber) + ",";
-    json += "\"civ_address\":\"0x" + String(civAddress, HEX) + "\",";
-    json += "\"civ_model\":\"" + currentCivModel + "\",";
-    json += "\"ant_state\":\"" + String(antState ? "ANT 2" : "ANT 1") + "\",";
-    json += "\"auto_state\":\"" + String(autoState ? "AUTO" : "SEMI") + "\",";
-    json += "\"ant_button_momentary\":" + String(isModelMomentary() ? "true" : "false");
-    json += "}";
-
-    return json;
+    const RepeatCurve &repeatCurve = cfg.repeatCurve;
+
+    json.beginObject();
+    json.add("project_name", PROJECT_NAME);
+    json.add("version", PROJECT_VERSION);
+    json.add("build_date", FIRMWARE_BUILD_DATE);
+    json.add("device_number", cfg.deviceNumber);
+    json.addHex("civ_address", civAddress);
+    json.add("civ_model", cfg.civModel);
+    json.addHex("radio_address", cfg.radioAddress);
+    json.add("tune_memory_auto", cfg.tuneMemoryAuto);
+    json.add("indicator_settle_ms", cfg.indicatorSettleMs);
+    json.add("indicator_sample_hz", cfg.indicatorSampleHz);
+    json.add("demo_mode", cfg.demoMode);
+
+    json.beginObject("repeat_curve");
+    json.add("width_ms", repeatCurve.widthMs);
+    json.add("delay_ms", repeatCurve.delayMs);
+    json.add("start_ms", repeatCurve.startMs);
+    json.add("min_ms", repeatCurve.minMs);
+    json.add("accel_pct", repeatCurve.accelPercent);
+    json.endObject();
+
+    json.add("ant_state", cfg.antState ? "ANT 2" : "ANT 1");
+    json.add("auto_state", cfg.autoState ? "AUTO" : "SEMI");
+    json.add("antenna_port", cfg.antennaPort + 1);
+    json.add("rcs_type", cfg.rcsType);
+    json.add("ant_button_momentary", isModelMomentary());
+    writeTunerModelJson(json, "tuner", *tunerModel);
+
+    json.beginObject("store");
+    json.add("slot", activeSlot < 0 ? "none" : slotKeys[activeSlot]);
+    json.add("sequence", cfg.sequence);
+    json.add("version", CONFIG_BLOB_VERSION);
+    json.add("bytes", sizeof(StoredConfig));
+    json.add("saves", saveCount);
+    json.add("failures", saveFailures);
+    json.add("migrated", migrated);
+    json.endObject();
+
+    json.endObject();
 }
 
+// =========================================================================
+// RESET / VALIDATION
+// =========================================================================
+
 void ConfigManager::resetToDefaults()
 {
     DEBUG_PRINTLN("[INFO] Resetting configuration to defaults...");
 
-    // Reset device settings
-    setDeviceNumber(1);
-    setCivModel(DEFAULT_CIV_MODEL);
-
-    // Reset button states
-    resetButtonStates();
+    // Reset device settings and button states, one write
+    cfg.deviceNumber = 1;
+    copyModel(cfg.civModel, DEFAULT_CIV_MODEL);
+    resolveTunerModel();
+    cfg.antState = false;
+    cfg.autoState = false;
+    updateCivAddress();
+    requestSave();
 
     DEBUG_PRINTLN("[INFO] Configuration reset to defaults");
 }
 
 void ConfigManager::resetButtonStates()
 {
-    antState = false;
-    autoState = false;
-    saveLatchedStates();
+    cfg.antState = false;
+    cfg.autoState = false;
+    requestSave();
 
     DEBUG_PRINTLN("[INFO] Button states reset to defaults");
 }
@@ -253,21 +613,21 @@ bool ConfigManager::validateConfiguration()
     bool valid = true;
 
     // Validate device number
-    if (deviceNumber < MIN_DEVICE_NUMBER || deviceNumber > MAX_DEVICE_NUMBER)
+    if (cfg.deviceNumber < MIN_DEVICE_NUMBER || cfg.deviceNumber > MAX_DEVICE_NUMBER)
     {
-        DEBUG_PRINTF("[ERROR] Invalid device number: %d\n", deviceNumber);
+        DEBUG_PRINTF("[ERROR] Invalid device number: %d\n", cfg.deviceNumber);
         valid = false;
     }
 
     // Validate CI-V model
-    if (currentCivModel.length() == 0)
+    if (cfg.civModel[0] == '\0')
     {
         DEBUG_PRINTLN("[ERROR] Empty CI-V model");
         valid = false;
     }
 
     // Validate CI-V address calculation
-    uint8_t expectedAddress = CIV_BASE_ADDRESS + deviceNumber;
+    uint8_t expectedAddress = CIV_BASE_ADDRESS + cfg.deviceNumber;
     if (civAddress != expectedAddress)
     {
         DEBUG_PRINTF("[ERROR] CI-V address mismatch. Expected: 0x%02X, Got: 0x%02X\n",
@@ -0,0 +1,121 @@
+#include "Diagnostics.h"
+#include "esp_heap_caps.h"
+
+Diagnostics::Diagnostics(HardwareManager &hw)
+    : hardware(hw), benchRunning(false), benchIterations(0), benchErrors(0), benchStartedMs(0), benchDurationMs(0)
+{
+}
+
+void Diagnostics::reset()
+{
+    loopTime.reset();
+    civDispatch.reset();
+}
+
+// =========================================================================
+// I2C BENCHMARK
+// =========================================================================
+
+bool Diagnostics::startI2CBenchmark(uint32_t iterations)
+{
+    if (benchRunning || !hardware.isMCPReady())
+    {
+        return false;
+    }
+
+    benchIterations = (uint16_t)constrain(iterations, (uint32_t)1, (uint32_t)DIAG_BENCH_MAX_ITERATIONS);
+    benchErrors = 0;
+    benchStartedMs = millis();
+    benchDurationMs = 0;
+    i2cRoundTrip.reset();
+
+    benchRunning = true;
+    if (xTaskCreate(benchTaskEntry, "diag-bench", DIAG_BENCH_TASK_STACK, this, DIAG_BENCH_TASK_PRIORITY, nullptr) != pdPASS)
+    {
+        benchRunning = false;
+        DEBUG_PRINTLN("[ERROR] DIAG: Failed to start benchmark task");
+        return false;
+    }
+
+    DEBUG_PRINTF("[DIAG] I2C benchmark started (%u reads)\n", benchIterations);
+    return true;
+}
+
+void Diagnostics::benchTaskEntry(void *arg)
+{
+    Diagnostics *self = static_cast<Diagnostics *>(arg);
+    self->runI2CBenchmark();
+    self->benchRunning = false;
+    vTaskDelete(nullptr);
+}
+
+void Diagnostics::runI2CBenchmark()
+{
+    ExpanderRegistry &expanders = hardware.getExpanders();
+
+    for (uint16_t i = 0; i < benchIterations; i++)
+    {
+        // Same transaction as the input poll: register pointer + 2-byte GPIO
+        // read. Untraced, so the run doesn't show up in i2c_per_loop; the
+        // benchmark has its own count (iterations, errors)
+        uint16_t value;
+        uint32_t start = micros();
+        bool ok = expanders.readPinsUntraced(MCP23017_ADDRESS, value);
+        uint32_t elapsed = micros() - start;
+
+        if (ok)
+        {
+            i2cRoundTrip.record(elapsed);
+        }
+        else
+        {
+            benchErrors++;
+        }
+
+        // Leave the bus and the CPU to everyone else now and then
+        if ((i & (DIAG_BENCH_BATCH - 1)) == DIAG_BENCH_BATCH - 1)
+        {
+            vTaskDelay(1);
+        }
+    }
+
+    benchDurationMs = millis() - benchStartedMs;
+    DEBUG_PRINTF("[DIAG] I2C benchmark done: p50 %lu us, p99 %lu us, %lu errors\n",
+                 (unsigned long)i2cRoundTrip.percentile(50), (unsigned long)i2cRoundTrip.percentile(99),
+                 (unsigned long)benchErrors);
+}
+
+// =========================================================================
+// REPORT
+// =========================================================================
+
+String Diagnostics::getJson(const String &extraFields)
+{
+    String json = "{";
+    json += "\"uptime_ms\":" + String(millis()) + ",";
+
+    json += "\"heap\":{";
+    json += "\"free\":" + String(ESP.getFreeHeap()) + ",";
+    json += "\"min_free\":" + String(ESP.getMinFreeHeap()) + ",";
+    json += "\"largest_block\":" + String(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT)) + ",";
+    json += "\"size\":" + String(ESP.getHeapSize()) + "},";
+
+    json += "\"loop\":" + loopTime.toJson() + ",";
+    json += "\"civ_dispatch\":" + civDispatch.toJson() + ",";
+
+    json += "\"i2c_bench\":{";
+    json += "\"state\":\"" + String(benchRunning ? "running" : (benchStartedMs ? "done" : "never_run")) + "\",";
+    json += "\"iterations\":" + String(benchIterations) + ",";
+    json += "\"errors\":" + String(benchErrors) + ",";
+    json += "\"duration_ms\":" + String(benchDurationMs) + ",";
+    json += "\"age_ms\":" + String(benchStartedMs ? millis() - benchStartedMs : 0) + ",";
+    json += "\"round_trip\":" + i2cRoundTrip.toJson() + "},";
+
+    json += "\"hardware\":" + hardware.getHardwareStatus();
+    if (extraFields.length())
+    {
+        json += "," + extraFields;
+    }
+    json += "}";
+    return json;
+}
@@ -0,0 +1,185 @@
+#include "EventLog.h"
+#include "ButtonId.h"
+
+static_assert((EVENT_LOG_CAPACITY & (EVENT_LOG_CAPACITY - 1)) == 0, "EVENT_LOG_CAPACITY must be a power of two");
+
+EventLog::EventLog() : nextSeq(0)
+{
+    for (uint16_t i = 0; i < EVENT_LOG_CAPACITY; i++)
+    {
+        slots[i].stamp.store(0, std::memory_order_relaxed);
+    }
+}
+
+// =========================================================================
+// WRITE SIDE
+// =========================================================================
+
+void EventLog::record(EventKind kind, uint8_t subject, const EventSource &source, uint32_t value)
+{
+    uint32_t seq = nextSeq.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = slots[seq & (EVENT_LOG_CAPACITY - 1)];
+
+    // Unpublish first so a concurrent reader can't accept a half-written slot
+    slot.stamp.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.timeMs = millis();
+    slot.kind = kind;
+    slot.subject = subject;
+    slot.source = source.type;
+    slot.sourceId = source.id;
+    slot.value = value > 0xFFFF ? 0xFFFF : (uint16_t)value;
+
+    slot.stamp.store(seq + 1, std::memory_order_release);
+}
+
+// =========================================================================
+// READ SIDE
+// =========================================================================
+
+uint32_t EventLog::oldest() const
+{
+    uint32_t next = head();
+    return next > EVENT_LOG_CAPACITY ? next - EVENT_LOG_CAPACITY : 0;
+}
+
+bool EventLog::read(uint32_t seq, EventRecord &out) const
+{
+    const Slot &slot = slots[seq & (EVENT_LOG_CAPACITY - 1)];
+
+    if (slot.stamp.load(std::memory_order_acquire) != seq + 1)
+    {
+        return false; // Not written yet, being rewritten, or already overwritten
+    }
+
+    out.seq = seq;
+    out.timeMs = slot.timeMs;
+    out.kind = slot.kind;
+    out.subject = slot.subject;
+    out.source = slot.source;
+    out.sourceId = slot.sourceId;
+    out.value = slot.value;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.stamp.load(std::memory_order_relaxed) == seq + 1;
+}
+
+String EventLog::exportJson(uint32_t &cursor, uint16_t limit)
+{
+    uint32_t next = head();
+    uint32_t first = oldest();
+    uint32_t dropped = 0;
+
+    // Reader fell behind the writers: skip to what is still there
+    if (cursor < first || cursor > next)
+    {
+        dropped = cursor < first ? first - cursor : 0;
+        cursor = first;
+    }
+
+    String json = "{\"events\":[";
+    uint16_t count = 0;
+    EventRecord event;
+
+    while (cursor < next && count < limit)
+    {
+        if (!read(cursor, event))
+        {
+            if (cursor + EVENT_LOG_CAPACITY <= head())
+            {
+                dropped++; // Overwritten while we were reading
+                cursor++;
+                continue;
+            }
+            break; // Still being written - pick it up next time
+        }
+
+        if (count++ > 0)
+        {
+            json += ",";
+        }
+        json += toJson(event);
+        cursor++;
+    }
+
+    json += "],\"cursor\":" + String(cursor);
+    json += ",\"head\":" + String(next);
+    json += ",\"dropped\":" + String(dropped);
+    json += "}";
+    return json;
+}
+
+// =========================================================================
+// FORMATTING
+// =========================================================================
+
+const char *EventLog::kindName(uint8_t kind)
+{
+    switch (kind)
+    {
+    case EVT_PULSE:
+        return "pulse";
+    case EVT_PRESS:
+        return "press";
+    case EVT_RELEASE:
+        return "release";
+    case EVT_LATCH:
+        return "latch";
+    case EVT_INDICATOR:
+        return "indicator";
+    case EVT_REJECT:
+        return "reject";
+    case EVT_OUTPUT_FAULT:
+        return "output_fault";
+    default:
+        return "unknown";
+    }
+}
+
+const char *EventLog::sourceName(uint8_t source)
+{
+    switch (source)
+    {
+    case SRC_CIV:
+        return "civ";
+    case SRC_DASHBOARD:
+        return "dashboard";
+    case SRC_HTTP:
+        return "http";
+    case SRC_SEQUENCE:
+        return "sequence";
+    case SRC_REPEAT:
+        return "repeat";
+    case SRC_TUNE_MEMORY:
+        return "tune_memory";
+    case SRC_HARDWARE:
+        return "hardware";
+    default:
+        return "internal";
+    }
+}
+
+String EventLog::toJson(const EventRecord &event)
+{
+    const char *subject;
+    if (event.kind == EVT_INDICATOR)
+    {
+        subject = event.subject == EVENT_SUBJECT_TUNING ? "tuning" : "swr";
+    }
+    else
+    {
+        subject = buttonIdToText((ButtonId)event.subject);
+    }
+
+    String json = "{";
+    json += "\"seq\":" + String(event.seq) + ",";
+    json += "\"t\":" + String(event.timeMs) + ",";
+    json += "\"kind\":\"" + String(kindName(event.kind)) + "\",";
+    json += "\"subject\":\"" + String(subject) + "\",";
+    json += "\"source\":\"" + String(sourceName(event.source)) + "\",";
+    json += "\"source_id\":" + String(event.sourceId) + ",";
+    json += "\"value\":" + String(event.value);
+    json += "}";
+    return json;
+}
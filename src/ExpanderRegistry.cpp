@@ -0,0 +1,300 @@
+#include "ExpanderRegistry.h"
+
+ExpanderRegistry::ExpanderRegistry(MCP23017Bus &i2cBus)
+    : bus(i2cBus), outputMutex(nullptr), lastScan(0), scanRequested(false), lastPoll(0), pollCount(0)
+{
+    // Tuner 1 occupies the first 16 logical pins. Its driver exists from
+    // the start, so outputs can be configured before the expander answers
+    // and are pushed by attach() when it does.
+    mapDevice(0, MCP23017_ADDRESS);
+    slotFor(MCP23017_ADDRESS)->driver = new MCP23017(MCP23017_ADDRESS, bus);
+}
+
+ExpanderRegistry::~ExpanderRegistry()
+{
+    for (int i = 0; i < MCP23017_MAX_DEVICES; i++)
+    {
+        if (slots[i].driver)
+        {
+            delete slots[i].driver;
+        }
+    }
+}
+
+ExpanderSlot *ExpanderRegistry::slotFor(uint8_t address)
+{
+    if (address < EXPANDER_SCAN_FIRST || address > EXPANDER_SCAN_LAST)
+    {
+        return nullptr;
+    }
+    return &slots[address - MCP23017_BASE_ADDRESS];
+}
+
+const ExpanderSlot *ExpanderRegistry::slotFor(uint8_t address) const
+{
+    return const_cast<ExpanderRegistry *>(this)->slotFor(address);
+}
+
+uint8_t ExpanderRegistry::scan()
+{
+    uint8_t found = 0;
+
+    for (uint8_t address = EXPANDER_SCAN_FIRST; address <= EXPANDER_SCAN_LAST; address++)
+    {
+        ExpanderSlot &slot = *slotFor(address);
+        bool answered = bus.probe(address);
+
+        if (answered && !slot.present)
+        {
+            attach(address, slot);
+        }
+        else if (!answered && slot.present)
+        {
+            detach(address, slot);
+        }
+
+        if (slot.present)
+        {
+            found++;
+        }
+    }
+
+    lastScan = millis();
+    return found;
+}
+
+void ExpanderRegistry::attach(uint8_t address, ExpanderSlot &slot)
+{
+    bool firstTime = (slot.attachCount == 0);
+    if (!slot.driver)
+    {
+        slot.driver = new MCP23017(address, bus);
+        if (!slot.driver)
+        {
+            DEBUG_PRINTF("[ERROR] Failed to create MCP23017 instance for 0x%02X\n", address);
+            return;
+        }
+    }
+
+    // Push the cached IODIR/GPPU/OLAT so a re-attached device resumes
+    // exactly where it was before it dropped off the bus
+    {
+        OutputLock lock(outputMutex);
+        slot.driver->begin();
+    }
+    slot.present = true;
+    slot.failedPolls = 0;
+    slot.attachCount++;
+    slot.lastSeen = millis();
+
+    DEBUG_PRINTF("[INFO] MCP23017 at 0x%02X %s\n", address, firstTime ? "attached" : "re-attached");
+}
+
+void ExpanderRegistry::detach(uint8_t address, ExpanderSlot &slot)
+{
+    slot.present = false;
+    DEBUG_PRINTF("[WARNING] MCP23017 at 0x%02X no longer responding\n", address);
+}
+
+void ExpanderRegistry::poll()
+{
+    for (uint8_t address = EXPANDER_SCAN_FIRST; address <= EXPANDER_SCAN_LAST; address++)
+    {
+        ExpanderSlot &slot = *slotFor(address);
+        if (!slot.present)
+        {
+            continue;
+        }
+
+        uint8_t gpio[2];
+        if (bus.readRegisters(address, MCP23017_GPIOA, gpio, 2))
+        {
+            slot.snapshot = ((uint16_t)gpio[1] << 8) | gpio[0];
+            slot.lastSeen = millis();
+            slot.failedPolls = 0;
+        }
+        else if (++slot.failedPolls >= EXPANDER_FAIL_THRESHOLD)
+        {
+            // Keep the last good snapshot; the next scan re-attaches it.
+            // A single NACK (bus noise) doesn't cost a re-attach.
+            detach(address, slot);
+        }
+    }
+
+    lastPoll = millis();
+    pollCount++;
+}
+
+void ExpanderRegistry::update()
+{
+    unsigned long now = millis();
+
+    if (scanRequested || now - lastScan >= EXPANDER_SCAN_INTERVAL)
+    {
+        scanRequested = false;
+        scan();
+    }
+
+    if (now - lastPoll >= EXPANDER_POLL_INTERVAL)
+    {
+        poll();
+    }
+}
+
+MCP23017 *ExpanderRegistry::getDevice(uint8_t address)
+{
+    ExpanderSlot *slot = slotFor(address);
+    return slot ? slot->driver : nullptr;
+}
+
+bool ExpanderRegistry::isPresent(uint8_t address) const
+{
+    const ExpanderSlot *slot = slotFor(address);
+    return slot && slot->present;
+}
+
+uint8_t ExpanderRegistry::getPresentMask() const
+{
+    uint8_t mask = 0;
+    for (int i = 0; i < MCP23017_MAX_DEVICES; i++)
+    {
+        if (slots[i].present)
+        {
+            mask |= (1 << i);
+        }
+    }
+    return mask;
+}
+
+uint8_t ExpanderRegistry::getPresentCount() const
+{
+    uint8_t count = 0;
+    for (int i = 0; i < MCP23017_MAX_DEVICES; i++)
+    {
+        if (slots[i].present)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+uint16_t ExpanderRegistry::getSnapshot(uint8_t address) const
+{
+    const ExpanderSlot *slot = slotFor(address);
+    return slot ? slot->snapshot : 0;
+}
+
+// Same read as poll(), but below the tracing wrapper: a task reading faster
+// than the snapshot refreshes (the indicator sampler, the I2C benchmark)
+// would otherwise land its reads in whatever loop iteration is running and
+// inflate the per-loop I2C count. Such a caller keeps its own count.
+bool ExpanderRegistry::readPinsUntraced(uint8_t address, uint16_t &pins)
+{
+    const ExpanderSlot *slot = slotFor(address);
+    if (!slot || !slot->present)
+    {
+        return false;
+    }
+
+    uint8_t gpio[2];
+    if (!bus.inner().readRegisters(address, MCP23017_GPIOA, gpio, 2))
+    {
+        return false;
+    }
+    pins = ((uint16_t)gpio[1] << 8) | gpio[0];
+    return true;
+}
+
+bool ExpanderRegistry::mapPin(uint8_t logicalPin, uint8_t address, uint8_t pin)
+{
+    if (logicalPin >= MAX_LOGICAL_PINS || pin > 15 || !slotFor(address))
+    {
+        DEBUG_PRINTF("[ERROR] Invalid logical pin mapping %d -> 0x%02X/%d\n", logicalPin, address, pin);
+        return false;
+    }
+
+    logicalPins[logicalPin] = LogicalPin(address, pin);
+    return true;
+}
+
+bool ExpanderRegistry::mapDevice(uint8_t firstLogicalPin, uint8_t address)
+{
+    if (firstLogicalPin + 16 > MAX_LOGICAL_PINS || !slotFor(address))
+    {
+        return false;
+    }
+
+    for (uint8_t pin = 0; pin < 16; pin++)
+    {
+        logicalPins[firstLogicalPin + pin] = LogicalPin(address, pin);
+    }
+    return true;
+}
+
+void ExpanderRegistry::unmapPin(uint8_t logicalPin)
+{
+    if (logicalPin < MAX_LOGICAL_PINS)
+    {
+        logicalPins[logicalPin] = LogicalPin();
+    }
+}
+
+const LogicalPin *ExpanderRegistry::resolve(uint8_t logicalPin) const
+{
+    if (logicalPin >= MAX_LOGICAL_PINS || logicalPins[logicalPin].address == LOGICAL_PIN_UNMAPPED)
+    {
+        return nullptr;
+    }
+    return &logicalPins[logicalPin];
+}
+
+bool ExpanderRegistry::readLogical(uint8_t logicalPin) const
+{
+    const LogicalPin *lp = resolve(logicalPin);
+    if (!lp)
+    {
+        return false;
+    }
+    return (getSnapshot(lp->address) >> lp->pin) & 0x01;
+}
+
+void ExpanderRegistry::printDevices()
+{
+    DEBUG_PRINTLN("=== I2C Expanders ===");
+    for (uint8_t address = EXPANDER_SCAN_FIRST; address <= EXPANDER_SCAN_LAST; address++)
+    {
+        const ExpanderSlot &slot = *slotFor(address);
+        if (slot.driver || slot.present)
+        {
+            DEBUG_PRINTF("0x%02X: %s (attached %u times, inputs 0x%04X)\n", address,
+                         slot.present ? "PRESENT" : "MISSING", slot.attachCount, slot.snapshot);
+        }
+    }
+    DEBUG_PRINTLN("=====================");
+}
+
+String ExpanderRegistry::getDevicesJson()
+{
+    String json = "[";
+    bool first = true;
+    for (uint8_t address = EXPANDER_SCAN_FIRST; address <= EXPANDER_SCAN_LAST; address++)
+    {
+        const ExpanderSlot &slot = *slotFor(address);
+        if (!slot.driver && !slot.present)
+        {
+            continue;
+        }
+        if (!first)
+        {
+            json += ",";
+        }
+        first = false;
+        json += "{\"address\":" + String(address) + ",";
+        json += "\"present\":" + String(slot.present ? "true" : "false") + ",";
+        json += "\"attach_count\":" + String(slot.attachCount) + ",";
+        json += "\"snapshot\":" + String(slot.snapshot) + "}";
+    }
+    json += "]";
+    return json;
+}
@@ -0,0 +1,201 @@
+#include "IndicatorSampler.h"
+
+IndicatorSampler::IndicatorSampler(ExpanderRegistry &registry)
+    : expanders(registry), mutex(xSemaphoreCreateMutex()), task(nullptr), periodMs(0),
+      head(0), count(0), totalSamples(0), lastSampleMs(0), readErrors(0)
+{
+    // The mutex exists from the start: the HTTP export and setRate() can run
+    // whether or not begin() was (the expander may be missing at boot)
+}
+
+bool IndicatorSampler::begin(uint16_t rateHz)
+{
+    if (task)
+    {
+        return true;
+    }
+
+    if (!mutex)
+    {
+        return false;
+    }
+
+    setRate(rateHz);
+
+    if (xTaskCreate(samplerTask, "ind-sampler", INDICATOR_SAMPLER_TASK_STACK, this,
+                    INDICATOR_SAMPLER_TASK_PRIORITY, &task) != pdPASS)
+    {
+        DEBUG_PRINTLN("[ERROR] Failed to start indicator sampler task");
+        task = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void IndicatorSampler::setRate(uint16_t rateHz)
+{
+    uint16_t period = 0;
+    if (rateHz > 0)
+    {
+        rateHz = constrain(rateHz, 1, INDICATOR_SAMPLER_MAX_HZ);
+        period = 1000 / rateHz; // Whole milliseconds: the scheduler tick is 1 ms
+    }
+
+    if (!mutex)
+    {
+        periodMs = period; // Not started yet
+        return;
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (period != periodMs)
+    {
+        clear();
+        periodMs = period;
+    }
+    xSemaphoreGive(mutex);
+
+    DEBUG_PRINTF("[SAMPLER] Indicator sampling %s (%u Hz)\n", period ? "on" : "off", getRate());
+}
+
+void IndicatorSampler::clear()
+{
+    head = 0;
+    count = 0;
+    totalSamples = 0;
+}
+
+// =========================================================================
+// SAMPLING
+// =========================================================================
+
+void IndicatorSampler::samplerTask(void *arg)
+{
+    IndicatorSampler *self = (IndicatorSampler *)arg;
+    TickType_t lastWake = xTaskGetTickCount();
+
+    for (;;)
+    {
+        uint16_t period = self->periodMs;
+        if (period == 0)
+        {
+            vTaskDelay(pdMS_TO_TICKS(100));
+            lastWake = xTaskGetTickCount();
+            continue;
+        }
+
+        // Fixed cadence; a late wake-up is caught up rather than stretching time
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(period));
+        self->sample();
+    }
+}
+
+void IndicatorSampler::sample()
+{
+    uint16_t pins = 0;
+
+    // One untraced read per sample (counted in totalSamples), so a 1 kHz
+    // trace doesn't show up as I2C traffic of the main loop
+    uint16_t code;
+    if (!expanders.readPinsUntraced(MCP23017_ADDRESS, pins))
+    {
+        readErrors++;
+        code = TRACE_GAP_BIT;
+    }
+    else
+    {
+        code = (((pins >> MCP_TUNING_PIN) & 0x01) ? TRACE_TUNING_BIT : 0) |
+               (((pins >> MCP_SWR_PIN) & 0x01) ? TRACE_SWR_BIT : 0);
+    }
+
+    if (!mutex)
+    {
+        return;
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    append(code);
+    xSemaphoreGive(mutex);
+}
+
+void IndicatorSampler::append(uint16_t code)
+{
+    uint16_t last = (head + INDICATOR_TRACE_RUNS - 1) % INDICATOR_TRACE_RUNS;
+
+    // Extend the current run while the levels hold
+    if (count > 0 && (runs[last] & TRACE_CODE_MASK) == code && (runs[last] & TRACE_RUN_MAX) < TRACE_RUN_MAX)
+    {
+        runs[last]++;
+    }
+    else
+    {
+        runs[head] = code | 1;
+        head = (head + 1) % INDICATOR_TRACE_RUNS;
+        if (count < INDICATOR_TRACE_RUNS)
+        {
+            count++; // Once full, the oldest run is overwritten
+        }
+    }
+
+    totalSamples++;
+    lastSampleMs = millis();
+}
+
+// =========================================================================
+// EXPORT
+// =========================================================================
+
+String IndicatorSampler::getWindowJson(uint32_t windowMs)
+{
+    if (!mutex)
+    {
+        return "{\"error\":\"sampler unavailable\"}";
+    }
+
+    // Copy the runs inside the window so formatting doesn't stall the sampler
+    uint16_t *window = new uint16_t[INDICATOR_TRACE_EXPORT_MAX];
+    uint16_t windowCount = 0;
+    uint32_t endMs, period, samples, errors;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    endMs = lastSampleMs;
+    period = periodMs;
+    samples = totalSamples;
+    errors = readErrors;
+
+    uint32_t covered = 0; // Samples from the newest backwards
+    while (windowCount < count && windowCount < INDICATOR_TRACE_EXPORT_MAX && period > 0 && covered * period < windowMs)
+    {
+        uint16_t idx = (head + INDICATOR_TRACE_RUNS - 1 - windowCount) % INDICATOR_TRACE_RUNS;
+        window[windowCount++] = runs[idx];
+        covered += runs[idx] & TRACE_RUN_MAX;
+    }
+    xSemaphoreGive(mutex);
+
+    String json = "{";
+    json += "\"rate_hz\":" + String(period ? 1000 / period : 0) + ",";
+    json += "\"end_ms\":" + String(endMs) + ",";
+    json += "\"samples\":" + String(samples) + ",";
+    json += "\"read_errors\":" + String(errors) + ",";
+    json += "\"runs\":[";
+
+    // Oldest first; start times count back from the newest sample
+    for (int i = windowCount - 1; i >= 0; i--)
+    {
+        uint16_t word = window[i];
+        uint32_t length = word & TRACE_RUN_MAX;
+        uint32_t startMs = endMs - (covered - 1) * period;
+        covered -= length;
+
+        int state = (word & TRACE_GAP_BIT) ? -1 : ((word & TRACE_TUNING_BIT) ? 1 : 0) | ((word & TRACE_SWR_BIT) ? 2 : 0);
+        json += "[" + String(startMs) + "," + String(length * period) + "," + String(state) + "]";
+        if (i > 0)
+        {
+            json += ",";
+        }
+    }
+    json += "]}";
+
+    delete[] window;
+    return json;
+}
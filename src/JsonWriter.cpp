@@ -0,0 +1,247 @@
+#include "JsonWriter.h"
+#include "Config.h"
+
+JsonWriter::JsonWriter(char *buf, size_t size)
+    : buffer(buf), capacity(size)
+{
+    reset();
+}
+
+void JsonWriter::reset()
+{
+    used = 0;
+    depth = 0;
+    hasItems = 0;
+    overflow = buffer == nullptr || capacity == 0;
+    if (!overflow)
+    {
+        buffer[0] = '\0';
+    }
+}
+
+// =========================================================================
+// STRUCTURE
+// =========================================================================
+
+void JsonWriter::beginValue(const char *key)
+{
+    if (hasItems & (1UL << depth))
+    {
+        write(",", 1);
+    }
+    hasItems |= 1UL << depth;
+
+    if (key)
+    {
+        writeString(key);
+        write(":", 1);
+    }
+}
+
+void JsonWriter::open(const char *key, char bracket)
+{
+    if (depth + 1 >= JSON_WRITER_MAX_DEPTH)
+    {
+        overflow = true;
+        return;
+    }
+    beginValue(key);
+    write(&bracket, 1);
+    depth++;
+    hasItems &= ~(1UL << depth);
+}
+
+void JsonWriter::close(char bracket)
+{
+    if (depth > 0)
+    {
+        depth--;
+    }
+    write(&bracket, 1);
+}
+
+void JsonWriter::beginObject(const char *key)
+{
+    open(key, '{');
+}
+
+void JsonWriter::endObject()
+{
+    close('}');
+}
+
+void JsonWriter::beginArray(const char *key)
+{
+    open(key, '[');
+}
+
+void JsonWriter::endArray()
+{
+    close(']');
+}
+
+// =========================================================================
+// VALUES
+// =========================================================================
+
+void JsonWriter::add(const char *key, const char *value)
+{
+    beginValue(key);
+    if (value)
+    {
+        writeString(value);
+    }
+    else
+    {
+        write("null", 4);
+    }
+}
+
+void JsonWriter::add(const char *key, bool value)
+{
+    beginValue(key);
+    write(value ? "true" : "false");
+}
+
+void JsonWriter::addSigned(const char *key, long long value)
+{
+    char digits[24];
+    beginValue(key);
+    write(digits, snprintf(digits, sizeof(digits), "%lld", value));
+}
+
+void JsonWriter::addUnsigned(const char *key, unsigned long long value)
+{
+    char digits[24];
+    beginValue(key);
+    write(digits, snprintf(digits, sizeof(digits), "%llu", value));
+}
+
+void JsonWriter::addHex(const char *key, uint32_t value, bool prefix)
+{
+    char digits[16];
+    beginValue(key);
+    write(digits, snprintf(digits, sizeof(digits), prefix ? "\"0x%lx\"" : "\"%lx\"", (unsigned long)value));
+}
+
+void JsonWriter::addRaw(const char *key, const char *json)
+{
+    beginValue(key);
+    write(json);
+}
+
+// =========================================================================
+// OUTPUT
+// =========================================================================
+
+void JsonWriter::write(const char *text, size_t length)
+{
+    // Keep room for the terminator; past the first miss nothing is written
+    if (overflow || used + length >= capacity)
+    {
+        overflow = true;
+        return;
+    }
+    memcpy(buffer + used, text, length);
+    used += length;
+    buffer[used] = '\0';
+}
+
+void JsonWriter::writeString(const char *text)
+{
+    write("\"", 1);
+
+    // Runs of plain characters go out in one copy
+    const char *run = text;
+    for (const char *p = text; *p; p++)
+    {
+        uint8_t c = *p;
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+
+        write(run, p - run);
+        run = p + 1;
+
+        char escape[8];
+        switch (c)
+        {
+        case '"':
+            write("\\\"", 2);
+            break;
+        case '\\':
+            write("\\\\", 2);
+            break;
+        case '\n':
+            write("\\n", 2);
+            break;
+        case '\r':
+            write("\\r", 2);
+            break;
+        case '\t':
+            write("\\t", 2);
+            break;
+        default:
+            write(escape, snprintf(escape, sizeof(escape), "\\u%04x", c));
+            break;
+        }
+    }
+    write(run, strlen(run));
+
+    write("\"", 1);
+}
+
+// =========================================================================
+// SHARED OUTPUT BUFFER
+// =========================================================================
+
+JsonOutputBuffer::JsonOutputBuffer(size_t size)
+    : capacity(size), data(nullptr), mutex(nullptr), highWater(0), overflows(0)
+{
+}
+
+bool JsonOutputBuffer::begin()
+{
+    if (data)
+    {
+        return true;
+    }
+
+    mutex = xSemaphoreCreateMutex();
+    data = new char[capacity];
+    if (!mutex || !data)
+    {
+        DEBUG_PRINTF("[ERROR] JSON output buffer (%u bytes) allocation failed\n", (unsigned)capacity);
+        return false;
+    }
+    data[0] = '\0';
+    return true;
+}
+
+JsonOutputBuffer::Guard::Guard(JsonOutputBuffer &buffer)
+    : output(buffer), json(nullptr, 0)
+{
+    if (output.mutex)
+    {
+        xSemaphoreTake(output.mutex, portMAX_DELAY);
+    }
+    json = JsonWriter(output.data, output.data ? output.capacity : 0);
+}
+
+JsonOutputBuffer::Guard::~Guard()
+{
+    if (json.length() > output.highWater)
+    {
+        output.highWater = json.length();
+    }
+    if (!json.ok())
+    {
+        output.overflows++;
+        DEBUG_PRINTF("[JSON] Output buffer overflow (%u bytes)\n", (unsigned)output.capacity);
+    }
+    if (output.mutex)
+    {
+        xSemaphoreGive(output.mutex);
+    }
+}
@@ -0,0 +1,255 @@
+#include "PersistenceService.h"
+#include <esp_system.h>
+
+PersistenceService *PersistenceService::instance = nullptr;
+
+PersistenceService::PersistenceService()
+    : keyCount(0), wearKey(PERSIST_INVALID_KEY), wearOpen(false), brownouts(0), brownoutBoot(false)
+{
+    memset((void *)keys, 0, sizeof(keys));
+}
+
+bool PersistenceService::begin()
+{
+    if (instance == this)
+    {
+        return true;
+    }
+
+    wearOpen = wear.begin(PREFS_WEAR_NAMESPACE, false);
+    if (!wearOpen)
+    {
+        DEBUG_PRINTLN("[PERSIST] Wear counters unavailable (namespace open failed)");
+    }
+
+    // Registered first so the other keys' lifetime counts have somewhere to go
+    wearKey = registerKey("wear", PERSIST_WEAR_MIN_INTERVAL_MS, flushWear, this);
+
+    // A brown-out resets without warning; pending changes of that boot are
+    // lost (at most one interval's worth), the A/B config slots keep the
+    // last complete write
+    brownouts = wearOpen ? wear.getUInt("brownout", 0) : 0;
+    if (esp_reset_reason() == ESP_RST_BROWNOUT)
+    {
+        brownoutBoot = true;
+        brownouts++;
+        markDirty(wearKey);
+        DEBUG_PRINTF("[PERSIST] Brown-out reset (%lu so far)\n", (unsigned long)brownouts);
+    }
+
+    instance = this;
+    esp_register_shutdown_handler(onShutdown);
+    return wearOpen;
+}
+
+uint8_t PersistenceService::registerKey(const char *name, uint32_t minIntervalMs, FlushFunction flush, void *context)
+{
+    if (keyCount >= PERSIST_MAX_KEYS || !flush)
+    {
+        DEBUG_PRINTF("[PERSIST] Cannot register '%s'\n", name);
+        return PERSIST_INVALID_KEY;
+    }
+
+    KeyState &state = keys[keyCount];
+    state.name = name;
+    state.flush = flush;
+    state.context = context;
+    state.minIntervalMs = minIntervalMs;
+    state.lifetimeBase = wearOpen ? wear.getUInt(name, 0) : 0;
+    state.lifetimeSaved = state.lifetimeBase;
+    return keyCount++;
+}
+
+void PersistenceService::setMinInterval(uint8_t key, uint32_t minIntervalMs)
+{
+    if (key < keyCount)
+    {
+        keys[key].minIntervalMs = minIntervalMs;
+    }
+}
+
+void PersistenceService::markDirty(uint8_t key)
+{
+    if (key >= keyCount)
+    {
+        return;
+    }
+
+    uint32_t now = millis();
+    KeyState &state = keys[key];
+    portENTER_CRITICAL(&lock);
+    if (state.dirty)
+    {
+        state.coalesced++;
+    }
+    else
+    {
+        state.dirtySinceMs = now;
+        state.dirty = true;
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+void PersistenceService::clearDirty(uint8_t key)
+{
+    portENTER_CRITICAL(&lock);
+    keys[key].dirty = false;
+    portEXIT_CRITICAL(&lock);
+}
+
+// =========================================================================
+// FLUSHING
+// =========================================================================
+
+bool PersistenceService::flushKey(uint8_t key)
+{
+    KeyState &state = keys[key];
+
+    // Cleared first: a change made while the flush runs marks it again
+    clearDirty(key);
+    bool ok = state.flush(state.context);
+
+    state.lastWriteMs = millis();
+    state.written = true;
+    if (ok)
+    {
+        state.writes++;
+        if (key != wearKey)
+        {
+            markDirty(wearKey);
+        }
+    }
+    else
+    {
+        state.failures++;
+        portENTER_CRITICAL(&lock);
+        state.dirty = true; // Retried after the interval, still counted from the first change
+        portEXIT_CRITICAL(&lock);
+        DEBUG_PRINTF("[PERSIST] Write of '%s' failed\n", state.name);
+    }
+    return ok;
+}
+
+void PersistenceService::service()
+{
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < keyCount; i++)
+    {
+        KeyState &state = keys[i];
+        if (state.dirty && (!state.written || now - state.lastWriteMs >= state.minIntervalMs))
+        {
+            flushKey(i);
+        }
+    }
+}
+
+void PersistenceService::flushAll()
+{
+    uint8_t flushed = 0;
+    for (uint8_t i = 0; i < keyCount; i++)
+    {
+        if (i != wearKey && keys[i].dirty)
+        {
+            flushKey(i);
+            flushed++;
+        }
+    }
+
+    // Counters last, so they include the writes above
+    if (wearKey != PERSIST_INVALID_KEY && keys[wearKey].dirty)
+    {
+        flushKey(wearKey);
+    }
+
+    if (flushed)
+    {
+        DEBUG_PRINTF("[PERSIST] Flushed %u pending key(s)\n", flushed);
+    }
+}
+
+void PersistenceService::onShutdown()
+{
+    // esp_restart() runs this before stopping the other core
+    if (instance)
+    {
+        instance->flushAll();
+    }
+}
+
+bool PersistenceService::flushWear(void *context)
+{
+    PersistenceService *self = (PersistenceService *)context;
+    if (!self->wearOpen)
+    {
+        return false;
+    }
+
+    bool ok = true;
+    for (uint8_t i = 0; i < self->keyCount; i++)
+    {
+        KeyState &state = self->keys[i];
+        // The wear key's own write is this one: count it in advance
+        uint32_t count = self->lifetime(state) + (i == self->wearKey ? 1 : 0);
+        if (count == state.lifetimeSaved)
+        {
+            continue;
+        }
+        if (self->wear.putUInt(state.name, count) == sizeof(uint32_t))
+        {
+            state.lifetimeSaved = count;
+        }
+        else
+        {
+            ok = false;
+        }
+    }
+    if (self->brownoutBoot)
+    {
+        ok = self->wear.putUInt("brownout", self->brownouts) == sizeof(uint32_t) && ok;
+        self->brownoutBoot = false;
+    }
+    return ok;
+}
+
+// =========================================================================
+// STATUS
+// =========================================================================
+
+uint32_t PersistenceService::getPendingCount() const
+{
+    uint32_t pending = 0;
+    for (uint8_t i = 0; i < keyCount; i++)
+    {
+        pending += keys[i].dirty ? 1 : 0;
+    }
+    return pending;
+}
+
+String PersistenceService::getJson()
+{
+    uint32_t now = millis();
+
+    String json = "{\"brownouts\":" + String(brownouts) + ",\"keys\":[";
+    for (uint8_t i = 0; i < keyCount; i++)
+    {
+        const KeyState &state = keys[i];
+        portENTER_CRITICAL(&lock);
+        bool dirty = state.dirty;
+        uint32_t dirtySinceMs = state.dirtySinceMs;
+        uint32_t coalesced = state.coalesced;
+        portEXIT_CRITICAL(&lock);
+
+        json += i ? "," : "";
+        json += "{\"name\":\"" + String(state.name) + "\"";
+        json += ",\"min_interval_ms\":" + String(state.minIntervalMs);
+        json += ",\"pending\":" + String(dirty ? "true" : "false");
+        json += ",\"pending_ms\":" + String(dirty ? now - dirtySinceMs : 0);
+        json += ",\"writes\":" + String(state.writes);
+        json += ",\"lifetime_writes\":" + String(lifetime(state));
+        json += ",\"coalesced\":" + String(coalesced);
+        json += ",\"failures\":" + String(state.failures);
+        json += ",\"last_write_ago_ms\":" + String(state.written ? (long)(now - state.lastWriteMs) : -1L) + "}";
+    }
+    json += "]}";
+    return json;
+}
@@ -0,0 +1,184 @@
+#include "StatusLed.h"
+
+// WS2812 bit timing in RMT ticks (80 MHz APB / LED_RMT_CLK_DIV = 25 ns)
+#define WS2812_T0H 16 // 0.40 us
+#define WS2812_T0L 34 // 0.85 us
+#define WS2812_T1H 32 // 0.80 us
+#define WS2812_T1L 18 // 0.45 us
+
+// State -> pattern. Edit here to change what the LED shows.
+static const LedPattern ledPatternTable[LED_STATE_COUNT] = {
+    /* OFF       */ {LED_SOLID, 0, 1, {Colors::OFF}},
+    /* BOOT      */ {LED_BREATHE, 1500, 1, {Colors::YELLOW}},
+    /* OTA       */ {LED_BLINK, 2 * LED_BLINK_FAST, 1, {Colors::WHITE}},
+    /* PORTAL    */ {LED_BREATHE, 2000, 1, {Colors::PURPLE}},
+    /* WIFI_DOWN */ {LED_BLINK, 2 * LED_BLINK_SLOW, 1, {Colors::RED}},
+    /* FAULT     */ {LED_SEQUENCE, LED_BLINK_SLOW, 2, {Colors::RED, Colors::YELLOW}},
+    /* REMOTE    */ {LED_SOLID, 0, 1, {Colors::BLUE}},
+    /* READY     */ {LED_SOLID, 0, 1, {Colors::GREEN}}};
+
+static bool sameColor(const RGBColor &a, const RGBColor &b)
+{
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+static bool samePattern(const LedPattern &a, const LedPattern &b)
+{
+    if (a.effect != b.effect || a.periodMs != b.periodMs || a.colorCount != b.colorCount)
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < a.colorCount; i++)
+    {
+        if (!sameColor(a.colors[i], b.colors[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+StatusLed::StatusLed()
+    : ready(false), brightness(255), phaseStartMs(0), pending(false), lastRenderMs(0), pushes(0)
+{
+    pattern = ledPatternTable[LED_STATE_OFF];
+}
+
+const LedPattern &StatusLed::patternFor(LedState state)
+{
+    return ledPatternTable[state < LED_STATE_COUNT ? state : LED_STATE_OFF];
+}
+
+bool StatusLed::begin(uint8_t pin, uint8_t level)
+{
+    brightness = level;
+
+    rmt_config_t config = RMT_DEFAULT_CONFIG_TX((gpio_num_t)pin, LED_RMT_CHANNEL);
+    config.clk_div = LED_RMT_CLK_DIV;
+
+    if (rmt_config(&config) != ESP_OK || rmt_driver_install(config.channel, 0, 0) != ESP_OK)
+    {
+        DEBUG_PRINTF("[ERROR] LED: RMT channel %d setup failed\n", (int)LED_RMT_CHANNEL);
+        return false;
+    }
+
+    ready = true;
+    shown = RGBColor(1, 1, 1); // Force the first push
+    return push(Colors::OFF);
+}
+
+// =========================================================================
+// PATTERNS
+// =========================================================================
+
+void StatusLed::setState(LedState state)
+{
+    setPattern(patternFor(state));
+}
+
+void StatusLed::setPattern(const LedPattern &next)
+{
+    if (samePattern(next, pattern))
+    {
+        return; // Same pattern keeps its phase (no blink restart)
+    }
+
+    pattern = next;
+    phaseStartMs = millis();
+    render(phaseStartMs);
+}
+
+RGBColor StatusLed::colorAt(uint32_t nowMs) const
+{
+    if (pattern.effect == LED_SOLID || pattern.periodMs == 0 || pattern.colorCount == 0)
+    {
+        return pattern.colors[0];
+    }
+
+    uint32_t elapsed = nowMs - phaseStartMs;
+    const RGBColor &base = pattern.colors[0];
+
+    switch (pattern.effect)
+    {
+    case LED_BLINK:
+        return (elapsed % pattern.periodMs) < pattern.periodMs / 2 ? base : Colors::OFF;
+
+    case LED_BREATHE:
+    {
+        // Triangle wave 0..255..0, quantized so a frame only goes out on a visible step
+        uint32_t t = elapsed % pattern.periodMs;
+        uint32_t half = pattern.periodMs / 2;
+        uint32_t level = t < half ? t * 255 / half : (pattern.periodMs - t) * 255 / half;
+        level &= ~(uint32_t)(LED_BREATHE_STEP - 1);
+        return RGBColor(base.r * level / 255, base.g * level / 255, base.b * level / 255);
+    }
+
+    case LED_SEQUENCE:
+        return pattern.colors[(elapsed / pattern.periodMs) % pattern.colorCount];
+
+    default:
+        return base;
+    }
+}
+
+// =========================================================================
+// OUTPUT
+// =========================================================================
+
+void StatusLed::render(uint32_t nowMs)
+{
+    if (!ready)
+    {
+        return;
+    }
+
+    // Patterns don't need more than ~50 fps; a pending frame retries next time
+    if (!pending && nowMs - lastRenderMs < LED_RENDER_INTERVAL_MS && pattern.effect != LED_SOLID)
+    {
+        return;
+    }
+    lastRenderMs = nowMs;
+
+    RGBColor color = colorAt(nowMs);
+    if (sameColor(color, shown) && !pending)
+    {
+        return;
+    }
+    pending = !push(color);
+}
+
+bool StatusLed::push(const RGBColor &color)
+{
+    // Previous frame still going out: don't touch its buffer
+    if (rmt_wait_tx_done(LED_RMT_CHANNEL, 0) != ESP_OK)
+    {
+        return false;
+    }
+
+    uint8_t grb[3] = {
+        (uint8_t)(color.g * brightness / 255),
+        (uint8_t)(color.r * brightness / 255),
+        (uint8_t)(color.b * brightness / 255)};
+
+    for (uint8_t byte = 0; byte < 3; byte++)
+    {
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            bool one = grb[byte] & (0x80 >> bit);
+            rmt_item32_t &item = items[byte * 8 + bit];
+            item.level0 = 1;
+            item.duration0 = one ? WS2812_T1H : WS2812_T0H;
+            item.level1 = 0;
+            item.duration1 = one ? WS2812_T1L : WS2812_T0L;
+        }
+    }
+
+    if (rmt_write_items(LED_RMT_CHANNEL, items, 24, false) != ESP_OK)
+    {
+        return false;
+    }
+
+    shown = color;
+    pushes++;
+    return true;
+}
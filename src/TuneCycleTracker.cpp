@@ -0,0 +1,303 @@
+#include "TuneCycleTracker.h"
+
+// Amateur bands the tuner is typically used on
+struct BandRange
+{
+    const char *name;
+    uint32_t lowHz;
+    uint32_t highHz;
+};
+
+static const BandRange bandTable[] = {
+    {"160m", 1800000, 2000000},
+    {"80m", 3500000, 4000000},
+    {"60m", 5250000, 5450000},
+    {"40m", 7000000, 7300000},
+    {"30m", 10100000, 10150000},
+    {"20m", 14000000, 14350000},
+    {"17m", 18068000, 18168000},
+    {"15m", 21000000, 21450000},
+    {"12m", 24890000, 24990000},
+    {"10m", 28000000, 29700000},
+    {"6m", 50000000, 54000000}};
+
+#define BAND_TABLE_SIZE (sizeof(bandTable) / sizeof(bandTable[0]))
+#define BAND_OTHER BAND_TABLE_SIZE
+#define BAND_UNKNOWN (BAND_TABLE_SIZE + 1)
+
+static_assert(BAND_TABLE_SIZE + 2 == TUNE_CYCLE_BAND_COUNT, "TUNE_CYCLE_BAND_COUNT must match the band table");
+
+static const char *bandName(uint8_t band)
+{
+    if (band < BAND_TABLE_SIZE)
+    {
+        return bandTable[band].name;
+    }
+    return band == BAND_OTHER ? "other" : "unknown";
+}
+
+TuneCycleTracker::TuneCycleTracker()
+    : tunePressed(false), tunePressedMs(0), state(IDLE), fellAtMs(0), aborted(0), haveLast(false),
+      cycleCallback(nullptr)
+{
+    memset(&current, 0, sizeof(current));
+    memset(&last, 0, sizeof(last));
+    reset();
+}
+
+void TuneCycleTracker::reset()
+{
+    memset(buckets, 0, sizeof(buckets));
+    memset(&overall, 0, sizeof(overall));
+    aborted = 0;
+    haveLast = false;
+}
+
+uint8_t TuneCycleTracker::bandFor(uint32_t freqHz)
+{
+    if (freqHz == 0)
+    {
+        return BAND_UNKNOWN;
+    }
+
+    for (uint8_t i = 0; i < BAND_TABLE_SIZE; i++)
+    {
+        if (freqHz >= bandTable[i].lowHz && freqHz <= bandTable[i].highHz)
+        {
+            return i;
+        }
+    }
+    return BAND_OTHER;
+}
+
+const char *TuneCycleTracker::outcomeName(uint8_t outcome)
+{
+    switch (outcome)
+    {
+    case CYCLE_OK:
+        return "ok";
+    case CYCLE_HIGH_SWR:
+        return "high_swr";
+    case CYCLE_NO_START:
+        return "no_start";
+    case CYCLE_TIMEOUT:
+        return "timeout";
+    default:
+        return "unknown";
+    }
+}
+
+// =========================================================================
+// CYCLE TRACKING
+// =========================================================================
+
+void TuneCycleTracker::onButtonPress(ButtonId buttonId)
+{
+    // Called with the output lock held, possibly from the esp_timer task:
+    // just note it, update() does the rest
+    if (buttonId == BTN_TUNE)
+    {
+        tunePressedMs = millis();
+        tunePressed = true;
+    }
+}
+
+void TuneCycleTracker::update(bool tuning, bool swrGood, uint32_t freqHz, bool ant2)
+{
+    uint32_t now = millis();
+
+    if (tunePressed)
+    {
+        tunePressed = false;
+        if (state != IDLE)
+        {
+            aborted++; // Re-tuned before the previous cycle finished
+        }
+
+        current.startMs = tunePressedMs;
+        current.durationMs = 0;
+        current.freqHz = freqHz;
+        current.ant = ant2 ? 1 : 0;
+        current.band = bandFor(freqHz);
+        state = WAIT_RISE;
+    }
+
+    switch (state)
+    {
+    case IDLE:
+        break;
+
+    case WAIT_RISE:
+        if (tuning)
+        {
+            state = TUNING;
+        }
+        else if (now - current.startMs >= TUNE_CYCLE_START_TIMEOUT_MS)
+        {
+            finish(CYCLE_NO_START, 0);
+        }
+        break;
+
+    case TUNING:
+        if (!tuning)
+        {
+            fellAtMs = now;
+            state = SETTLE;
+        }
+        else if (now - current.startMs >= TUNE_CYCLE_MAX_MS)
+        {
+            finish(CYCLE_TIMEOUT, now - current.startMs);
+        }
+        break;
+
+    case SETTLE:
+        if (tuning)
+        {
+            state = TUNING; // Tuner resumed hunting
+        }
+        else if (now - fellAtMs >= TUNE_CYCLE_SWR_SETTLE_MS)
+        {
+            finish(swrGood ? CYCLE_OK : CYCLE_HIGH_SWR, fellAtMs - current.startMs);
+        }
+        break;
+    }
+}
+
+void TuneCycleTracker::finish(uint8_t outcome, uint32_t durationMs)
+{
+    current.durationMs = durationMs;
+    current.outcome = outcome;
+    state = IDLE;
+
+    record(buckets[current.ant][current.band], outcome, durationMs);
+    record(overall, outcome, durationMs);
+    last = current;
+    haveLast = true;
+
+    DEBUG_PRINTF("[TUNE-CYCLE] %s after %lu ms (%s, ANT %u)\n", outcomeName(outcome), (unsigned long)durationMs,
+                 bandName(current.band), current.ant + 1);
+
+    if (cycleCallback)
+    {
+        cycleCallback(getLastCycleJson());
+    }
+}
+
+void TuneCycleTracker::record(TuneCycleBucket &bucket, uint8_t outcome, uint32_t durationMs)
+{
+    bucket.outcomes[outcome]++;
+    if (outcome != CYCLE_OK)
+    {
+        return; // Percentiles are time-to-match
+    }
+
+    bucket.recentMs[bucket.recentNext] = durationMs > 0xFFFF ? 0xFFFF : durationMs;
+    bucket.recentNext = (bucket.recentNext + 1) % TUNE_CYCLE_HISTORY;
+    if (bucket.recentCount < TUNE_CYCLE_HISTORY)
+    {
+        bucket.recentCount++;
+    }
+}
+
+// =========================================================================
+// STATISTICS
+// =========================================================================
+
+uint16_t TuneCycleTracker::percentile(const TuneCycleBucket &bucket, uint8_t pct)
+{
+    if (bucket.recentCount == 0)
+    {
+        return 0;
+    }
+
+    // Nearest-rank over a sorted copy (at most TUNE_CYCLE_HISTORY values)
+    uint16_t sorted[TUNE_CYCLE_HISTORY];
+    memcpy(sorted, bucket.recentMs, bucket.recentCount * sizeof(uint16_t));
+    for (uint8_t i = 1; i < bucket.recentCount; i++)
+    {
+        uint16_t value = sorted[i];
+        int8_t j = i - 1;
+        while (j >= 0 && sorted[j] > value)
+        {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = value;
+    }
+
+    uint8_t rank = ((uint16_t)bucket.recentCount * pct + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+String TuneCycleTracker::bucketJson(const TuneCycleBucket &bucket)
+{
+    uint32_t cycles = 0;
+    for (uint8_t i = 0; i < CYCLE_OUTCOME_COUNT; i++)
+    {
+        cycles += bucket.outcomes[i];
+    }
+
+    String json = "\"cycles\":" + String(cycles);
+    for (uint8_t i = 0; i < CYCLE_OUTCOME_COUNT; i++)
+    {
+        json += ",\"" + String(outcomeName(i)) + "\":" + String(bucket.outcomes[i]);
+    }
+    json += ",\"success_pct\":" + String(cycles ? bucket.outcomes[CYCLE_OK] * 100 / cycles : 0);
+    json += ",\"p50_ms\":" + String(percentile(bucket, 50));
+    json += ",\"p90_ms\":" + String(percentile(bucket, 90));
+    json += ",\"max_ms\":" + String(percentile(bucket, 100));
+    return json;
+}
+
+String TuneCycleTracker::getLastCycleJson()
+{
+    String json = "{\"type\":\"tune_cycle\"";
+    if (haveLast)
+    {
+        json += ",\"outcome\":\"" + String(outcomeName(last.outcome)) + "\"";
+        json += ",\"duration_ms\":" + String(last.durationMs);
+        json += ",\"freq_hz\":" + String(last.freqHz);
+        json += ",\"band\":\"" + String(bandName(last.band)) + "\"";
+        json += ",\"ant\":" + String(last.ant + 1);
+
+        // Context: how this antenna/band usually does
+        json += "," + bucketJson(buckets[last.ant][last.band]);
+    }
+    json += "}";
+    return json;
+}
+
+String TuneCycleTracker::getStatusJson()
+{
+    static const char *stateNames[] = {"idle", "wait_rise", "tuning", "settle"};
+
+    String json = "{";
+    json += "\"state\":\"" + String(stateNames[state]) + "\",";
+    json += "\"aborted\":" + String(aborted) + ",";
+    json += "\"overall\":{" + bucketJson(overall) + "},";
+    json += "\"buckets\":[";
+
+    bool first = true;
+    for (uint8_t ant = 0; ant < 2; ant++)
+    {
+        for (uint8_t band = 0; band < TUNE_CYCLE_BAND_COUNT; band++)
+        {
+            const TuneCycleBucket &bucket = buckets[ant][band];
+            uint32_t cycles = 0;
+            for (uint8_t i = 0; i < CYCLE_OUTCOME_COUNT; i++)
+            {
+                cycles += bucket.outcomes[i];
+            }
+            if (cycles == 0)
+            {
+                continue;
+            }
+
+            json += first ? "" : ",";
+            json += "{\"ant\":" + String(ant + 1) + ",\"band\":\"" + String(bandName(band)) + "\"," + bucketJson(bucket) + "}";
+            first = false;
+        }
+    }
+    json += "]}";
+    return json;
+}
@@ -0,0 +1,458 @@
+#include "TuneMemory.h"
+#include "ButtonManager.h"
+#include "ConfigManager.h"
+#include "PersistenceService.h"
+#include <LittleFS.h>
+
+// On-flash format: 12-byte header then the sorted entries as-is
+#define TUNE_MEMORY_MAGIC0 'T'
+#define TUNE_MEMORY_MAGIC1 'M'
+#define TUNE_MEMORY_VERSION 1
+#define TUNE_MEMORY_HEADER_SIZE 12
+
+static_assert(sizeof(TuneMemoryEntry) == 8, "TuneMemoryEntry is stored raw on flash");
+
+TuneMemory::TuneMemory(ConfigManager *configManager, ButtonManager *buttonManager, PersistenceService *persistenceService)
+    : config(configManager), buttons(buttonManager), persistence(persistenceService),
+      persistKey(PERSIST_INVALID_KEY), entryCount(0),
+      cPos(0), lPos(0), positionKnown(false), positionChanged(false),
+      frequencyHz(0), currentSegment(0), handledSegment(0), frequencyChangedAt(0),
+      swrGoodSince(0)
+{
+}
+
+bool TuneMemory::begin()
+{
+    if (!load())
+    {
+        DEBUG_PRINTLN("[TUNEMEM] No stored tune memory, starting empty");
+    }
+
+    // Position changes come with every C/L press: the service batches them
+    persistKey = persistence->registerKey("tune_memory", TUNE_MEMORY_SAVE_INTERVAL, flushFile, this);
+    return true;
+}
+
+void TuneMemory::markDirty()
+{
+    persistence->markDirty(persistKey);
+}
+
+bool TuneMemory::flushFile(void *context)
+{
+    return ((TuneMemory *)context)->save();
+}
+
+// =========================================================================
+// FEEDS
+// =========================================================================
+
+bool TuneMemory::parseFrequency(const uint8_t *bcd, uint32_t &freqHz)
+{
+    // Least significant pair first: byte 0 = 10 Hz/1 Hz ... byte 4 = 1 GHz/100 MHz
+    uint32_t hz = 0;
+    for (int i = 4; i >= 0; i--)
+    {
+        uint8_t hi = bcd[i] >> 4;
+        uint8_t lo = bcd[i] & 0x0F;
+        if (hi > 9 || lo > 9)
+        {
+            return false;
+        }
+        hz = hz * 100 + hi * 10 + lo;
+    }
+    freqHz = hz;
+    return true;
+}
+
+void TuneMemory::onCivFrame(const uint8_t *frame, size_t length)
+{
+    // FE FE to from cmd f0 f1 f2 f3 f4 FD - 00 is transceive, 03 a read reply
+    if (length < 11 || frame[0] != 0xFE || frame[1] != 0xFE || frame[10] != 0xFD)
+    {
+        return;
+    }
+    if (frame[3] != config->getRadioAddress() || (frame[4] != 0x00 && frame[4] != 0x03))
+    {
+        return;
+    }
+
+    uint32_t hz;
+    if (!parseFrequency(&frame[5], hz) || hz == 0 || hz == frequencyHz)
+    {
+        return;
+    }
+
+    frequencyHz = hz;
+    uint16_t segment = segmentFor(hz);
+    if (segment != currentSegment)
+    {
+        currentSegment = segment;
+        swrGoodSince = 0; // SWR reading belongs to the old frequency
+    }
+    frequencyChangedAt = millis();
+}
+
+// The tuner steps once on the press, then again every
+// TUNE_MEMORY_TUNER_REPEAT_MS for as long as the button stays down
+void TuneMemory::onButtonPress(ButtonId buttonId, uint32_t durationMs)
+{
+    int16_t steps = durationMs ? 1 + (durationMs - 1) / TUNE_MEMORY_TUNER_REPEAT_MS : 0;
+
+    switch (buttonId)
+    {
+    case BTN_CUP:
+        cPos += steps;
+        break;
+    case BTN_CDN:
+        cPos -= steps;
+        break;
+    case BTN_LUP:
+        lPos += steps;
+        break;
+    case BTN_LDN:
+        lPos -= steps;
+        break;
+    case BTN_TUNE:
+        positionKnown = false; // Auto-tune moves C/L where we can't follow
+        break;
+    default:
+        return;
+    }
+
+    if (steps == 0)
+    {
+        positionKnown = false; // Held until released: how far it went is anyone's guess
+    }
+    positionChanged = true;
+}
+
+void TuneMemory::zeroPosition()
+{
+    cPos = 0;
+    lPos = 0;
+    positionKnown = true;
+    positionChanged = true;
+    DEBUG_PRINTLN("[TUNEMEM] Tuner position zeroed");
+}
+
+// =========================================================================
+// RECORD / REPLAY
+// =========================================================================
+
+void TuneMemory::update(bool swrGood)
+{
+    unsigned long now = millis();
+    bool frequencySettled = frequencyHz != 0 && now - frequencyChangedAt >= TUNE_MEMORY_REPLAY_DELAY_MS;
+    bool sequenceRunning = buttons->getSequencer().isRunning() || buttons->getRepeater().isRunning();
+
+    // Band change: replay the remembered match once the VFO stops moving
+    if (frequencySettled && currentSegment != handledSegment && !sequenceRunning)
+    {
+        handledSegment = currentSegment;
+        const TuneMemoryEntry *entry = lookup(currentSegment);
+        if (entry && positionKnown && config->getTuneMemoryAuto())
+        {
+            replay(*entry);
+            sequenceRunning = buttons->getSequencer().isRunning();
+        }
+    }
+
+    // Remember a match that has held a good SWR for a while
+    if (swrGood && frequencySettled && positionKnown && !sequenceRunning)
+    {
+        if (swrGoodSince == 0)
+        {
+            swrGoodSince = now ? now : 1;
+        }
+        else if (now - swrGoodSince >= TUNE_MEMORY_SETTLE_MS)
+        {
+            store(currentSegment);
+            handledSegment = currentSegment;
+        }
+    }
+    else if (!swrGood)
+    {
+        swrGoodSince = 0;
+    }
+
+    if (positionChanged)
+    {
+        positionChanged = false;
+        markDirty();
+    }
+}
+
+bool TuneMemory::replay(const TuneMemoryEntry &entry)
+{
+    // ANT first - only the latching model has a state we can set
+    if ((entry.flags & TUNE_MEMORY_FLAG_ANT) && !config->isModelMomentary() &&
+        (bool)entry.ant != config->getAntState())
+    {
+        buttons->setButtonOutput(BTN_ANT, entry.ant != 0, EventSource(SRC_TUNE_MEMORY));
+    }
+
+    int dc = entry.cSteps - cPos;
+    int dl = entry.lSteps - lPos;
+    if (dc == 0 && dl == 0)
+    {
+        return true;
+    }
+
+    SequenceStep steps[SEQUENCE_MAX_STEPS];
+    uint8_t count = 0;
+    for (int i = 0; i < abs(dc) && count < SEQUENCE_MAX_STEPS; i++)
+    {
+        SequenceStep step = {dc > 0 ? BTN_CUP : BTN_CDN, TUNE_MEMORY_STEP_WIDTH_MS, TUNE_MEMORY_STEP_GAP_MS};
+        steps[count++] = step;
+    }
+    for (int i = 0; i < abs(dl) && count < SEQUENCE_MAX_STEPS; i++)
+    {
+        SequenceStep step = {dl > 0 ? BTN_LUP : BTN_LDN, TUNE_MEMORY_STEP_WIDTH_MS, TUNE_MEMORY_STEP_GAP_MS};
+        steps[count++] = step;
+    }
+
+    if (abs(dc) + abs(dl) > SEQUENCE_MAX_STEPS)
+    {
+        // Position tracking follows the pulses actually sent; the next
+        // band change continues from wherever this one stopped
+        DEBUG_PRINTF("[TUNEMEM] Replay needs %d steps, sending first %u\n", abs(dc) + abs(dl), count);
+    }
+
+    DEBUG_PRINTF("[TUNEMEM] Replaying %lu Hz: C %+d, L %+d\n", (unsigned long)frequencyHz, dc, dl);
+    return buttons->getSequencer().run(steps, count, "tune-memory", EventSource(SRC_TUNE_MEMORY));
+}
+
+bool TuneMemory::recordNow()
+{
+    if (!positionKnown || frequencyHz == 0)
+    {
+        return false;
+    }
+    return store(currentSegment);
+}
+
+bool TuneMemory::store(uint16_t segment)
+{
+    TuneMemoryEntry entry;
+    entry.segment = segment;
+    entry.cSteps = cPos;
+    entry.lSteps = lPos;
+    entry.ant = config->getAntState() ? 1 : 0;
+    entry.flags = config->isModelMomentary() ? 0 : TUNE_MEMORY_FLAG_ANT;
+
+    int index = lowerBound(segment);
+    bool exists = index < entryCount && entries[index].segment == segment;
+
+    if (exists)
+    {
+        TuneMemoryEntry &old = entries[index];
+        if (old.cSteps == entry.cSteps && old.lSteps == entry.lSteps && old.ant == entry.ant && old.flags == entry.flags)
+        {
+            return true; // Unchanged - no flash write
+        }
+        old = entry;
+    }
+    else
+    {
+        if (entryCount >= TUNE_MEMORY_MAX_ENTRIES)
+        {
+            DEBUG_PRINTLN("[TUNEMEM] Table full, not recording");
+            return false;
+        }
+        memmove(&entries[index + 1], &entries[index], (entryCount - index) * sizeof(TuneMemoryEntry));
+        entries[index] = entry;
+        entryCount++;
+    }
+
+    markDirty();
+    DEBUG_PRINTF("[TUNEMEM] Recorded %lu Hz segment: C %d, L %d, %s\n",
+                 (unsigned long)segment * TUNE_MEMORY_SEGMENT_HZ, entry.cSteps, entry.lSteps,
+                 entry.ant ? "ANT 2" : "ANT 1");
+    return true;
+}
+
+bool TuneMemory::forget(uint32_t freqHz)
+{
+    uint16_t segment = segmentFor(freqHz);
+    int index = lowerBound(segment);
+    if (index >= entryCount || entries[index].segment != segment)
+    {
+        return false;
+    }
+
+    memmove(&entries[index], &entries[index + 1], (entryCount - index - 1) * sizeof(TuneMemoryEntry));
+    entryCount--;
+    markDirty();
+    return true;
+}
+
+void TuneMemory::clear()
+{
+    entryCount = 0;
+    markDirty();
+    DEBUG_PRINTLN("[TUNEMEM] Cleared");
+}
+
+// =========================================================================
+// LOOKUP
+// =========================================================================
+
+int TuneMemory::lowerBound(uint16_t segment) const
+{
+    int lo = 0;
+    int hi = entryCount;
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (entries[mid].segment < segment)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+const TuneMemoryEntry *TuneMemory::lookup(uint16_t segment) const
+{
+    int index = lowerBound(segment);
+
+    // Candidates: the first entry at/after the segment and the one before it
+    const TuneMemoryEntry *best = nullptr;
+    int bestDistance = TUNE_MEMORY_MAX_DISTANCE + 1;
+
+    if (index < entryCount)
+    {
+        int distance = entries[index].segment - segment;
+        if (distance < bestDistance)
+        {
+            best = &entries[index];
+            bestDistance = distance;
+        }
+    }
+    if (index > 0)
+    {
+        int distance = segment - entries[index - 1].segment;
+        if (distance < bestDistance)
+        {
+            best = &entries[index - 1];
+        }
+    }
+    return best;
+}
+
+// =========================================================================
+// STORAGE
+// =========================================================================
+
+bool TuneMemory::load()
+{
+    File file = LittleFS.open(TUNE_MEMORY_FILE, "r");
+    if (!file)
+    {
+        return false;
+    }
+
+    uint8_t header[TUNE_MEMORY_HEADER_SIZE];
+    if (file.read(header, sizeof(header)) != sizeof(header) ||
+        header[0] != TUNE_MEMORY_MAGIC0 || header[1] != TUNE_MEMORY_MAGIC1 || header[2] != TUNE_MEMORY_VERSION)
+    {
+        DEBUG_PRINTLN("[TUNEMEM] Ignoring unrecognized tune memory file");
+        file.close();
+        return false;
+    }
+
+    uint16_t count = header[8] | ((uint16_t)header[9] << 8);
+    if (count > TUNE_MEMORY_MAX_ENTRIES ||
+        file.read((uint8_t *)entries, count * sizeof(TuneMemoryEntry)) != count * sizeof(TuneMemoryEntry))
+    {
+        DEBUG_PRINTLN("[TUNEMEM] Truncated tune memory file");
+        file.close();
+        entryCount = 0;
+        return false;
+    }
+    file.close();
+
+    entryCount = count;
+    positionKnown = header[3] & 0x01;
+    cPos = (int16_t)(header[4] | (header[5] << 8));
+    lPos = (int16_t)(header[6] | (header[7] << 8));
+
+    DEBUG_PRINTF("[TUNEMEM] Loaded %u memories, position %s (C %d, L %d)\n",
+                 entryCount, positionKnown ? "known" : "unknown", cPos, lPos);
+    return true;
+}
+
+bool TuneMemory::save()
+{
+    if (!LittleFS.exists("/tune"))
+    {
+        LittleFS.mkdir("/tune");
+    }
+
+    File file = LittleFS.open(TUNE_MEMORY_FILE, "w");
+    if (!file)
+    {
+        DEBUG_PRINTLN("[TUNEMEM] Failed to open tune memory file for writing");
+        return false;
+    }
+
+    int16_t c = cPos;
+    int16_t l = lPos;
+    uint8_t header[TUNE_MEMORY_HEADER_SIZE] = {
+        TUNE_MEMORY_MAGIC0, TUNE_MEMORY_MAGIC1, TUNE_MEMORY_VERSION, (uint8_t)(positionKnown ? 0x01 : 0x00),
+        (uint8_t)(c & 0xFF), (uint8_t)((uint16_t)c >> 8),
+        (uint8_t)(l & 0xFF), (uint8_t)((uint16_t)l >> 8),
+        (uint8_t)(entryCount & 0xFF), (uint8_t)(entryCount >> 8),
+        0, 0};
+
+    size_t body = entryCount * sizeof(TuneMemoryEntry);
+    bool ok = file.write(header, sizeof(header)) == sizeof(header) &&
+              file.write((const uint8_t *)entries, body) == body;
+    file.close();
+    return ok;
+}
+
+// =========================================================================
+// STATUS
+// =========================================================================
+
+String TuneMemory::getStatusJson(bool includeEntries)
+{
+    String json = "{";
+    json += "\"radio_address\":" + String(config->getRadioAddress()) + ",";
+    json += "\"auto\":" + String(config->getTuneMemoryAuto() ? "true" : "false") + ",";
+    json += "\"frequency\":" + String(frequencyHz) + ",";
+    json += "\"position_known\":" + String(positionKnown ? "true" : "false") + ",";
+    json += "\"c\":" + String(cPos) + ",";
+    json += "\"l\":" + String(lPos) + ",";
+    json += "\"count\":" + String(entryCount);
+
+    if (includeEntries)
+    {
+        json += ",\"entries\":[";
+        for (uint16_t i = 0; i < entryCount; i++)
+        {
+            if (i > 0)
+            {
+                json += ",";
+            }
+            json += "{\"start_hz\":" + String((uint32_t)entries[i].segment * TUNE_MEMORY_SEGMENT_HZ) + ",";
+            json += "\"c\":" + String(entries[i].cSteps) + ",";
+            json += "\"l\":" + String(entries[i].lSteps);
+            if (entries[i].flags & TUNE_MEMORY_FLAG_ANT)
+            {
+                json += ",\"ant\":" + String(entries[i].ant + 1);
+            }
+            json += "}";
+        }
+        json += "]";
+    }
+
+    json += "}";
+    return json;
+}
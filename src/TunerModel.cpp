@@ -0,0 +1,38 @@
+#include "TunerModel.h"
+
+const TunerModel *findTunerModel(const char *name)
+{
+    for (uint8_t i = 0; i < TUNER_MODEL_COUNT; i++)
+    {
+        if (strcmp(tunerModels[i].name, name) == 0)
+        {
+            return &tunerModels[i];
+        }
+    }
+    return nullptr;
+}
+
+const TunerModel *findTunerModelByCode(uint8_t civCode)
+{
+    for (uint8_t i = 0; i < TUNER_MODEL_COUNT; i++)
+    {
+        if (tunerModels[i].civCode == civCode)
+        {
+            return &tunerModels[i];
+        }
+    }
+    return nullptr;
+}
+
+void writeTunerModelJson(JsonWriter &json, const char *key, const TunerModel &model)
+{
+    json.beginObject(key);
+    json.add("name", model.name);
+    json.add("civ_code", model.civCode);
+    json.add("ant_momentary", model.has(TUNER_CAP_ANT_MOMENTARY));
+    json.add("auto", model.has(TUNER_CAP_AUTO));
+    json.add("indicator_active_low", model.has(TUNER_CAP_INDICATOR_ACTIVE_LOW));
+    json.add("ant_pulse_ms", model.antPulseMs);
+    json.add("button_pulse_ms", model.buttonPulseMs);
+    json.endObject();
+}
@@ -28,16 +28,33 @@
 #include "ConfigManager.h"
 #include "HardwareManager.h"
 #include "ButtonManager.h"
+#include "EventLog.h"
+#include "TuneMemory.h"
+#include "TuneCycleTracker.h"
+#include "BootProfiler.h"
+#include "Diagnostics.h"
+#include "JsonWriter.h"
+#include "PersistenceService.h"
 #include "../lib/SMCIV/SMCIV.h"
 
 // =========================================================================
 // GLOBAL MANAGERS
 // =========================================================================
 
-ConfigManager config;
+PersistenceService persistence; // Coalesced flash writes for config and tune memory
+ConfigManager config(&persistence);
 HardwareManager hardware(&config);
 ButtonManager buttons(nullptr, &config); // MCP instance set after hardware init
 SMCIV smciv;
+EventLog eventLog;
+TuneMemory tuneMemory(&config, &buttons, &persistence);
+TuneCycleTracker tuneCycles;
+BootProfiler bootProfile;
+Diagnostics diagnostics(hardware);
+
+// Preallocated JSON output, reused for every message
+JsonOutputBuffer dashboardJson(JSON_DASHBOARD_BUFFER_SIZE);
+JsonOutputBuffer httpJson(JSON_HTTP_BUFFER_SIZE);
 
 // =========================================================================
 // NETWORK OBJECTS
@@ -49,6 +66,7 @@ AsyncWebSocket ws("/ws");
 AsyncWebSocket dashboardWs("/dashboard-ws");
 WiFiUDP udpDiscovery;
 WebSocketsClient remoteWS;
+WiFiManager wifiManager;
 
 // =========================================================================
 // GLOBAL STATE
@@ -59,12 +77,28 @@ bool otaActive = false;
 bool captivePortalActive = false;
 bool remoteWSConnected = false;
 
+// Network bring-up, advanced from loop() once the local stages are done
+enum NetBootStage
+{
+  NET_BOOT_CONNECTING, // Saved credentials, waiting for the AP
+  NET_BOOT_PORTAL,     // Configuration portal open
+  NET_BOOT_CONNECTED,
+  NET_BOOT_SERVICES,   // Web servers, OTA, discovery, CI-V
+  NET_BOOT_DONE
+};
+NetBootStage netBootStage = NET_BOOT_CONNECTING;
+bool networkReady = false; // Services above started
+unsigned long wifiConnectStartMs = 0;
+
 // Network discovery
 String deviceIP = "";
 String tcpPort = String(WEBSOCKET_PORT);
 String discoveredWsServer = "";
 String lastRemoteWsServer = "";
 
+// Dashboard page validator, read once from the filesystem image
+String dashboardEtag = "";
+
 // CI-V configuration
 uint8_t civAddress = CIV_BASE_ADDRESS;
 
@@ -74,16 +108,33 @@ bool g_swrIndicatorStatus = false;
 unsigned long lastIndicatorUpdate = 0;
 #define INDICATOR_UPDATE_INTERVAL 100 // Update every 100ms
 
+// Dashboard clients following the event log, each with its own cursor
+struct EventSubscriber
+{
+  uint32_t clientId;
+  uint32_t cursor;
+  bool active;
+};
+EventSubscriber eventSubscribers[EVENT_MAX_SUBSCRIBERS];
+SemaphoreHandle_t eventSubscribersMutex = xSemaphoreCreateMutex(); // (Un)subscribe runs on AsyncTCP, streaming on the loop
+
+// I2C transactions issued by the last loop iteration (and the worst seen)
+uint32_t i2cTransactionsLastLoop = 0;
+uint32_t i2cTransactionsPeakLoop = 0;
+
 // =========================================================================
 // FORWARD DECLARATIONS
 // =========================================================================
 
-void setupWiFi();
+void startWiFi();
+void startConfigPortal();
+void advanceNetworkBoot();
 void setupWebServers();
 void setupOTA();
 void setupDiscovery();
 void setupSMCIV();
-void loadFileSystem();
+bool loadFileSystem();
+void loadDashboardEtag();
 
 void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
                AwsEventType type, void *arg, uint8_t *data, size_t len);
@@ -93,6 +144,12 @@ void onRemoteWsEvent(WStype_t type, uint8_t *payload, size_t length);
 
 void handleRoot(AsyncWebServerRequest *request);
 void handleUpdateLatch(AsyncWebServerRequest *request);
+void handleDashboardSequence(AsyncWebSocketClient *client, JsonDocument &doc);
+bool handleCivSequence(uint8_t subcmd, const uint8_t *data, size_t dataLen);
+void handleDashboardTuneMemory(AsyncWebSocketClient *client, JsonDocument &doc);
+void handleDashboardEvents(AsyncWebSocketClient *client, JsonDocument &doc);
+void unsubscribeEvents(uint32_t clientId);
+void streamEvents();
 
 void processUDPDiscovery();
 void processWebSocketMessages();
@@ -100,8 +157,8 @@ void processSystemTasks();
 void updateStatusLED();
 void sendDashboardUpdate(AsyncWebSocketClient *client = nullptr);
 
-String processTemplate(String tmpl);
-String loadFile(const char *path);
+String webSocketQueueJson(AsyncWebSocket &socket);
+bool etagMatches(const String &ifNoneMatch, const String &etag);
 String extractTimestamp(const String &json);
 String toHexUpper(const String &data);
 
@@ -111,9 +168,11 @@ String toHexUpper(const String &data);
 
 void setup()
 {
-  // Initialize serial with high baud rate
+  // Local stages first (config, hardware, outputs, storage): the tuner
+  // lines reach their latched state before anything waits on the network.
+  // WiFi and the network services are brought up from loop() afterwards.
+  bootProfile.begin("serial");
   Serial.begin(115200);
-  delay(1000); // Allow serial to stabilize
 
   // Suppress ESP-IDF verbose logging
   esp_log_level_set("*", ESP_LOG_ERROR);
@@ -126,63 +185,77 @@ void setup()
   Serial.println(String("================================================="));
 
   // Initialize core managers
+  bootProfile.begin("config");
   DEBUG_PRINTLN("[SETUP] Initializing core managers...");
+  persistence.begin();
   if (!config.begin())
   {
     Serial.println("[FATAL] Failed to initialize ConfigManager");
     ESP.restart();
   }
+  dashboardJson.begin();
+  httpJson.begin();
 
-  if (!hardware.begin())
-  {
-    Serial.println("[FATAL] Failed to initialize HardwareManager");
-    ESP.restart();
-  }
+  // Record indicator edges and button actions from the start
+  hardware.setEventLog(&eventLog);
+  buttons.setEventLog(&eventLog);
 
-  // Initialize button manager with MCP instance
-  if (!buttons.setMCP(hardware.getMCP()))
+  bootProfile.begin("hardware");
+  if (!hardware.begin())
   {
-    Serial.println("[FATAL] Failed to set MCP instance in ButtonManager");
-    ESP.restart();
+    // No restart: a missing or stuck expander would only reboot-loop. Boot
+    // degraded (FAULT LED) and let the health supervisor re-attach it.
+    Serial.println("[ERROR] HardwareManager not ready, continuing degraded");
   }
-
-  if (!buttons.begin())
+  hardware.setLEDState(LED_STATE_BOOT);
+
+  // Initialize button manager with MCP instance; begin() writes the
+  // inactive levels and the saved ANT/AUTO states in one latch write. With
+  // the expander missing they stay in the driver's cache and are pushed
+  // when it attaches.
+  bootProfile.begin("outputs");
+  buttons.setOutputsOnline(hardware.isMCPReady());
+  if (!buttons.setMCP(hardware.getMCP()) || !buttons.begin())
   {
-    Serial.println("[FATAL] Failed to initialize ButtonManager");
-    ESP.restart();
+    Serial.println("[ERROR] ButtonManager not ready, continuing without button outputs");
   }
+  bootProfile.mark("outputs_restored");
 
-  // Set initial LED state
-  hardware.setLED(Colors::OFF);
+  // Re-attaching an expander rewrites its latch; serialize that with flushes
+  hardware.getExpanders().setOutputMutex(buttons.getOutputMutex());
 
-  // Load file system
-  loadFileSystem();
-
-  // Setup networking
-  setupWiFi();
-  setupWebServers();
-  setupOTA();
-  setupDiscovery();
-
-  // Initialize SMCIV with remote WebSocket and CI-V address
-  setupSMCIV();
+  // Macro sequence progress goes to every dashboard client
+  buttons.getSequencer().setProgressCallback([](const String &json)
+                                             { dashboardWs.textAll(json); });
 
-  // Load CI-V model and apply button states
-  config.loadAllSettings();
-  buttons.setButtonOutput("button-ant");
-  buttons.setButtonOutput("button-auto");
+  // Every C/L/TUNE press moves the tune memory's position estimate;
+  // TUNE presses also start a tune-cycle measurement
+  buttons.setPressCallback([](ButtonId buttonId, uint32_t durationMs)
+                           {
+    tuneMemory.onButtonPress(buttonId, durationMs);
+    tuneCycles.onButtonPress(buttonId); });
 
-  // Print final configuration
-  config.printConfiguration();
-  hardware.runDiagnostics();
+  // Finished tune cycles go to every dashboard client
+  tuneCycles.setCycleCallback([](const String &json)
+                              { dashboardWs.textAll(json); });
 
-  // Set LED to green - system ready
-  hardware.setLED(Colors::GREEN);
+  // Bus/expander health transitions (from the supervisor task)
+  hardware.setHealthCallback([](const String &json)
+                             { dashboardWs.textAll(json); });
 
-  // Send initial dashboard update
-  sendDashboardUpdate(nullptr);
-
-  DEBUG_PRINTLN("[SETUP] System initialization complete!");
+  // Load file system
+  bootProfile.begin("filesystem");
+  bool fsMounted = loadFileSystem();
+  loadDashboardEtag();
+  tuneMemory.begin();
+  bootProfile.end(fsMounted);
+
+  // Network comes up in the background (see advanceNetworkBoot)
+  bootProfile.begin("wifi");
+  startWiFi();
+
+  DEBUG_PRINTF("[SETUP] Local initialization complete after %lu ms, network starting\n",
+               (unsigned long)(micros() / 1000));
 }
 
 // =========================================================================
@@ -214,12 +287,9 @@ void updateTunerIndicators()
     }
     else
     {
-      // Hardware not available - use test values for now
-      // In production, you might want to set both to false
-      static bool testToggle = false;
-      testToggle = !testToggle;
+      // Hardware not available - report nothing rather than a made-up state
       g_tuningIndicatorStatus = false;
-      g_swrIndicatorStatus = testToggle; // Alternate for testing
+      g_swrIndicatorStatus = false;
     }
   }
 }
@@ -230,90 +300,223 @@ void updateTunerIndicators()
 
 void loop()
 {
-  // Handle OTA updates
-  ArduinoOTA.handle();
+  uint32_t loopStartUs = micros();
+  uint32_t i2cTransactionsAtStart = hardware.getI2CStats().transactions;
 
-  // Update hardware components
+  // Network stages run here until the services are up
+  if (!networkReady)
+  {
+    advanceNetworkBoot();
+  }
+  else
+  {
+    // Handle OTA updates
+    ArduinoOTA.handle();
+  }
+
+  // Update hardware components (batched expander poll, hot-plug rescan)
+  hardware.update();
+  buttons.setOutputsOnline(hardware.isMCPReady()); // Degraded boot / hot-plug: hold writes until re-attached
+  hardware.setSimFrequency(tuneMemory.getFrequency()); // Demo mode: radio frequency picks the match point
   hardware.updateLED();
 
   // Update tuner indicators (continuous monitoring)
   updateTunerIndicators();
 
   // Process button states and momentary actions
-  buttons.scanButtonStates();
   buttons.processMomentaryActions();
+  buttons.flushOutputs(); // Latch changes staged since the last tick, one I2C write
+  buttons.getSequencer().update();
+
+  // Replay/learn C-L positions per frequency segment
+  tuneMemory.update(hardware.isHardwareReady() && g_swrIndicatorStatus);
+
+  // Flash writes that are due (coalesced per key, minimum interval apart)
+  persistence.service();
+
+  // Time TUNE pulse -> TUNING rise/fall -> SWR
+  if (hardware.isMCPReady())
+  {
+    tuneCycles.update(hardware.getTuningStatus(), hardware.getSWRStatus(), tuneMemory.getFrequency(), config.getAntState());
+  }
 
   // Update status LED based on system state
   updateStatusLED();
 
   // Process network tasks
-  processUDPDiscovery();
-  processWebSocketMessages();
+  if (networkReady)
+  {
+    processUDPDiscovery();
+    processWebSocketMessages();
+    streamEvents();
+  }
 
   // Process system tasks
   processSystemTasks();
 
-  // Handle remote WebSocket client
-  remoteWS.loop();
+  if (networkReady)
+  {
+    // Handle remote WebSocket client
+    remoteWS.loop();
+
+    // Handle SMCIV tasks
+    smciv.loop();
+  }
+
+  i2cTransactionsLastLoop = hardware.getI2CStats().transactions - i2cTransactionsAtStart;
+  if (i2cTransactionsLastLoop > i2cTransactionsPeakLoop)
+  {
+    i2cTransactionsPeakLoop = i2cTransactionsLastLoop;
+  }
+
+  diagnostics.recordLoop(micros() - loopStartUs); // Work only, not the idle sleep below
 
-  // Handle SMCIV tasks
-  smciv.loop();
+  // Sleep until the next loop-driven button release is due, bounded so the
+  // network and indicator polling above stay responsive
+  uint32_t idleMs = buttons.msUntilNextRelease();
+  delay(idleMs < LOOP_IDLE_SLEEP_MAX ? idleMs : LOOP_IDLE_SLEEP_MAX);
 }
 
 // =========================================================================
 // INITIALIZATION FUNCTIONS
 // =========================================================================
 
-void loadFileSystem()
+bool loadFileSystem()
 {
   DEBUG_PRINTLN("[SETUP] Mounting LittleFS...");
 
+  // Dashboard files and tune memory are missing without it; the boot
+  // profile records the failure and everything else carries on
   if (!LittleFS.begin())
   {
     Serial.println("[ERROR] LittleFS mount failed!");
-    hardware.setLED(Colors::RED);
-    delay(3000);
+    return false;
   }
-  else
+
+  DEBUG_PRINTLN("[INFO] LittleFS mounted successfully");
+  return true;
+}
+
+void loadDashboardEtag()
+{
+  // Written next to the .gz by the build; without it pages are still
+  // served, just never answered with 304
+  File file = LittleFS.open(DASHBOARD_ETAG_PATH, "r");
+  if (!file)
+  {
+    DEBUG_PRINTLN("[WARNING] No dashboard ETag, browser revalidation disabled");
+    return;
+  }
+
+  dashboardEtag = file.readStringUntil('\n');
+  dashboardEtag.trim();
+  file.close();
+
+  if (dashboardEtag.length() > DASHBOARD_ETAG_MAX)
   {
-    DEBUG_PRINTLN("[INFO] LittleFS mounted successfully");
+    dashboardEtag = "";
   }
+  DEBUG_PRINTF("[INFO] Dashboard ETag %s\n", dashboardEtag.c_str());
 }
 
-void setupWiFi()
+void startWiFi()
 {
   DEBUG_PRINTLN("[SETUP] Configuring WiFi...");
 
-  WiFiManager wifiManager;
-
-  // Configure WiFi manager
-  WiFi.mode(WIFI_AP_STA);
-  captivePortalActive = true;
-  hardware.setBlinkLED(Colors::PURPLE, LED_BLINK_SLOW);
-
   wifiManager.setDebugOutput(false);
+  wifiManager.setConfigPortalBlocking(false);
   wifiManager.setAPCallback([](WiFiManager *wm)
                             { DEBUG_PRINTLN("[INFO] WiFiManager AP mode activated"); });
 
-  // Try to connect
-  if (!wifiManager.autoConnect(AP_NAME))
+  // Saved credentials: connect in the background, the portal only opens if
+  // that doesn't work out within WIFI_CONNECT_TIMEOUT
+  WiFi.mode(WIFI_AP_STA);
+  if (wifiManager.getWiFiIsSaved())
   {
-    Serial.println("[ERROR] WiFi connection failed!");
-    hardware.setLED(Colors::RED);
-    delay(3000);
-    ESP.restart();
+    WiFi.begin();
+    wifiConnectStartMs = millis();
+    netBootStage = NET_BOOT_CONNECTING;
   }
+  else
+  {
+    startConfigPortal();
+  }
+}
+
+void startConfigPortal()
+{
+  DEBUG_PRINTLN("[WIFI] Starting configuration portal");
+  captivePortalActive = true;
+  wifiManager.startConfigPortal(AP_NAME);
+  netBootStage = NET_BOOT_PORTAL;
+}
+
+// Called every loop until the network services are up. One stage per call,
+// so a slow stage never holds up button releases or indicator polling for
+// longer than it takes itself.
+void advanceNetworkBoot()
+{
+  switch (netBootStage)
+  {
+  case NET_BOOT_CONNECTING:
+    if (WiFi.isConnected())
+    {
+      netBootStage = NET_BOOT_CONNECTED;
+    }
+    else if (millis() - wifiConnectStartMs >= WIFI_CONNECT_TIMEOUT * 1000UL)
+    {
+      Serial.println("[ERROR] WiFi connection failed!");
+      startConfigPortal();
+    }
+    break;
+
+  case NET_BOOT_PORTAL:
+    if (wifiManager.process() || WiFi.isConnected())
+    {
+      captivePortalActive = false;
+      netBootStage = NET_BOOT_CONNECTED;
+    }
+    break;
+
+  case NET_BOOT_CONNECTED:
+    bootProfile.end();
+    deviceIP = WiFi.localIP().toString();
 
-  // WiFi connected successfully
-  deviceIP = WiFi.localIP().toString();
-  captivePortalActive = false;
-  hardware.setLED(Colors::GREEN);
+    // Print connection info
+    DEBUG_PRINTF("[WIFI] Connected to: %s\n", WiFi.SSID().c_str());
+    DEBUG_PRINTF("[WIFI] IP Address: %s\n", deviceIP.c_str());
+    DEBUG_PRINTF("[WIFI] Gateway: %s\n", WiFi.gatewayIP().toString().c_str());
+    DEBUG_PRINTF("[WIFI] Subnet: %s\n", WiFi.subnetMask().toString().c_str());
+    netBootStage = NET_BOOT_SERVICES;
+    break;
 
-  // Print connection info
-  DEBUG_PRINTF("[WIFI] Connected to: %s\n", WiFi.SSID().c_str());
-  DEBUG_PRINTF("[WIFI] IP Address: %s\n", deviceIP.c_str());
-  DEBUG_PRINTF("[WIFI] Gateway: %s\n", WiFi.gatewayIP().toString().c_str());
-  DEBUG_PRINTF("[WIFI] Subnet: %s\n", WiFi.subnetMask().toString().c_str());
+  case NET_BOOT_SERVICES:
+    bootProfile.begin("web");
+    setupWebServers();
+    bootProfile.begin("ota");
+    setupOTA();
+    bootProfile.begin("discovery");
+    setupDiscovery();
+    bootProfile.begin("civ");
+    setupSMCIV();
+    bootProfile.end();
+    networkReady = true;
+    netBootStage = NET_BOOT_DONE;
+
+    // Print final configuration
+    config.printConfiguration();
+    hardware.runDiagnostics();
+    bootProfile.finish();
+    bootProfile.print();
+
+    // Send initial dashboard update
+    sendDashboardUpdate(nullptr);
+    DEBUG_PRINTLN("[SETUP] System initialization complete!");
+    break;
+
+  case NET_BOOT_DONE:
+    break;
+  }
 }
 
 void setupWebServers()
@@ -381,6 +584,128 @@ void setupWebServers()
         
         request->send(200, "text/plain", response); });
 
+  // Stored button macro sequences
+  httpServer.on("/sequences", HTTP_GET, [](AsyncWebServerRequest *request)
+                { request->send(200, "application/json", buttons.getSequencer().listJson()); });
+
+  // Button/indicator event log, paged by cursor: ?cursor=<next seq>&limit=<n>
+  httpServer.on("/events", HTTP_GET, [](AsyncWebServerRequest *request)
+                {
+        uint32_t cursor = request->hasParam("cursor") ? request->getParam("cursor")->value().toInt() : eventLog.oldest();
+        int limit = request->hasParam("limit") ? request->getParam("limit")->value().toInt() : EVENT_EXPORT_MAX;
+        limit = constrain(limit, 1, EVENT_EXPORT_MAX);
+        request->send(200, "application/json", eventLog.exportJson(cursor, limit)); });
+
+  // Indicator debounce state and glitch counters
+  httpServer.on("/indicators", HTTP_GET, [](AsyncWebServerRequest *request)
+                { request->send(200, "application/json", hardware.getIndicatorJson()); });
+
+  // High-rate TUNING/SWR trace for plotting, ?window_ms=N (default 10 s)
+  httpServer.on("/indicator-trace", HTTP_GET, [](AsyncWebServerRequest *request)
+                {
+    uint32_t windowMs = INDICATOR_TRACE_WINDOW_DEFAULT_MS;
+    if (request->hasParam("window_ms")) {
+      windowMs = request->getParam("window_ms")->value().toInt();
+    }
+    IndicatorSampler &sampler = hardware.getSampler();
+    request->send(sampler.isAvailable() ? 200 : 503, "application/json", sampler.getWindowJson(windowMs)); });
+
+  // Hold-to-repeat train state and keepalive timeouts
+  httpServer.on("/repeat", HTTP_GET, [](AsyncWebServerRequest *request)
+                { request->send(200, "application/json", buttons.getRepeater().getStatusJson()); });
+
+  // Interlock table and reject/preempt counters
+  httpServer.on("/interlocks", HTTP_GET, [](AsyncWebServerRequest *request)
+                { request->send(200, "application/json", buttons.getInterlockJson()); });
+
+  // Frequency-indexed tune memory table and position estimate
+  httpServer.on("/tune-memory", HTTP_GET, [](AsyncWebServerRequest *request)
+                { request->send(200, "application/json", tuneMemory.getStatusJson()); });
+
+  // Tune-cycle time-to-match and outcome per antenna/band, ?reset=1 clears
+  httpServer.on("/tune-cycles", HTTP_GET, [](AsyncWebServerRequest *request)
+                {
+        String json = tuneCycles.getStatusJson();
+        if (request->hasParam("reset")) {
+            tuneCycles.reset();
+        }
+        request->send(200, "application/json", json); });
+
+  // Demo mode: virtual tuner state and fault injection.
+  // ?demo=0|1 is saved and applies after a restart; ?fault=<name>&value=N sets
+  // no_start/no_match/stuck/chatter to N percent, drop takes the expander off
+  // the bus for N ms, reset power-cycles it
+  httpServer.on("/sim", HTTP_GET, [](AsyncWebServerRequest *request)
+                {
+        if (request->hasParam("demo")) {
+            config.setDemoMode(request->getParam("demo")->value().toInt() != 0);
+        }
+        if (request->hasParam("fault")) {
+            uint32_t value = request->hasParam("value") ? request->getParam("value")->value().toInt() : 0;
+            if (!hardware.injectFault(request->getParam("fault")->value(), value)) {
+                request->send(400, "text/plain", "Unknown fault or demo mode off");
+                return;
+            }
+        }
+        request->send(200, "application/json", hardware.getSimulationJson()); });
+
+  // Performance diagnostics. ?bench=i2c[&n=N] starts the I2C round-trip
+  // benchmark in the background (poll again for the result), ?reset=1
+  // clears the loop and CI-V histograms
+  httpServer.on("/diagnostics", HTTP_GET, [](AsyncWebServerRequest *request)
+                {
+        bool benchStarted = false;
+        if (request->hasParam("bench") && request->getParam("bench")->value() == "i2c") {
+            long iterations = request->hasParam("n") ? request->getParam("n")->value().toInt() : DIAG_BENCH_DEFAULT_ITERATIONS;
+            iterations = constrain(iterations, 1L, (long)DIAG_BENCH_MAX_ITERATIONS); // Before narrowing: n=65536 must not wrap to 0
+            benchStarted = diagnostics.startI2CBenchmark(iterations);
+        }
+
+        String extra = "\"bench_started\":" + String(benchStarted ? "true" : "false");
+        extra += ",\"boot_ms\":" + String(bootProfile.getTotalMs());
+        extra += ",\"websockets\":{\"civ\":" + webSocketQueueJson(ws) + ",\"dashboard\":" + webSocketQueueJson(dashboardWs) + "}";
+        extra += ",\"persistence\":" + persistence.getJson();
+        extra += ",\"json_buffers\":{\"dashboard\":{\"size\":" + String(dashboardJson.getCapacity()) +
+                 ",\"high_water\":" + String(dashboardJson.getHighWater()) +
+                 ",\"overflows\":" + String(dashboardJson.getOverflows()) + "}" +
+                 ",\"http\":{\"size\":" + String(httpJson.getCapacity()) +
+                 ",\"high_water\":" + String(httpJson.getHighWater()) +
+                 ",\"overflows\":" + String(httpJson.getOverflows()) + "}}";
+        String json = diagnostics.getJson(extra);
+
+        if (request->hasParam("reset")) {
+            diagnostics.reset();
+        }
+        request->send(200, "application/json", json); });
+
+  // Persisted configuration, tuner model capabilities and config store state
+  httpServer.on("/config", HTTP_GET, [](AsyncWebServerRequest *request)
+                {
+        JsonOutputBuffer::Guard out(httpJson);
+        config.writeJson(out.writer());
+        if (out.writer().ok()) {
+            request->send(200, "application/json", out.writer().c_str());
+        } else {
+            request->send(500, "application/json", "{\"error\":\"response too large\"}");
+        } });
+
+  // Boot stage timings (local stages, then network bring-up)
+  httpServer.on("/boot", HTTP_GET, [](AsyncWebServerRequest *request)
+                { request->send(200, "application/json", bootProfile.getJson()); });
+
+  // I2C bus / expander health as seen by the supervisor
+  httpServer.on("/health", HTTP_GET, [](AsyncWebServerRequest *request)
+                { request->send(200, "application/json", hardware.getHealthJson()); });
+
+  // Button pulse width accuracy (actual vs requested); ?reset=1 clears it
+  httpServer.on("/pulse-jitter", HTTP_GET, [](AsyncWebServerRequest *request)
+                {
+        String json = buttons.getPulseJitterJson();
+        if (request->hasParam("reset")) {
+            buttons.resetPulseJitter();
+        }
+        request->send(200, "application/json", json); });
+
   // Device restart endpoint for debugging
   httpServer.on("/restart", HTTP_GET, [](AsyncWebServerRequest *request)
                 {
@@ -400,13 +725,13 @@ void setupOTA()
   ArduinoOTA.onStart([]()
                      {
         otaActive = true;
-        hardware.setBlinkLED(Colors::WHITE, LED_BLINK_FAST);
+        hardware.setLEDState(LED_STATE_OTA);
         DEBUG_PRINTLN("[OTA] Update started"); });
 
   ArduinoOTA.onEnd([]()
                    {
         otaActive = false;
-        hardware.setLED(Colors::GREEN);
+        hardware.setLEDState(LED_STATE_READY);
         DEBUG_PRINTLN("[OTA] Update completed"); });
 
   ArduinoOTA.onProgress([](unsigned int progress, unsigned int total)
@@ -448,67 +773,73 @@ void setupSMCIV()
   // Initialize SMCIV with remote WebSocket client and CI-V address
   smciv.begin(&remoteWS, &civAddress);
 
+  // Antenna port and switch type live in the config blob
+  smciv.restoreSettings(config.getAntennaPort(), config.getRcsType());
+  smciv.setSettingsStoreCallback([](uint8_t antennaPort, uint8_t rcsType)
+                                 { config.setSwitchSettings(antennaPort, rcsType); });
+
   // Set up callback functions for tuner integration
-  smciv.setTunerButtonCallback([](uint8_t buttonCode)
+  smciv.setTunerButtonCallback([](uint8_t buttonCode) -> bool
                                {
     DEBUG_PRINTF("[CI-V] Button callback: 0x%02X\n", buttonCode);
+    EventSource source(SRC_CIV, smciv.getLastSenderAddress());
     
-    // Check current model to determine behavior
-    String currentModel = config.getCurrentCivModel();
-    bool isModel998 = (currentModel.indexOf("998") >= 0);
+    // Current model decides how ANT behaves and how long presses are
+    const TunerModel &model = config.getTunerModel();
+    bool momentaryAnt = model.has(TUNER_CAP_ANT_MOMENTARY);
+    uint16_t pulseMs = model.buttonPulseMs;
+    bool accepted = false; // Refused by the interlock -> NAK to the radio
     
     switch (buttonCode) {
       case 0x00: // ANT button/latch command
-        if (isModel998) {
-          // Model 998: Pulse ANT button for 500ms (momentary/toggle mode)
-          DEBUG_PRINTLN("[CI-V] Model 998: ANT button pulse command received");
-          buttons.pulseButton("button-ant", 500);
+        if (momentaryAnt) {
+          // Momentary model (998): pulse ANT (toggle)
+          DEBUG_PRINTF("[CI-V] Model %s: ANT button pulse command received\n", model.name);
+          accepted = buttons.pulseButton(BTN_ANT, model.antPulseMs, source);
         } else {
-          // Model 991: Set ANT latch to ANT 1 (latching mode)
-          DEBUG_PRINTLN("[CI-V] Model 991: Set ANT latch to ANT 1");
-          config.setAntState(false); // ANT 1 = false
-          buttons.setButtonOutput("button-ant", false);
+          // Latching model (991): set ANT latch to ANT 1
+          DEBUG_PRINTF("[CI-V] Model %s: Set ANT latch to ANT 1\n", model.name);
+          accepted = buttons.setButtonOutput(BTN_ANT, false, source); // ANT 1 = false, saved by ButtonManager
           sendDashboardUpdate(nullptr); // Update dashboard
         }
         break;
         
       case 0x01: // ANT 2 command
-        if (isModel998) {
-          // Model 998: Pulse ANT button for 500ms (same as 34 00)
-          DEBUG_PRINTLN("[CI-V] Model 998: ANT button pulse command received");
-          buttons.pulseButton("button-ant", 500);
+        if (momentaryAnt) {
+          // Momentary model (998): pulse ANT (same as 34 00)
+          DEBUG_PRINTF("[CI-V] Model %s: ANT button pulse command received\n", model.name);
+          accepted = buttons.pulseButton(BTN_ANT, model.antPulseMs, source);
         } else {
-          // Model 991: Set ANT latch to ANT 2 (latching mode)
-          DEBUG_PRINTLN("[CI-V] Model 991: Set ANT latch to ANT 2");
-          config.setAntState(true); // ANT 2 = true
-          buttons.setButtonOutput("button-ant", true);
+          // Latching model (991): set ANT latch to ANT 2
+          DEBUG_PRINTF("[CI-V] Model %s: Set ANT latch to ANT 2\n", model.name);
+          accepted = buttons.setButtonOutput(BTN_ANT, true, source); // ANT 2 = true, saved by ButtonManager
           sendDashboardUpdate(nullptr); // Update dashboard
         }
         break;
         
       case 0x02: // TUNE
         DEBUG_PRINTLN("[CI-V] TUNE command received");
-        buttons.pulseButton("button-tune", 200); // 200ms pulse
+        accepted = buttons.pulseButton(BTN_TUNE, pulseMs, source);
         break;
         
       case 0x03: // C-UP
         DEBUG_PRINTLN("[CI-V] C-UP command received");
-        buttons.pulseButton("button-cup", 200); // 200ms pulse
+        accepted = buttons.pulseButton(BTN_CUP, pulseMs, source);
         break;
         
       case 0x04: // C-DN
         DEBUG_PRINTLN("[CI-V] C-DN command received");  
-        buttons.pulseButton("button-cdn", 200); // 200ms pulse
+        accepted = buttons.pulseButton(BTN_CDN, pulseMs, source);
         break;
         
       case 0x05: // L-UP
         DEBUG_PRINTLN("[CI-V] L-UP command received");
-        buttons.pulseButton("button-lup", 200); // 200ms pulse
+        accepted = buttons.pulseButton(BTN_LUP, pulseMs, source);
         break;
         
       case 0x06: // L-DN
         DEBUG_PRINTLN("[CI-V] L-DN command received");
-        buttons.pulseButton("button-ldn", 200); // 200ms pulse
+        accepted = buttons.pulseButton(BTN_LDN, pulseMs, source);
         break;
         
       default:
@@ -517,7 +848,8 @@ void setupSMCIV()
     }
     
     // Send dashboard update after button action
-    sendDashboardUpdate(nullptr); });
+    sendDashboardUpdate(nullptr);
+    return accepted; });
 
   smciv.setTunerIndicatorCallback([](uint8_t indicatorType) -> bool
                                   {
@@ -536,37 +868,37 @@ void setupSMCIV()
         return false;
     } });
 
-  smciv.setTunerModelCallback([]() -> String
-                              { return config.getCurrentCivModel(); });
+  smciv.setTunerModelCallback([]() -> uint8_t
+                              { return config.getTunerModel().civCode; });
 
   smciv.setTunerModelSetCallback([](uint8_t modelCode) -> bool
                                  {
-    String newModel;
-    switch (modelCode) {
-      case 0x00:
-        newModel = "991-994";
-        break;
-      case 0x01:
-        newModel = "998";
-        break;
-      default:
-        DEBUG_PRINTF("[CI-V] Unknown model code: 0x%02X\n", modelCode);
-        return false;
+    const TunerModel *newModel = findTunerModelByCode(modelCode);
+    if (!newModel) {
+      DEBUG_PRINTF("[CI-V] Unknown model code: 0x%02X\n", modelCode);
+      return false;
     }
     
-    DEBUG_PRINTF("[CI-V] Setting model to: %s\n", newModel.c_str());
-    bool success = config.setCivModel(newModel);
+    DEBUG_PRINTF("[CI-V] Setting model to: %s\n", newModel->name);
+    bool success = config.setTunerModel(newModel->id);
     
     if (success) {
       // Update button behavior based on new model
-      buttons.setButtonOutput("button-ant");
-      buttons.setButtonOutput("button-auto");
+      buttons.setButtonOutput(BTN_ANT);
+      buttons.setButtonOutput(BTN_AUTO);
       // Send dashboard update
       sendDashboardUpdate(nullptr);
     }
     
     return success; });
 
+  // Button macro sequences (CMD 35)
+  smciv.setTunerSequenceCallback(handleCivSequence);
+
+  // Radio frequency frames (00/03) drive the tune memory
+  smciv.setCivFrameCallback([](const uint8_t *frame, size_t length)
+                            { tuneMemory.onCivFrame(frame, length); });
+
   DEBUG_PRINTF("[INFO] SMCIV initialized with CI-V address: 0x%02X\n", civAddress);
 
   // Set up CI-V response callback for remote WebSocket
@@ -620,22 +952,28 @@ void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
       { // Minimum CI-V message length
         // Handle as CI-V message
         DEBUG_PRINTF("[WS] Processing CI-V message: %s\n", message.c_str());
+        uint32_t dispatchStartUs = micros();
         smciv.handleIncomingWsMessage(message);
+        diagnostics.recordCivDispatch(micros() - dispatchStartUs);
         break;
       }
 
       // Handle button presses (but avoid ANT/AUTO buttons which use latch format)
       if (message.startsWith("button:"))
       {
-        String buttonName = message.substring(7);
+        ButtonId buttonId = buttonIdFromText(message.c_str() + 7);
         // Skip ANT and AUTO buttons - they should use latch format
-        if (buttonName != "button-ant" && buttonName != "button-auto")
+        if (buttonId == BTN_NONE)
         {
-          buttons.pressButton(buttonName);
+          DEBUG_PRINTF("[WS] Unknown button in message: %s\n", message.c_str());
+        }
+        else if (buttonId != BTN_ANT && buttonId != BTN_AUTO)
+        {
+          buttons.pressButton(buttonId, EventSource(SRC_DASHBOARD, client->id()));
         }
         else
         {
-          DEBUG_PRINTF("[WS] Ignoring button: message for %s (should use latch format)\n", buttonName.c_str());
+          DEBUG_PRINTF("[WS] Ignoring button: message for %s (should use latch format)\n", buttonIdToText(buttonId));
         }
       }
     }
@@ -660,6 +998,8 @@ void onDashboardWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
 
   case WS_EVT_DISCONNECT:
     DEBUG_PRINTF("[DASH] Dashboard client %u disconnected\n", client->id());
+    buttons.getRepeater().stopOwner(client->id());
+    unsubscribeEvents(client->id());
     break;
 
   case WS_EVT_DATA:
@@ -729,6 +1069,35 @@ void onDashboardWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
         return;
       }
 
+      // Hold-to-repeat (repeat:button-id:on/ka/off) - the firmware generates the
+      // pulse train, the client only sends "ka" every REPEAT_KEEPALIVE_TIMEOUT_MS/3
+      if (message.startsWith("repeat:"))
+      {
+        int firstColon = message.indexOf(':', 0);
+        int secondColon = message.indexOf(':', firstColon + 1);
+        ButtonId buttonId = secondColon > firstColon ? buttonIdFromText(message.substring(firstColon + 1, secondColon)) : BTN_NONE;
+        String actionStr = message.substring(secondColon + 1);
+        ButtonRepeater &repeater = buttons.getRepeater();
+
+        if (!ButtonRepeater::isRepeatable(buttonId))
+        {
+          DEBUG_PRINTF("[DASH] Invalid repeat message: '%s'\n", message.c_str());
+        }
+        else if (actionStr == "on")
+        {
+          repeater.start(buttonId, client->id());
+        }
+        else if (actionStr == "ka")
+        {
+          repeater.keepalive(buttonId, client->id());
+        }
+        else
+        {
+          repeater.stop(buttonId, client->id());
+        }
+        return;
+      }
+
       // Handle momentary format messages (momentary:button-id:on/off) for Model 998
       if (message.startsWith("momentary:"))
       {
@@ -738,38 +1107,38 @@ void onDashboardWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
 
         if (firstColon > 0 && secondColon > firstColon)
         {
-          String buttonId = message.substring(firstColon + 1, secondColon); // Between first and second colon
-          String actionStr = message.substring(secondColon + 1);            // After second colon
+          ButtonId buttonId = buttonIdFromText(message.substring(firstColon + 1, secondColon)); // Between first and second colon
+          String actionStr = message.substring(secondColon + 1);                                   // After second colon
           bool isPress = (actionStr == "on");
 
           DEBUG_PRINTF("[DASH] Momentary - buttonId: '%s', action: '%s', isPress: %s\n",
-                       buttonId.c_str(), actionStr.c_str(), isPress ? "true" : "false");
+                       buttonIdToText(buttonId), actionStr.c_str(), isPress ? "true" : "false");
 
           // Handle ANT button momentary actions for Model 998
-          if (buttonId == "button-ant")
+          if (buttonId == BTN_ANT)
           {
             DEBUG_PRINTF("[DASH] ANT momentary action: %s\n", isPress ? "PRESS (activate output)" : "RELEASE (deactivate output)");
             if (isPress)
             {
-              bool success = buttons.startMomentaryAction("button-ant");
+              bool success = buttons.startMomentaryAction(BTN_ANT, EventSource(SRC_DASHBOARD, client->id()));
               DEBUG_PRINTF("[DASH] ANT momentary press started, success: %s\n", success ? "true" : "false");
             }
             else
             {
-              bool success = buttons.stopMomentaryAction("button-ant");
+              bool success = buttons.stopMomentaryAction(BTN_ANT, EventSource(SRC_DASHBOARD, client->id()));
               DEBUG_PRINTF("[DASH] ANT momentary press stopped, success: %s\n", success ? "true" : "false");
             }
           }
           // Handle other momentary buttons
-          else if (buttonId.startsWith("button-"))
+          else if (buttonId != BTN_NONE)
           {
             if (isPress)
             {
-              buttons.startMomentaryAction(buttonId);
+              buttons.startMomentaryAction(buttonId, EventSource(SRC_DASHBOARD, client->id()));
             }
             else
             {
-              buttons.stopMomentaryAction(buttonId);
+              buttons.stopMomentaryAction(buttonId, EventSource(SRC_DASHBOARD, client->id()));
             }
           }
         }
@@ -791,32 +1160,28 @@ void onDashboardWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
 
         if (firstColon > 0 && secondColon > firstColon)
         {
-          String buttonId = message.substring(firstColon + 1, secondColon); // Between first and second colon
-          String stateStr = message.substring(secondColon + 1);             // After second colon
+          ButtonId buttonId = buttonIdFromText(message.substring(firstColon + 1, secondColon)); // Between first and second colon
+          String stateStr = message.substring(secondColon + 1);                                   // After second colon
           bool state = (stateStr == "true");
 
           DEBUG_PRINTF("[DASH] Parsed - buttonId: '%s', stateStr: '%s', state: %s\n",
-                       buttonId.c_str(), stateStr.c_str(), state ? "true" : "false");
+                       buttonIdToText(buttonId), stateStr.c_str(), state ? "true" : "false");
 
-          DEBUG_PRINTF("[DASH] Latch command: %s -> %s\n", buttonId.c_str(), state ? "ON" : "OFF");
+          DEBUG_PRINTF("[DASH] Latch command: %s -> %s\n", buttonIdToText(buttonId), state ? "ON" : "OFF");
 
-          // Handle ANT button state changes
-          if (buttonId == "button-ant")
+          // Handle ANT button state changes (saved by ButtonManager)
+          if (buttonId == BTN_ANT)
           {
             DEBUG_PRINTF("[DASH] Setting ANT state to: %s\n", state ? "true (ANT 2)" : "false (ANT 1)");
             DEBUG_PRINTF("[DASH] Current ANT state before change: %s\n", config.getAntState() ? "true" : "false");
-            config.setAntState(state);
-            DEBUG_PRINTF("[DASH] ANT state after change: %s\n", config.getAntState() ? "true" : "false");
-            DEBUG_PRINTF("[DASH] ANT state saved, now calling setButtonOutput with state\n");
-            bool success = buttons.setButtonOutput("button-ant", state);
+            bool success = buttons.setButtonOutput(BTN_ANT, state, EventSource(SRC_DASHBOARD, client->id()));
             DEBUG_PRINTF("[DASH] ANT button output set, success: %s\n", success ? "true" : "false");
           }
-          // Handle AUTO button state changes
-          else if (buttonId == "button-auto")
+          // Handle AUTO button state changes (saved by ButtonManager, refused on models without the latch)
+          else if (buttonId == BTN_AUTO)
           {
             DEBUG_PRINTF("[DASH] Setting AUTO state to: %s\n", state ? "true (AUTO)" : "false (SEMI)");
-            config.setAutoState(state);
-            bool success = buttons.setButtonOutput("button-auto", state);
+            bool success = buttons.setButtonOutput(BTN_AUTO, state, EventSource(SRC_DASHBOARD, client->id()));
             DEBUG_PRINTF("[DASH] AUTO button output set, success: %s\n", success ? "true" : "false");
           }
 
@@ -831,8 +1196,8 @@ void onDashboardWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
         return;
       }
 
-      // Parse JSON message
-      StaticJsonDocument<512> doc;
+      // Parse JSON message (fixed bound, large enough for a full sequence upload)
+      DynamicJsonDocument doc(JSON_DASHBOARD_REQUEST_SIZE);
       DeserializationError error = deserializeJson(doc, message);
 
       if (error)
@@ -844,17 +1209,64 @@ void onDashboardWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
       // Handle different message types
       if (doc["type"] == "button")
       {
-        String buttonName = doc["button"];
+        ButtonId buttonId = buttonIdFromText(doc["button"].as<const char *>());
         // Skip ANT and AUTO buttons - they should use latch format
-        if (buttonName != "button-ant" && buttonName != "button-auto")
+        if (buttonId == BTN_NONE)
+        {
+          DEBUG_PRINTLN("[DASH] Unknown button in button message");
+        }
+        else if (buttonId != BTN_ANT && buttonId != BTN_AUTO)
         {
-          buttons.pressButton(buttonName);
+          buttons.pressButton(buttonId, EventSource(SRC_DASHBOARD, client->id()));
         }
         else
         {
-          DEBUG_PRINTF("[DASH] Ignoring button type message for %s (should use latch format)\n", buttonName.c_str());
+          DEBUG_PRINTF("[DASH] Ignoring button type message for %s (should use latch format)\n", buttonIdToText(buttonId));
         }
       }
+      else if (doc["type"] == "sequence")
+      {
+        handleDashboardSequence(client, doc);
+      }
+      else if (doc["type"] == "events")
+      {
+        handleDashboardEvents(client, doc);
+      }
+      else if (doc["type"] == "repeat_curve")
+      {
+        RepeatCurve curve = config.getRepeatCurve();
+        curve.widthMs = doc["width_ms"] | curve.widthMs;
+        curve.delayMs = doc["delay_ms"] | curve.delayMs;
+        curve.startMs = doc["start_ms"] | curve.startMs;
+        curve.minMs = doc["min_ms"] | curve.minMs;
+        curve.accelPercent = doc["accel_pct"] | curve.accelPercent;
+        bool success = config.setRepeatCurve(curve);
+        client->text("{\"type\":\"repeat_curve\",\"success\":" + String(success ? "true" : "false") + "}");
+      }
+      else if (doc["type"] == "tune_memory")
+      {
+        handleDashboardTuneMemory(client, doc);
+      }
+      else if (doc.containsKey("set_debounce_ms"))
+      {
+        int settleMs = doc["set_debounce_ms"];
+        config.setIndicatorSettleMs(settleMs < 0 ? 0 : settleMs);
+        sendDashboardUpdate(nullptr);
+      }
+      else if (doc.containsKey("set_sample_rate_hz"))
+      {
+        int rateHz = doc["set_sample_rate_hz"];
+        config.setIndicatorSampleHz(rateHz < 0 ? 0 : rateHz);
+        hardware.getSampler().setRate(config.getIndicatorSampleHz());
+        sendDashboardUpdate(nullptr);
+      }
+      else if (doc.containsKey("set_radio_address"))
+      {
+        int newAddress = doc["set_radio_address"];
+        DEBUG_PRINTF("[DASH] Radio address change request: 0x%02X\n", newAddress);
+        config.setRadioAddress(newAddress);
+        sendDashboardUpdate(nullptr);
+      }
       else if (doc.containsKey("set_device_number"))
       {
         int newDeviceNumber = doc["set_device_number"];
@@ -882,8 +1294,8 @@ void onDashboardWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
         String newModel = doc["value"];
         config.setCivModel(newModel);
         // Update button behavior based on new model
-        buttons.setButtonOutput("button-ant");
-        buttons.setButtonOutput("button-auto");
+        buttons.setButtonOutput(BTN_ANT);
+        buttons.setButtonOutput(BTN_AUTO);
         // Send updated state to all clients
         sendDashboardUpdate(nullptr);
       }
@@ -895,8 +1307,8 @@ void onDashboardWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
         if (success)
         {
           // Update button behavior based on new model
-          buttons.setButtonOutput("button-ant");
-          buttons.setButtonOutput("button-auto");
+          buttons.setButtonOutput(BTN_ANT);
+          buttons.setButtonOutput(BTN_AUTO);
           // Send updated state to all clients
           sendDashboardUpdate(nullptr);
         }
@@ -955,7 +1367,9 @@ void onRemoteWsEvent(WStype_t type, uint8_t *payload, size_t length)
     { // Minimum CI-V message length
       // Handle as CI-V message
       DEBUG_PRINTF("[REMOTE] Processing CI-V message: %s\n", message.c_str());
+      uint32_t dispatchStartUs = micros();
       smciv.handleIncomingWsMessage(message);
+      diagnostics.recordCivDispatch(micros() - dispatchStartUs);
     }
     else
     {
@@ -980,82 +1394,352 @@ void onRemoteWsEvent(WStype_t type, uint8_t *payload, size_t length)
 
 void handleRoot(AsyncWebServerRequest *request)
 {
-  String html = loadFile("/index.html");
-  if (html.length() == 0)
+  // The page is static: values that used to be substituted into it come
+  // with the first dashboard_update on the WebSocket. So a repeat visit is
+  // a 304 and a first visit streams the gzipped file from flash as is.
+  if (dashboardEtag.length() > 0 && request->hasHeader("If-None-Match") &&
+      etagMatches(request->getHeader("If-None-Match")->value(), dashboardEtag))
+  {
+    AsyncWebServerResponse *response = request->beginResponse(304);
+    response->addHeader("ETag", dashboardEtag);
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+    return;
+  }
+
+  // Picks DASHBOARD_PATH ".gz" when only that exists and sets
+  // Content-Encoding: gzip itself
+  if (!LittleFS.exists(DASHBOARD_PATH) && !LittleFS.exists(DASHBOARD_PATH ".gz"))
   {
     request->send(404, "text/plain", "Dashboard not found");
     return;
   }
 
-  // Process template variables
-  html = processTemplate(html);
+  AsyncWebServerResponse *response = request->beginResponse(LittleFS, DASHBOARD_PATH, "text/html");
+  if (dashboardEtag.length() > 0)
+  {
+    response->addHeader("ETag", dashboardEtag);
+  }
+  // Cached, but revalidated on every visit so a new filesystem image shows up
+  response->addHeader("Cache-Control", "no-cache");
+  request->send(response);
+}
+
+// If-None-Match as RFC 9110 (13.1.2) has it: "*", or a comma-separated
+// list of entity tags compared weakly (a W/ prefix on either side is
+// ignored). Tags are quoted and may themselves contain commas.
+bool etagMatches(const String &ifNoneMatch, const String &etag)
+{
+  String tag = etag.startsWith("W/") ? etag.substring(2) : etag;
+  const char *p = ifNoneMatch.c_str();
+
+  while (*p)
+  {
+    while (*p == ' ' || *p == '\t' || *p == ',')
+    {
+      p++;
+    }
+    if (*p == '*')
+    {
+      return true;
+    }
+    if (p[0] == 'W' && p[1] == '/')
+    {
+      p += 2;
+    }
+    if (*p != '"')
+    {
+      // Not an entity tag: skip to the next list element
+      while (*p && *p != ',')
+      {
+        p++;
+      }
+      continue;
+    }
 
-  request->send(200, "text/html", html);
+    const char *end = strchr(p + 1, '"');
+    if (!end)
+    {
+      return false;
+    }
+    size_t length = end - p + 1; // Quotes included, as in the stored tag
+    if (length == tag.length() && strncmp(p, tag.c_str(), length) == 0)
+    {
+      return true;
+    }
+    p = end + 1;
+  }
+  return false;
 }
 
 void handleUpdateLatch(AsyncWebServerRequest *request)
 {
   if (request->hasParam("button"))
   {
-    String buttonName = request->getParam("button")->value();
-    buttons.setButtonOutput(buttonName);
+    ButtonId buttonId = buttonIdFromText(request->getParam("button")->value());
+    if (buttonId != BTN_NONE)
+    {
+      buttons.setButtonOutput(buttonId, EventSource(SRC_HTTP));
+    }
   }
   request->send(200, "text/plain", "OK");
 }
 
 // =========================================================================
-// UTILITY FUNCTIONS
+// BUTTON MACRO SEQUENCES
 // =========================================================================
 
-String processTemplate(String tmpl)
+// {"type":"sequence","action":"run|save|stop|delete|list","name":"...","steps":[["button-cup",200,50],...]}
+// run without a name plays the uploaded steps; run with a name and no steps plays the stored one
+void handleDashboardSequence(AsyncWebSocketClient *client, JsonDocument &doc)
 {
-  // Replace basic project variables
-  tmpl.replace("%DEVICE_IP%", deviceIP);
-  tmpl.replace("%PROJECT_NAME%", PROJECT_NAME);
-  tmpl.replace("%PROJECT_VERSION%", PROJECT_VERSION);
-  tmpl.replace("%VERSION%", PROJECT_VERSION);
-  tmpl.replace("%DEVICE_NUMBER%", String(config.getDeviceNumber()));
-  tmpl.replace("%CIV_MODEL%", config.getCurrentCivModel());
-  tmpl.replace("%CIV_ADDRESS%", String(config.getCivAddress()));
-
-  // Network information
-  tmpl.replace("%IP%", deviceIP);
-  tmpl.replace("%UDP_PORT%", String(UDP_DISCOVERY_PORT));
-  tmpl.replace("%WEBSOCKET_PORT%", String(WEBSOCKET_PORT));
-
-  // System information
-  tmpl.replace("%CHIP_ID%", String((uint32_t)ESP.getEfuseMac(), HEX));
-  tmpl.replace("%CPU_FREQ%", String(ESP.getCpuFreqMHz()));
-  tmpl.replace("%FREE_HEAP%", String(ESP.getFreeHeap()));
-  tmpl.replace("%UPTIME%", String(millis() / 1000) + " seconds");
-
-  // Memory information
-  tmpl.replace("%FLASH_TOTAL%", String(ESP.getFlashChipSize()));
-  tmpl.replace("%FLASH_USED%", String(ESP.getSketchSize()));
-  tmpl.replace("%FLASH_FREE%", String(ESP.getFreeSketchSpace()));
-  tmpl.replace("%PSRAM_SIZE%", String(ESP.getPsramSize()));
-
-  // Current time/timestamp
-  tmpl.replace("%TIME%", String(millis()));
-
-  return tmpl;
+  ButtonSequencer &sequencer = buttons.getSequencer();
+  String action = doc["action"] | "";
+  const char *name = doc["name"] | "";
+  bool success = false;
+
+  if (action == "stop")
+  {
+    sequencer.stop();
+    success = true;
+  }
+  else if (action == "list")
+  {
+    client->text("{\"type\":\"sequence_list\",\"sequences\":" + sequencer.listJson() + "}");
+    return;
+  }
+  else if (action == "delete")
+  {
+    success = sequencer.remove(name);
+  }
+  else if (action == "run" && name[0] && !doc.containsKey("steps"))
+  {
+    success = sequencer.runNamed(name);
+  }
+  else if (action == "run" || action == "save")
+  {
+    SequenceStep steps[SEQUENCE_MAX_STEPS];
+    uint8_t count = ButtonSequencer::parseJsonSteps(doc["steps"].as<JsonArrayConst>(), steps);
+    if (count == 0)
+    {
+      DEBUG_PRINTLN("[DASH] Invalid sequence steps");
+    }
+    else if (action == "save")
+    {
+      success = sequencer.save(name, steps, count);
+    }
+    else
+    {
+      success = sequencer.run(steps, count, name);
+    }
+  }
+
+  DEBUG_PRINTF("[DASH] Sequence %s %s: %s\n", action.c_str(), name, success ? "OK" : "FAILED");
+  if (!success)
+  {
+    client->text("{\"type\":\"sequence_error\",\"action\":\"" + action + "\"}");
+  }
 }
 
-String loadFile(const char *path)
+// =========================================================================
+// TUNE MEMORY
+// =========================================================================
+
+// {"type":"tune_memory","action":"zero|record|forget|clear|auto|status","enabled":true,"frequency":14074000}
+void handleDashboardTuneMemory(AsyncWebSocketClient *client, JsonDocument &doc)
 {
-  File file = LittleFS.open(path, "r");
-  if (!file)
+  String action = doc["action"] | "";
+  bool success = true;
+
+  if (action == "zero")
   {
-    DEBUG_PRINTF("[ERROR] Failed to open file: %s\n", path);
-    return "";
+    tuneMemory.zeroPosition();
+  }
+  else if (action == "record")
+  {
+    success = tuneMemory.recordNow();
+  }
+  else if (action == "forget")
+  {
+    uint32_t frequency = doc["frequency"] | tuneMemory.getFrequency();
+    success = tuneMemory.forget(frequency);
+  }
+  else if (action == "clear")
+  {
+    tuneMemory.clear();
+  }
+  else if (action == "auto")
+  {
+    config.setTuneMemoryAuto(doc["enabled"] | false);
+  }
+  else if (action != "status")
+  {
+    success = false;
   }
 
-  String content = file.readString();
-  file.close();
+  DEBUG_PRINTF("[DASH] Tune memory %s: %s\n", action.c_str(), success ? "OK" : "FAILED");
+  client->text("{\"type\":\"tune_memory\",\"action\":\"" + action + "\",\"success\":" +
+               String(success ? "true" : "false") + ",\"status\":" + tuneMemory.getStatusJson(false) + "}");
+}
+
+// =========================================================================
+// EVENT LOG STREAMING
+// =========================================================================
+
+// {"type":"events","action":"subscribe|unsubscribe","cursor":123}
+// Without a cursor a subscriber starts with what is still in the ring
+void handleDashboardEvents(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+  String action = doc["action"] | "";
+  unsubscribeEvents(client->id());
+
+  if (action != "subscribe")
+  {
+    return;
+  }
+
+  uint32_t cursor = doc["cursor"] | eventLog.oldest();
+  bool subscribed = false;
 
-  return content;
+  xSemaphoreTake(eventSubscribersMutex, portMAX_DELAY);
+  for (int i = 0; i < EVENT_MAX_SUBSCRIBERS && !subscribed; i++)
+  {
+    if (!eventSubscribers[i].active)
+    {
+      eventSubscribers[i].clientId = client->id();
+      eventSubscribers[i].cursor = cursor;
+      eventSubscribers[i].active = true;
+      subscribed = true;
+    }
+  }
+  xSemaphoreGive(eventSubscribersMutex);
+
+  if (subscribed)
+  {
+    DEBUG_PRINTF("[DASH] Client %u subscribed to events from #%lu\n", client->id(), (unsigned long)cursor);
+  }
+  else
+  {
+    client->text("{\"type\":\"events_error\",\"error\":\"too many subscribers\"}");
+  }
+}
+
+void unsubscribeEvents(uint32_t clientId)
+{
+  xSemaphoreTake(eventSubscribersMutex, portMAX_DELAY);
+  for (int i = 0; i < EVENT_MAX_SUBSCRIBERS; i++)
+  {
+    if (eventSubscribers[i].active && eventSubscribers[i].clientId == clientId)
+    {
+      eventSubscribers[i].active = false;
+    }
+  }
+  xSemaphoreGive(eventSubscribersMutex);
+}
+
+// Pushes whatever each subscriber hasn't seen yet, one batch per interval
+void streamEvents()
+{
+  static unsigned long lastStream = 0;
+  unsigned long now = millis();
+  if (now - lastStream < EVENT_STREAM_INTERVAL)
+  {
+    return;
+  }
+  lastStream = now;
+
+  uint32_t head = eventLog.head();
+  for (int i = 0; i < EVENT_MAX_SUBSCRIBERS; i++)
+  {
+    // Work on a copy: the mutex is never held across a send, AsyncTCP
+    // takes it from inside its own handlers
+    xSemaphoreTake(eventSubscribersMutex, portMAX_DELAY);
+    EventSubscriber subscriber = eventSubscribers[i];
+    xSemaphoreGive(eventSubscribersMutex);
+
+    if (!subscriber.active || subscriber.cursor == head)
+    {
+      continue;
+    }
+
+    AsyncWebSocketClient *client = dashboardWs.client(subscriber.clientId);
+    if (!client)
+    {
+      unsubscribeEvents(subscriber.clientId);
+      continue;
+    }
+    if (client->queueIsFull())
+    {
+      continue; // Slow client - catch up next time (or report dropped)
+    }
+
+    uint32_t sentFrom = subscriber.cursor;
+    String batch = eventLog.exportJson(subscriber.cursor, EVENT_STREAM_BATCH);
+    client->text("{\"type\":\"events\"," + batch.substring(1));
+
+    // Advance the cursor unless the client re-subscribed in the meantime
+    xSemaphoreTake(eventSubscribersMutex, portMAX_DELAY);
+    EventSubscriber &slot = eventSubscribers[i];
+    if (slot.active && slot.clientId == subscriber.clientId && slot.cursor == sentFrom)
+    {
+      slot.cursor = subscriber.cursor;
+    }
+    xSemaphoreGive(eventSubscribersMutex);
+  }
+}
+
+// CI-V 35 sub-commands:
+//   00                   stop
+//   01 <steps>           upload and run
+//   02 <name>            run stored sequence (ASCII name)
+//   03 <name> 00 <steps> save under name
+// A step is 3 bytes: 34-style button code (02-06), width, gap in 10 ms units.
+bool handleCivSequence(uint8_t subcmd, const uint8_t *data, size_t dataLen)
+{
+  ButtonSequencer &sequencer = buttons.getSequencer();
+  SequenceStep steps[SEQUENCE_MAX_STEPS];
+  char name[SEQUENCE_NAME_MAX + 1];
+
+  switch (subcmd)
+  {
+  case 0x00:
+    sequencer.stop();
+    return true;
+
+  case 0x01:
+  {
+    uint8_t count = ButtonSequencer::parseCivSteps(data, dataLen, steps);
+    return count > 0 && sequencer.run(steps, count);
+  }
+
+  case 0x02:
+    if (dataLen == 0 || dataLen > SEQUENCE_NAME_MAX)
+      return false;
+    memcpy(name, data, dataLen);
+    name[dataLen] = '\0';
+    return sequencer.runNamed(name);
+
+  case 0x03:
+  {
+    const uint8_t *separator = (const uint8_t *)memchr(data, 0x00, dataLen);
+    size_t nameLen = separator ? separator - data : 0;
+    if (nameLen == 0 || nameLen > SEQUENCE_NAME_MAX)
+      return false;
+    memcpy(name, data, nameLen);
+    name[nameLen] = '\0';
+    uint8_t count = ButtonSequencer::parseCivSteps(separator + 1, dataLen - nameLen - 1, steps);
+    return count > 0 && sequencer.save(name, steps, count);
+  }
+
+  default:
+    return false;
+  }
 }
 
+// =========================================================================
+// UTILITY FUNCTIONS
+// =========================================================================
+
 String extractTimestamp(const String &json)
 {
   int start = json.indexOf("\"timestamp\":\"") + 13;
@@ -1192,6 +1876,28 @@ void processUDPDiscovery()
   }
 }
 
+// Send queue depth per socket: clients, messages queued in total and for
+// the slowest client, and clients whose queue is full
+String webSocketQueueJson(AsyncWebSocket &socket)
+{
+  uint32_t clients = 0;
+  uint32_t queued = 0;
+  uint32_t deepest = 0;
+  uint32_t full = 0;
+
+  for (AsyncWebSocketClient *client : socket.getClients())
+  {
+    uint32_t depth = client->queueLen();
+    clients++;
+    queued += depth;
+    deepest = depth > deepest ? depth : deepest;
+    full += client->queueIsFull() ? 1 : 0;
+  }
+
+  return "{\"clients\":" + String(clients) + ",\"queued\":" + String(queued) +
+         ",\"deepest\":" + String(deepest) + ",\"full\":" + String(full) + "}";
+}
+
 void processWebSocketMessages()
 {
   // Clean up disconnected clients
@@ -1216,76 +1922,119 @@ void processSystemTasks()
   esp_task_wdt_reset();
 }
 
+// Picks the state; the LED renderer only pushes when the color changes, so
+// this is cheap to call every loop
 void updateStatusLED()
 {
+  LedState state;
   if (otaActive)
   {
-    hardware.setBlinkLED(Colors::WHITE, LED_BLINK_FAST);
+    state = LED_STATE_OTA;
   }
   else if (captivePortalActive)
   {
-    hardware.setBlinkLED(Colors::PURPLE, LED_BLINK_SLOW);
+    state = LED_STATE_PORTAL;
+  }
+  else if (!networkReady)
+  {
+    state = LED_STATE_BOOT;
   }
   else if (!WiFi.isConnected())
   {
-    hardware.setBlinkLED(Colors::RED, LED_BLINK_SLOW);
+    state = LED_STATE_WIFI_DOWN;
+  }
+  else if (!hardware.isMCPReady() || hardware.getHealth() > HEALTH_DEGRADED)
+  {
+    state = LED_STATE_FAULT;
   }
   else if (remoteWSConnected)
   {
-    hardware.setLED(Colors::BLUE);
+    state = LED_STATE_REMOTE;
   }
   else
   {
-    hardware.setLED(Colors::GREEN);
+    state = LED_STATE_READY;
   }
+  hardware.setLEDState(state);
 }
 
 void sendDashboardUpdate(AsyncWebSocketClient *client)
 {
-  StaticJsonDocument<1024> doc;
+  // Serialized into the shared preallocated buffer rather than a document
+  // on the caller's stack (often the AsyncTCP task), then copied once into
+  // a WebSocket message buffer that all clients share
+  JsonOutputBuffer::Guard out(dashboardJson);
+  JsonWriter &json = out.writer();
+  char text[16];
+
+  json.beginObject();
 
   // System info
-  doc["type"] = "dashboard_update";
-  doc["device_number"] = config.getDeviceNumber();
-  doc["civ_model"] = config.getCurrentCivModel();
-  doc["civ_address"] = config.getCivAddress();
-  doc["ip"] = deviceIP;
-  doc["remote_ws_server"] = lastRemoteWsServer.length() > 0 ? lastRemoteWsServer : "Not connected";
-  doc["version"] = PROJECT_VERSION;
-  doc["time"] = String(millis());
+  json.add("type", "dashboard_update");
+  json.add("project_name", PROJECT_NAME);
+  json.add("device_number", config.getDeviceNumber());
+  json.add("civ_model", config.getCurrentCivModel());
+  json.add("civ_address", config.getCivAddress());
+  json.add("radio_address", config.getRadioAddress());
+  json.add("ip", deviceIP);
+  json.add("udp_port", UDP_DISCOVERY_PORT);
+  json.add("remote_ws_server", lastRemoteWsServer.length() > 0 ? lastRemoteWsServer.c_str() : "Not connected");
+  json.add("version", PROJECT_VERSION);
+  snprintf(text, sizeof(text), "%lu", (unsigned long)millis());
+  json.add("time", text);
 
   // Button states (match JavaScript field names)
-  bool currentAntState = config.getAntState();
-  doc["ant_state"] = currentAntState ? "ANT 2" : "ANT 1";
-  doc["auto_state"] = config.getAutoState() ? "AUTO" : "SEMI";
-  doc["ant_button_momentary"] = config.isModelMomentary();
-
-  // DEBUG_PRINTF("[DASH] Sending ant_state: %s (config value: %s)\n",
-  //              currentAntState ? "ANT 2" : "ANT 1", currentAntState ? "true" : "false");
+  json.add("ant_state", config.getAntState() ? "ANT 2" : "ANT 1");
+  json.add("auto_state", config.getAutoState() ? "AUTO" : "SEMI");
+  json.add("ant_button_momentary", config.isModelMomentary());
+  json.add("tuner_caps", config.getTunerModel().caps);
 
   // Hardware indicators (match JavaScript field names)
-  doc["tuning_active"] = hardware.getTuningStatus() ? 1 : 0;
-  doc["swr_ok"] = hardware.getSWRStatus() ? 1 : 0;
-  doc["remote_ws_connected"] = remoteWSConnected;
+  json.add("tuning_active", hardware.getTuningStatus() ? 1 : 0);
+  json.add("swr_ok", hardware.getSWRStatus() ? 1 : 0);
+  json.add("indicator_glitches", hardware.getIndicatorGlitches());
+  json.add("debounce_ms", config.getIndicatorSettleMs());
+  json.add("sample_rate_hz", hardware.getSampler().getRate());
+  json.add("hardware_health", HardwareManager::healthName(hardware.getHealth()));
+  json.add("demo_mode", hardware.isDemoMode());
+  json.add("boot_ms", bootProfile.getTotalMs());
+  json.add("outputs_restored_ms", bootProfile.msSinceBoot("outputs_restored"));
+  json.add("remote_ws_connected", remoteWSConnected);
+
+  // I2C traffic (transactions per loop iteration is the regression metric)
+  json.add("i2c_transactions", hardware.getI2CStats().transactions);
+  json.add("i2c_per_loop", i2cTransactionsLastLoop);
+  json.add("i2c_per_loop_peak", i2cTransactionsPeakLoop);
 
   // System information (match JavaScript field names)
-  doc["chip_id"] = String((uint32_t)ESP.getEfuseMac(), HEX);
-  doc["cpu_freq"] = ESP.getCpuFreqMHz();
-  doc["mem_free"] = ESP.getFreeHeap() / 1024;          // Convert to KB
-  doc["flash_total"] = ESP.getFlashChipSize() / 1024;  // Convert to KB
-  doc["flash_used"] = ESP.getSketchSize() / 1024;      // Convert to KB
-  doc["flash_free"] = ESP.getFreeSketchSpace() / 1024; // Convert to KB
-  doc["psram_size"] = ESP.getPsramSize() / 1024;       // Convert to KB
+  json.addHex("chip_id", (uint32_t)ESP.getEfuseMac(), false);
+  json.add("cpu_freq", ESP.getCpuFreqMHz());
+  json.add("mem_free", ESP.getFreeHeap() / 1024);          // Convert to KB
+  json.add("flash_total", ESP.getFlashChipSize() / 1024);  // Convert to KB
+  json.add("flash_used", ESP.getSketchSize() / 1024);      // Convert to KB
+  json.add("flash_free", ESP.getFreeSketchSpace() / 1024); // Convert to KB
+  json.add("psram_size", ESP.getPsramSize() / 1024);       // Convert to KB
 
   // Uptime breakdown
   unsigned long uptimeSeconds = millis() / 1000;
-  doc["uptime_seconds"] = uptimeSeconds % 60;
-  doc["uptime_minutes"] = (uptimeSeconds / 60) % 60;
-  doc["uptime_hours"] = (uptimeSeconds / 3600) % 24;
-  doc["uptime_days"] = uptimeSeconds / 86400;
+  json.add("uptime_seconds", uptimeSeconds % 60);
+  json.add("uptime_minutes", (uptimeSeconds / 60) % 60);
+  json.add("uptime_hours", (uptimeSeconds / 3600) % 24);
+  json.add("uptime_days", uptimeSeconds / 86400);
 
-  String message;
-  serializeJson(doc, message);
+  json.endObject();
+
+  if (!json.ok())
+  {
+    return; // Logged by the guard; a truncated update would only confuse the page
+  }
+
+  AsyncWebSocketMessageBuffer *message = dashboardWs.makeBuffer(json.length());
+  if (!message)
+  {
+    return;
+  }
+  memcpy(message->get(), json.c_str(), json.length());
 
   if (client)
   {
@@ -1295,8 +2044,4 @@ void sendDashboardUpdate(AsyncWebSocketClient *client)
   {
     dashboardWs.textAll(message);
   }
-
-  // DEBUG_PRINTF("[STATE] Update sent - ANT:%s AUTO:%s\n",
-  //              config.getAntState() ? "ON" : "OFF",
-  //              config.getAutoState() ? "ON" : "OFF");
 }
@@ -0,0 +1,112 @@
+// MCP23017Driver::begin() after an expander power-on reset.
+//
+// The button outputs are active low. Power-on leaves OLAT at 0, so if a
+// pin becomes an output before its latch is restored it pulses the button.
+// The bus below checks, after every write, that no pin the device drives
+// is latched LOW.
+//
+//   pio test -e native
+
+#include <unity.h>
+#include "MCP23017.h"
+
+#define TEST_ADDRESS 0x20
+#define TEST_OUTPUT_MASK 0x03DA // PA1, PA3, PA4, PA6, PA7, PB0, PB1
+
+class GlitchCheckBus
+{
+public:
+    GlitchCheckBus() : glitches(0), writes(0) {}
+
+    SimulatedMCP23017Bus &inner() { return bus; }
+
+    bool writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, size_t len)
+    {
+        bool ok = bus.writeRegisters(address, reg, data, len);
+        writes++;
+
+        uint16_t iodir = pair(address, MCP23017_IODIRA);
+        uint16_t olat = pair(address, MCP23017_OLATA);
+        if (~iodir & ~olat & TEST_OUTPUT_MASK)
+        {
+            glitches++;
+        }
+        return ok;
+    }
+
+    bool readRegisters(uint8_t address, uint8_t reg, uint8_t *data, size_t len)
+    {
+        return bus.readRegisters(address, reg, data, len);
+    }
+
+    bool probe(uint8_t address) { return bus.probe(address); }
+
+    uint32_t glitches;
+    uint32_t writes;
+
+private:
+    SimulatedMCP23017Bus bus;
+
+    uint16_t pair(uint8_t address, uint8_t regA)
+    {
+        return ((uint16_t)bus.registerValue(address, regA + 1) << 8) | bus.registerValue(address, regA);
+    }
+};
+
+static GlitchCheckBus bus;
+static MCP23017Driver<GlitchCheckBus> mcp(TEST_ADDRESS, bus);
+
+void setUp()
+{
+    bus.inner().attach(TEST_ADDRESS);
+
+    // Same order as ButtonManager::setupOutputs(): latch inactive, then outputs
+    mcp.writeAllPins(TEST_OUTPUT_MASK);
+    for (uint8_t pin = 0; pin < 16; pin++)
+    {
+        if (TEST_OUTPUT_MASK & (1 << pin))
+        {
+            mcp.pinMode(pin, OUTPUT);
+        }
+    }
+    bus.glitches = 0;
+    bus.writes = 0;
+}
+
+void tearDown()
+{
+    bus.inner().detach(TEST_ADDRESS);
+}
+
+void test_begin_after_reset_does_not_glitch_outputs()
+{
+    bus.inner().reset(TEST_ADDRESS);
+    mcp.begin();
+
+    TEST_ASSERT_EQUAL(3, bus.writes);
+    TEST_ASSERT_EQUAL(0, bus.glitches);
+    TEST_ASSERT_EQUAL_HEX16(TEST_OUTPUT_MASK, bus.inner().pinLevels(TEST_ADDRESS) & TEST_OUTPUT_MASK);
+}
+
+void test_begin_restores_direction_and_latch()
+{
+    uint16_t pressed = TEST_OUTPUT_MASK & ~(1 << 7); // ANT latched active
+    mcp.writeAllPins(pressed);
+    bus.inner().reset(TEST_ADDRESS);
+    mcp.begin();
+
+    uint16_t iodir, gpio, olat;
+    TEST_ASSERT_TRUE(mcp.readDirection(iodir));
+    TEST_ASSERT_EQUAL_HEX16(mcp.getDirection(), iodir);
+    TEST_ASSERT_TRUE(mcp.readOutputState(gpio, olat));
+    TEST_ASSERT_EQUAL_HEX16(pressed, olat);
+    TEST_ASSERT_EQUAL_HEX16(pressed & TEST_OUTPUT_MASK, gpio & TEST_OUTPUT_MASK);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_after_reset_does_not_glitch_outputs);
+    RUN_TEST(test_begin_restores_direction_and_latch);
+    return UNITY_END();
+}
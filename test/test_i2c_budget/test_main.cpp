@@ -0,0 +1,140 @@
+// I2C transactions of the driver primitives the loop is built on, on the
+// simulated bus.
+//
+// The loop talks to the expander in two places: the batched input poll
+// (ExpanderRegistry::poll) and the output flush with readback
+// (ButtonManager::flushOutputs). Neither builds host-native (Arduino,
+// FreeRTOS, esp_timer), so this test does not run them: loopTick() below is
+// a hand-written copy of their sequence over TracingBus<SimulatedMCP23017Bus>.
+// It catches a driver primitive that grows an extra transaction (a GPIO read,
+// a latch write or the readback costing more than one each), not a register
+// access added to the real poll or flush. Those show up on the device as
+// i2c_per_loop / i2c_per_loop_peak in the dashboard update.
+//
+//   pio test -e native
+
+#include <unity.h>
+#include "MCP23017.h"
+
+#define TEST_ADDRESS 0x20
+
+// Button outputs (PA1, PA3, PA4, PA6, PA7, PB0, PB1), TUNING and SWR inputs
+#define TEST_OUTPUT_MASK 0x03DA
+#define TEST_INPUT_PINS_MASK 0x0021
+
+#define I2C_BUDGET_IDLE_LOOP 1   // Input poll only
+#define I2C_BUDGET_OUTPUT_LOOP 3 // Input poll, latch write, readback
+#define I2C_BUDGET_OUTPUT_SETUP 1 // All button pins to outputs (ButtonManager::configureOutputs)
+
+static MCP23017Bus bus;
+static MCP23017 expander(TEST_ADDRESS, bus);
+static MCP23017 *mcp = &expander;
+
+// Copy of one pass of the loop's expander work (keep in step with poll()
+// and flushOutputs() by hand); outputs are written only if the staged value
+// differs from the latch
+static uint32_t loopTick(uint16_t outputs)
+{
+    uint32_t before = bus.stats().transactions;
+
+    uint16_t snapshot;
+    mcp->readAllPins(snapshot);
+
+    uint16_t latch = mcp->getOutputLatch();
+    uint16_t value = (latch & ~TEST_OUTPUT_MASK) | (outputs & TEST_OUTPUT_MASK);
+    if (value != latch)
+    {
+        uint16_t gpio, olat;
+        mcp->writeAllPins(value);
+        mcp->readOutputState(gpio, olat);
+    }
+
+    return bus.stats().transactions - before;
+}
+
+void setUp()
+{
+    bus.inner().attach(TEST_ADDRESS);
+
+    // Outputs inactive (active low) before they become outputs
+    mcp->writeAllPins(TEST_OUTPUT_MASK);
+    for (uint8_t pin = 0; pin < 16; pin++)
+    {
+        if (TEST_OUTPUT_MASK & (1 << pin))
+        {
+            mcp->pinMode(pin, OUTPUT);
+        }
+        else if (TEST_INPUT_PINS_MASK & (1 << pin))
+        {
+            mcp->pinMode(pin, INPUT);
+        }
+    }
+    bus.resetStats();
+}
+
+void tearDown()
+{
+    bus.inner().detach(TEST_ADDRESS);
+}
+
+void test_idle_loop_is_one_transaction()
+{
+    TEST_ASSERT_EQUAL(I2C_BUDGET_IDLE_LOOP, loopTick(TEST_OUTPUT_MASK));
+}
+
+void test_output_change_stays_within_budget()
+{
+    uint16_t pressed = TEST_OUTPUT_MASK & ~(1 << 4); // TUNE active
+    TEST_ASSERT_EQUAL(I2C_BUDGET_OUTPUT_LOOP, loopTick(pressed));
+    TEST_ASSERT_EQUAL(I2C_BUDGET_IDLE_LOOP, loopTick(pressed)); // Nothing new staged
+    TEST_ASSERT_EQUAL(I2C_BUDGET_OUTPUT_LOOP, loopTick(TEST_OUTPUT_MASK));
+}
+
+void test_several_outputs_share_one_write()
+{
+    uint16_t pressed = TEST_OUTPUT_MASK & ~((1 << 1) | (1 << 3) | (1 << 8));
+    TEST_ASSERT_EQUAL(I2C_BUDGET_OUTPUT_LOOP, loopTick(pressed));
+    TEST_ASSERT_EQUAL_HEX16(pressed & TEST_OUTPUT_MASK, bus.inner().pinLevels(TEST_ADDRESS) & TEST_OUTPUT_MASK);
+}
+
+void test_peak_over_a_run_stays_within_budget()
+{
+    uint32_t peak = 0;
+    for (int i = 0; i < 200; i++)
+    {
+        uint16_t outputs = (i % 10 == 0) ? (TEST_OUTPUT_MASK & ~(1 << 6)) : TEST_OUTPUT_MASK;
+        uint32_t count = loopTick(outputs);
+        if (count > peak)
+        {
+            peak = count;
+        }
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(I2C_BUDGET_OUTPUT_LOOP, peak);
+    TEST_ASSERT_EQUAL_UINT32(0, bus.stats().errors);
+}
+
+void test_output_setup_is_one_write()
+{
+    bus.inner().reset(TEST_ADDRESS);
+    MCP23017 fresh(TEST_ADDRESS, bus);
+    fresh.begin();
+    bus.resetStats();
+
+    fresh.pinModeMask(TEST_OUTPUT_MASK, OUTPUT);
+    TEST_ASSERT_EQUAL(I2C_BUDGET_OUTPUT_SETUP, bus.stats().transactions);
+
+    uint16_t iodir;
+    TEST_ASSERT_TRUE(fresh.readDirection(iodir));
+    TEST_ASSERT_EQUAL_HEX16((uint16_t)~TEST_OUTPUT_MASK, iodir);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_idle_loop_is_one_transaction);
+    RUN_TEST(test_output_change_stays_within_budget);
+    RUN_TEST(test_several_outputs_share_one_write);
+    RUN_TEST(test_peak_over_a_run_stays_within_budget);
+    RUN_TEST(test_output_setup_is_one_write);
+    return UNITY_END();
+}
@@ -0,0 +1,132 @@
+// VirtualTuner on the simulated expander, host-native.
+//
+// The controller side is the plain driver: button outputs are written the
+// way ButtonManager does (active low), TUNING and SWR are read back as pin
+// levels.
+//
+//   pio test -e native
+
+#include <unity.h>
+#include "MCP23017.h"
+#include "VirtualTuner.h"
+
+#define TEST_ADDRESS 0x20
+#define TEST_STEP_MS 5
+
+#ifndef LOW
+#define LOW 0x0
+#define HIGH 0x1
+#endif
+
+static const VirtualTunerPins pins = {0, 5, 6, 1, 8, 3, 4, 7}; // Same map as the firmware
+
+static SimulatedMCP23017Bus bus;
+static MCP23017Driver<SimulatedMCP23017Bus> mcp(TEST_ADDRESS, bus);
+static VirtualTuner *tuner = nullptr;
+static uint32_t nowMs = 0;
+
+static void run(uint32_t durationMs)
+{
+    for (uint32_t end = nowMs + durationMs; nowMs < end; nowMs += TEST_STEP_MS)
+    {
+        tuner->step(nowMs);
+    }
+}
+
+static void pulse(uint8_t pin, uint32_t widthMs)
+{
+    mcp.digitalWrite(pin, LOW);
+    run(widthMs);
+    mcp.digitalWrite(pin, HIGH);
+    run(TEST_STEP_MS);
+}
+
+static bool pinLevel(uint8_t pin)
+{
+    return (bus.pinLevels(TEST_ADDRESS) >> pin) & 0x01;
+}
+
+void setUp()
+{
+    bus.attach(TEST_ADDRESS);
+
+    const uint8_t outputs[] = {pins.cup, pins.cdn, pins.lup, pins.ldn, pins.tune, pins.ant};
+    for (uint8_t i = 0; i < sizeof(outputs); i++)
+    {
+        mcp.digitalWrite(outputs[i], HIGH); // Inactive before it becomes an output
+        mcp.pinMode(outputs[i], OUTPUT);
+    }
+    mcp.pinMode(pins.tuning, INPUT);
+    mcp.pinMode(pins.swr, INPUT);
+
+    tuner = new VirtualTuner(bus, TEST_ADDRESS, pins);
+    nowMs = 1000;
+    run(TEST_STEP_MS);
+}
+
+void tearDown()
+{
+    delete tuner;
+    tuner = nullptr;
+    bus.detach(TEST_ADDRESS);
+}
+
+void test_short_press_moves_one_step()
+{
+    uint8_t c = tuner->getC();
+    pulse(pins.cup, 50);
+    TEST_ASSERT_EQUAL(c + 1, tuner->getC());
+
+    uint8_t l = tuner->getL();
+    pulse(pins.ldn, 50);
+    TEST_ASSERT_EQUAL(l - 1, tuner->getL());
+}
+
+void test_hold_keeps_stepping()
+{
+    uint8_t c = tuner->getC();
+    pulse(pins.cup, VTUNER_STEP_REPEAT_MS * 3 + 50);
+    TEST_ASSERT_EQUAL(c + 4, tuner->getC());
+}
+
+void test_tune_cycle_active_high()
+{
+    pulse(pins.tune, 100);
+    run(VTUNER_START_DELAY_MS);
+    TEST_ASSERT_TRUE(tuner->isTuning());
+    TEST_ASSERT_TRUE(pinLevel(pins.tuning));
+
+    run(VTUNER_HUNT_BASE_MS + VTUNER_HUNT_JITTER_MS + VTUNER_POSITIONS * 2 * VTUNER_HUNT_STEP_MS);
+    TEST_ASSERT_FALSE(tuner->isTuning());
+    TEST_ASSERT_FALSE(pinLevel(pins.tuning));
+    TEST_ASSERT_TRUE(tuner->isMatched());
+    TEST_ASSERT_TRUE(pinLevel(pins.swr));
+}
+
+void test_indicators_follow_active_low_polarity()
+{
+    tuner->setIndicatorsActiveLow(true);
+    run(TEST_STEP_MS);
+    TEST_ASSERT_TRUE(pinLevel(pins.tuning)); // Idle: line released high
+    TEST_ASSERT_EQUAL(!tuner->isMatched(), pinLevel(pins.swr));
+
+    pulse(pins.tune, 100);
+    run(VTUNER_START_DELAY_MS);
+    TEST_ASSERT_TRUE(tuner->isTuning());
+    TEST_ASSERT_FALSE(pinLevel(pins.tuning));
+
+    run(VTUNER_HUNT_BASE_MS + VTUNER_HUNT_JITTER_MS + VTUNER_POSITIONS * 2 * VTUNER_HUNT_STEP_MS);
+    TEST_ASSERT_TRUE(tuner->isMatched());
+    TEST_ASSERT_TRUE(pinLevel(pins.tuning));
+    TEST_ASSERT_FALSE(pinLevel(pins.swr)); // Good SWR pulls low
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_short_press_moves_one_step);
+    RUN_TEST(test_hold_keeps_stepping);
+    RUN_TEST(test_tune_cycle_active_high);
+    RUN_TEST(test_indicators_follow_active_low_polarity);
+    return UNITY_END();
+}